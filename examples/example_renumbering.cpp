@@ -0,0 +1,73 @@
+#include <chrono>
+#include <iostream>
+#include <numeric>
+#include <random>
+
+#include "fsm/StateProfile.h"
+
+extern int example_renumbering() {
+
+	/**
+	* Profile-guided renumbering packs the states that an input visits most often together, so that their rows share cache lines and pages.
+	* Here, a large DFA spends all of its time in a few thousand "hot" states, numbered at random among 65536 states.
+	* We profile it over a sample of its input, renumber it, and time both machines over the same input.
+	**/
+
+	using namespace m0st4fa::fsm;
+	using Machine = DeterFiniteAutomaton<TransFn<DFATable>>;
+
+	constexpr size_t stateCount = 1 << 16, hotCount = 4096, alphabetSize = DFATable::ALPHABET_SIZE;
+	std::mt19937 random{ 42 };
+
+	// scatter the hot states among the others (state 1, the start state, is hot)
+	std::vector<FSMStateType> numbers(stateCount - 2);
+	std::iota(numbers.begin(), numbers.end(), FSMStateType{ 2 });
+	std::shuffle(numbers.begin(), numbers.end(), random);
+
+	std::vector<FSMStateType> hot{ 1 };
+	hot.insert(hot.end(), numbers.begin(), numbers.begin() + hotCount - 1);
+
+	// hot states go to hot states on /[a-g]/ and to cold states on /h/; cold states go back to hot states on /[a-h]/
+	std::vector<FSMStateType> transitions(stateCount * alphabetSize);
+	FSMStateSetType finalStates{};
+	finalStates.insert(hot.begin(), hot.end());
+
+	for (FSMStateType state = 1; state < stateCount; state++)
+		for (char c = 'a'; c <= 'h'; c++) {
+			const bool toCold = finalStates.contains(state) && c == 'h';
+			transitions[state * alphabetSize + c] = toCold ? numbers[hotCount + random() % (numbers.size() - hotCount)] : hot[random() % hotCount];
+		}
+
+	const Machine original{ finalStates, TransFn<DFATable>{ DFATable::fromTransitions(transitions) } };
+
+	// the input is made of hot bytes only
+	std::string input(1 << 20, 'a');
+	for (char& c : input)
+		c = static_cast<char>('a' + random() % 7);
+
+	// 1. profile the machine over a sample of the input
+	StateProfile profile{};
+	profile.record(original, std::string_view{ input }.substr(0, 1 << 16));
+
+	// 2. renumber it
+	const Machine renumbered = renumberStates(original, profile);
+
+	// 3. time both machines
+	auto time = [&input](const Machine& machine) {
+		const auto start = std::chrono::steady_clock::now();
+		bool accepted = true;
+
+		for (int i = 0; i < 20; i++)
+			accepted = machine.simulate(input, FSM_MODE::MM_WHOLE_STRING).accepted && accepted;
+
+		const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+		std::cout << (accepted ? "accepted" : "rejected") << " in " << elapsed.count() << "ms\n";
+	};
+
+	std::cout << "Before renumbering: ";
+	time(original);
+	std::cout << "After renumbering: ";
+	time(renumbered);
+
+	return 0;
+}
@@ -4,11 +4,13 @@
 
 extern int example_dfa();
 extern int example_nfa();
+extern int example_renumbering();
 
 int main(int argc, char** argv) {
 
 	example_dfa();
 	example_nfa();
+	example_renumbering();
 
 	m0st4fa::fsm::FSMTable table;
 	/*table(1, 'a') = 2;
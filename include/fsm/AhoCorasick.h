@@ -0,0 +1,261 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "DFA.h"
+#include "DFATable.h"
+#include "ByteSearch.h"
+
+// DECLARATIONS
+namespace m0st4fa::fsm {
+
+	/**
+	 * @brief An occurrence of a literal found by AhoCorasick.
+	 */
+	struct LiteralMatch {
+		//! @brief The ID of the literal (its index in the list of literals the automaton was built from).
+		size_t literal = 0;
+		//! @brief The indicies of the occurrence within the input.
+		Indicies indicies;
+
+		/**
+		 * @brief Compares this LiteralMatch object with another for equality.
+		 */
+		bool operator==(const LiteralMatch&) const = default;
+	};
+
+	/**
+	 * @brief Compiles a set of literals into an Aho-Corasick automaton that finds every occurrence of every literal in a single pass over the input.
+	 * @details The literals are inserted into a trie whose failure links are then resolved into a full DFA, stored as a DFATable and run by a DeterFiniteAutomaton. Every state that recognizes the end of a literal is final and tagged by the ID of that literal; the literals that end at the same position but are suffixes of it are reached through a chain of output links.
+	 * The automaton never dies: after consuming any prefix of the input, it is in the state that corresponds to the longest suffix of that prefix that is a prefix of some literal. Consequently, simulating it with `FSM_MODE::MM_LONGEST_PREFIX` answers whether the input contains any of the literals, and where the last occurrence ends.
+	 */
+	class AhoCorasick {
+	public:
+		//! @brief The type of the DFA that the literals are compiled into.
+		using AutomatonType = DeterFiniteAutomaton<TransFn<DFATable>>;
+
+		//! @brief Used in place of a literal ID by states that do not end a literal.
+		static constexpr size_t NO_LITERAL = static_cast<size_t>(-1);
+
+	private:
+		//! @brief The DFA that the literals are compiled into.
+		AutomatonType m_Automaton{};
+		//! @brief The lengths of the literals, indexed by their IDs.
+		std::vector<size_t> m_LiteralLengths{};
+		//! @brief The ID of the literal that ends at each state, or NO_LITERAL.
+		std::vector<size_t> m_StateLiteral{};
+		//! @brief The ID of the next literal that is equal to each literal, or NO_LITERAL (equal literals share a state).
+		std::vector<size_t> m_NextEqualLiteral{};
+		//! @brief The closest state on the failure chain of each state that ends a literal, or the dead state.
+		std::vector<FSMStateType> m_OutputLink{};
+		//! @brief The bytes that begin some literal, used to skip input while the automaton is in the start state.
+		ByteSet m_FirstBytes{};
+
+	public:
+
+		/**
+		 * @brief Default constructor. The constructed object has no literals and must not be simulated.
+		 */
+		AhoCorasick() = default;
+
+		explicit AhoCorasick(const std::vector<std::string>&);
+
+		//! @brief Gets the DFA that the literals are compiled into.
+		const AutomatonType& getAutomaton() const { return m_Automaton; };
+
+		//! @brief Gets the number of literals.
+		size_t getLiteralCount() const { return m_LiteralLengths.size(); };
+
+		//! @brief Gets the length of the literal whose ID is `literal`.
+		size_t getLiteralLength(const size_t literal) const { return m_LiteralLengths.at(literal); };
+
+		/**
+		 * @brief Calls `fun` with the ID of every literal that ends when the automaton reaches `state`, in descending order of length.
+		 * @param[in] state A state of the automaton.
+		 * @param[in] fun The callable that is called with each literal ID.
+		 */
+		template <typename FunT>
+		void forEachLiteral(const FSMStateType state, FunT&& fun) const {
+			for (FSMStateType s = state; s != AutomatonType::getDeadState(); s = m_OutputLink[s])
+				for (size_t literal = m_StateLiteral[s]; literal != NO_LITERAL; literal = m_NextEqualLiteral[literal])
+					fun(literal);
+		}
+
+		template <typename FunT>
+		void findAll(std::string_view, FunT&&) const;
+
+		std::vector<LiteralMatch> findAll(std::string_view) const;
+
+	};
+
+}
+
+// IMPLEMENTATIONS
+namespace m0st4fa::fsm {
+
+	/**
+	 * @brief Compiles `literals` into an Aho-Corasick automaton.
+	 * @details Bytes that appear in no literal share a single class in the resulting table.
+	 * @param[in] literals The literals to be found. The ID of each literal is its index in `literals`; equal literals are all reported.
+	 * @throw InvalidStateMachineArgumentsException Thrown if `literals` is empty or contains an empty literal.
+	 */
+	inline AhoCorasick::AhoCorasick(const std::vector<std::string>& literals)
+	{
+		constexpr FSMStateType deadState = AutomatonType::getDeadState();
+		constexpr FSMStateType startState = AutomatonType::getStartState();
+
+		if (literals.empty() || std::any_of(literals.begin(), literals.end(), [](const std::string& l) { return l.empty(); })) {
+			const std::string message = "AhoCorasick: The set of literals cannot be empty nor contain an empty literal.";
+			Logger{}.log(LoggerInfo::LL_ERROR, message);
+			throw InvalidStateMachineArgumentsException{ message };
+		}
+
+		// give every byte used by some literal its own class, and the rest of the bytes a shared one
+		std::array<bool, DFATable::ALPHABET_SIZE> used{};
+		for (const std::string& literal : literals)
+			for (const char c : literal)
+				used[static_cast<unsigned char>(c)] = true;
+
+		const size_t usedCount = std::count(used.begin(), used.end(), true);
+		const bool hasOtherClass = usedCount < DFATable::ALPHABET_SIZE;
+		const size_t classCount = usedCount + hasOtherClass;
+
+		DFATable::ClassMapType classes{};
+		for (size_t byte = 0, nextClass = hasOtherClass; byte < DFATable::ALPHABET_SIZE; byte++)
+			if (used[byte])
+				classes[byte] = static_cast<std::uint8_t>(nextClass++);
+
+		// build the trie: row 0 is the dead state, row 1 the root
+		std::vector<FSMStateType> next(2 * classCount);
+		m_StateLiteral.assign(2, NO_LITERAL);
+		m_NextEqualLiteral.assign(literals.size(), NO_LITERAL);
+		m_LiteralLengths.reserve(literals.size());
+
+		for (size_t id = 0; id < literals.size(); id++) {
+			FSMStateType state = startState;
+
+			for (const char c : literals[id]) {
+				FSMStateType& child = next[state * classCount + classes[static_cast<unsigned char>(c)]];
+
+				if (child == deadState) {
+					child = static_cast<FSMStateType>(m_StateLiteral.size());
+					m_StateLiteral.push_back(NO_LITERAL);
+					next.resize(next.size() + classCount);
+				}
+
+				// `child` may have been invalidated by the resize
+				state = next[state * classCount + classes[static_cast<unsigned char>(c)]];
+			}
+
+			m_LiteralLengths.push_back(literals[id].size());
+
+			// chain equal literals after the first one, keeping them in ascending order of ID
+			size_t* tail = &m_StateLiteral[state];
+			while (*tail != NO_LITERAL)
+				tail = &m_NextEqualLiteral[*tail];
+			*tail = id;
+		}
+
+		const size_t stateCount = m_StateLiteral.size();
+		std::vector<FSMStateType> failure(stateCount, startState);
+		m_OutputLink.assign(stateCount, deadState);
+
+		// resolve the failure links into full transitions, breadth first, so that the failure state of every state is resolved before it
+		std::vector<FSMStateType> queue{};
+		queue.reserve(stateCount);
+
+		for (size_t c = 0; c < classCount; c++) {
+			FSMStateType& child = next[startState * classCount + c];
+
+			if (child == deadState)
+				child = startState;
+			else
+				queue.push_back(child);
+		}
+
+		for (size_t i = 0; i < queue.size(); i++) {
+			const FSMStateType state = queue[i];
+			const FSMStateType fail = failure[state];
+
+			for (size_t c = 0; c < classCount; c++) {
+				FSMStateType& child = next[state * classCount + c];
+
+				if (child == deadState) {
+					child = next[fail * classCount + c];
+					continue;
+				}
+
+				const FSMStateType childFail = next[fail * classCount + c];
+				failure[child] = childFail;
+				m_OutputLink[child] = m_StateLiteral[childFail] != NO_LITERAL ? childFail : m_OutputLink[childFail];
+				queue.push_back(child);
+			}
+		}
+
+		// a state is final if it ends some literal, by itself or through its output links
+		FSMStateSetType finalStates{};
+		for (FSMStateType state = startState; state < stateCount; state++) {
+			if (m_StateLiteral[state] != NO_LITERAL || m_OutputLink[state] != deadState)
+				finalStates.insert(state);
+		}
+
+		for (const std::string& literal : literals)
+			m_FirstBytes.insert(static_cast<unsigned char>(literal.front()));
+
+		m_Automaton = AutomatonType{ finalStates, TransFn<DFATable>{ DFATable{ classes, classCount, std::move(next) } } };
+	}
+
+	/**
+	 * @brief Finds every occurrence of every literal in `input`, in a single pass.
+	 * @details Occurrences are reported in ascending order of their end; those that end at the same position are reported in descending order of length. Occurrences may overlap.
+	 * @param[in] input The input string to be searched.
+	 * @param[in] fun The callable that is called with the ID and the Indicies of each occurrence.
+	 */
+	template <typename FunT>
+	void AhoCorasick::findAll(std::string_view input, FunT&& fun) const
+	{
+		constexpr FSMStateType startState = AutomatonType::getStartState();
+		const TransFn<DFATable>& tranFn = m_Automaton.getTransitionFunction();
+		const char* const first = input.data();
+		const char* const last = first + input.size();
+
+		FSMStateType state = startState;
+
+		for (IndexType charIndex = 0; charIndex < input.size(); ) {
+			// no literal is in progress, so skip to the next byte that begins one
+			if (state == startState) {
+				charIndex = findAnyOf(first + charIndex, last, m_FirstBytes) - first;
+
+				if (charIndex >= input.size())
+					break;
+			}
+
+			state = tranFn.nextState(state, input[charIndex++]);
+
+			if (m_StateLiteral[state] == NO_LITERAL && m_OutputLink[state] == AutomatonType::getDeadState())
+				continue;
+
+			this->forEachLiteral(state, [&](const size_t literal) {
+				fun(literal, Indicies{ charIndex - m_LiteralLengths[literal], charIndex });
+				});
+		}
+	}
+
+	/**
+	 * @brief Finds every occurrence of every literal in `input`, in a single pass.
+	 * @return The occurrences, in the order described by findAll(std::string_view, FunT&&) const.
+	 */
+	inline std::vector<LiteralMatch> AhoCorasick::findAll(std::string_view input) const
+	{
+		std::vector<LiteralMatch> res{};
+
+		this->findAll(input, [&res](const size_t literal, const Indicies indicies) {
+			res.push_back(LiteralMatch{ literal, indicies });
+			});
+
+		return res;
+	}
+
+}
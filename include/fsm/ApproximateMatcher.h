@@ -0,0 +1,383 @@
+#pragma once
+
+#include <optional>
+#include <string>
+#include <string_view>
+#include <variant>
+#include <vector>
+
+#include "BitParallelNFA.h"
+#include "NFA.h"
+
+// DECLARATIONS
+namespace m0st4fa::fsm {
+
+	/**
+	 * @brief The result of an approximate simulation: an FSMResult together with the edit distance of the match.
+	 * @see ApproximateMatcher
+	 */
+	struct ApproximateResult : public FSMResult {
+		//! @brief The number of edits (insertions, deletions and substitutions of single symbols) that the match is away from a string accepted by the machine; 0 if nothing matched.
+		size_t distance = 0;
+	};
+
+	/**
+	 * @brief A bit-parallel engine that simulates an NFA allowing up to a given number of errors, for NFAs having at most `64 * WordCount` (reachable) states.
+	 * @details The k-error NFA (the NFA stacked `k + 1` times, where moving from a level to the next costs an insertion, a deletion or a substitution) is never built: as in the algorithm of Wu and Manber, each level is held as a mask of the states of the original NFA, so a symbol costs `k + 1` steps of the exact engine (see BitParallelNFA::step()), plus a step on "any symbol" per level for the errors. The levels are such that each one contains the previous one, so the edit distance of a position is the first level holding a final state.
+	 * @note Objects of this type are typically created and used by ApproximateMatcher.
+	 */
+	template <size_t WordCount>
+	class ApproximateNFA {
+	public:
+		//! @brief The type of a set of states.
+		using MaskType = StateMask<WordCount>;
+
+	private:
+		//! @brief The engine simulating the NFA without errors.
+		BitParallelNFA<WordCount> m_Engine;
+		//! @brief The states that each state leads to on any symbol, indexed by bit index. Used for substitutions and deletions.
+		std::vector<MaskType> m_AnySuccessors;
+		//! @brief The states active before any input is read, at each number of errors (the start state and the states up to that many deletions away).
+		std::vector<MaskType> m_StartLevels;
+		size_t m_MaxErrors = 0;
+
+		MaskType _step_any(const MaskType&) const noexcept;
+		template <typename SymbolT>
+		void _step(std::vector<MaskType>&, std::vector<MaskType>&, const SymbolT, const bool) const noexcept;
+		std::optional<size_t> _distance(const std::vector<MaskType>&) const noexcept;
+		template <typename InputT>
+		std::optional<size_t> _anchored_distance(const InputT&, const IndexType, const IndexType, std::vector<MaskType>&, std::vector<MaskType>&) const;
+		ApproximateResult _result(const bool, const std::vector<MaskType>&, const size_t, const Indicies, const auto&) const;
+
+	public:
+		//! @brief Default constructor.
+		ApproximateNFA() = default;
+
+		ApproximateNFA(BitParallelNFA<WordCount>, const size_t, const bool);
+
+		//! @brief Gets the maximum number of errors that a match may have.
+		size_t getMaxErrors() const { return m_MaxErrors; };
+
+		template <typename InputT>
+		ApproximateResult simulate(const InputT&, const FSM_MODE) const;
+	};
+
+	/**
+	 * @brief An approximate engine of whichever width fits a given NFA, or `std::monostate` if none does.
+	 */
+	using ApproximateNFAVariant = std::variant<std::monostate, ApproximateNFA<1>, ApproximateNFA<2>, ApproximateNFA<4>>;
+
+	/**
+	 * @brief Finds the strings that are within a given edit distance of those accepted by an NFA (e.g. identifiers with a few typos).
+	 * @details The machine is compiled into a bit-parallel engine (see ApproximateNFA), so it must have at most 256 states reachable from its start state, and its input must be byte-sized.
+	 */
+	class ApproximateMatcher {
+		//! @brief The engine simulating the machine.
+		ApproximateNFAVariant m_Engine{};
+		size_t m_MaxErrors = 0;
+
+		ApproximateMatcher(BitParallelNFAVariant, const size_t, const bool);
+
+	public:
+		//! @brief Default constructor. The constructed matcher matches nothing.
+		ApproximateMatcher() = default;
+
+		template <typename TransFuncT, typename InputT>
+		ApproximateMatcher(const NonDeterFiniteAutomaton<TransFuncT, InputT>&, const size_t);
+
+		static ApproximateMatcher fromLiteral(std::string_view, const size_t);
+
+		//! @brief Gets the maximum number of errors that a match may have.
+		size_t getMaxErrors() const { return m_MaxErrors; };
+
+		template <typename InputT>
+		ApproximateResult simulate(const InputT&, const FSM_MODE) const;
+	};
+
+}
+
+// IMPLEMENTATIONS
+namespace m0st4fa::fsm {
+
+	/**
+	 * @brief Initialize a new engine out of the engine simulating an NFA without errors.
+	 * @param[in] engine The engine simulating the NFA without errors.
+	 * @param[in] maxErrors The maximum number of errors that a match may have.
+	 * @param[in] epsilonClosure Whether the NFA is an epsilon NFA, in which case `'\0'` is not a symbol that can be substituted or deleted.
+	 */
+	template <size_t WordCount>
+	ApproximateNFA<WordCount>::ApproximateNFA(BitParallelNFA<WordCount> engine, const size_t maxErrors, const bool epsilonClosure) :
+		m_Engine{ std::move(engine) }, m_AnySuccessors(m_Engine.getStateCount()), m_MaxErrors{ maxErrors }
+	{
+		for (size_t i = 0; i < m_Engine.getStateCount(); i++) {
+			MaskType state{};
+			state.set(i);
+
+			for (size_t symbol = epsilonClosure; symbol < BitParallelNFA<WordCount>::ALPHABET_SIZE; symbol++)
+				m_AnySuccessors[i] |= m_Engine.step(state, static_cast<unsigned char>(symbol));
+		}
+
+		m_StartLevels.push_back(m_Engine.getStartMask());
+		for (size_t i = 1; i <= m_MaxErrors; i++)
+			m_StartLevels.push_back(m_StartLevels.back() | this->_step_any(m_StartLevels.back()));
+	}
+
+	//! @brief Computes the set of states that the states of `active` lead to on any symbol.
+	template <size_t WordCount>
+	typename ApproximateNFA<WordCount>::MaskType ApproximateNFA<WordCount>::_step_any(const MaskType& active) const noexcept
+	{
+		MaskType next{};
+
+		for (size_t w = 0; w < WordCount; w++)
+			for (std::uint64_t bits = active.words[w]; bits; bits &= bits - 1)
+				next |= m_AnySuccessors[w * 64 + std::countr_zero(bits)];
+
+		return next;
+	}
+
+	/**
+	 * @brief Advances the levels of the simulation over `input`.
+	 * @details Level `i` is reached by a match (read without errors) of level `i`, or by an insertion (`input` skipped), a substitution (`input` read as any symbol) or a deletion (any symbol read without `input`) from level `i - 1`.
+	 * @param levels The states active at each number of errors, advanced in place.
+	 * @param prev Scratch space, of the same size as `levels`.
+	 * @param[in] input The input symbol.
+	 * @param[in] unanchored Whether a match may begin at this position, in which case the start levels are added first.
+	 */
+	template <size_t WordCount>
+	template <typename SymbolT>
+	void ApproximateNFA<WordCount>::_step(std::vector<MaskType>& levels, std::vector<MaskType>& prev, const SymbolT input, const bool unanchored) const noexcept
+	{
+		levels.swap(prev);
+
+		if (unanchored)
+			for (size_t i = 0; i <= m_MaxErrors; i++)
+				prev[i] |= m_StartLevels[i];
+
+		levels[0] = m_Engine.step(prev[0], input);
+
+		for (size_t i = 1; i <= m_MaxErrors; i++)
+			levels[i] = m_Engine.step(prev[i], input) | prev[i - 1] | this->_step_any(prev[i - 1]) | this->_step_any(levels[i - 1]);
+	}
+
+	/**
+	 * @brief Gets the number of errors of the best match ending at the current position.
+	 * @return The first level holding a final state, if any.
+	 */
+	template <size_t WordCount>
+	std::optional<size_t> ApproximateNFA<WordCount>::_distance(const std::vector<MaskType>& levels) const noexcept
+	{
+		for (size_t i = 0; i <= m_MaxErrors; i++)
+			if (m_Engine.isFinal(levels[i]))
+				return i;
+
+		return std::nullopt;
+	}
+
+	/**
+	 * @brief Computes the edit distance of `input.substr(start, end - start)`, stopping once no level is active.
+	 * @return The edit distance, if it is at most the maximum number of errors.
+	 */
+	template <size_t WordCount>
+	template <typename InputT>
+	std::optional<size_t> ApproximateNFA<WordCount>::_anchored_distance(const InputT& input, const IndexType start, const IndexType end, std::vector<MaskType>& levels, std::vector<MaskType>& prev) const
+	{
+		levels = m_StartLevels;
+
+		// the levels contain one another, so the last one is empty only if all of them are
+		for (IndexType i = start; i < end && levels.back().any(); i++)
+			this->_step(levels, prev, input[i], false);
+
+		return this->_distance(levels);
+	}
+
+	//! @brief Makes the result of a simulation whose match has `distance` errors and ends with the states of `levels`.
+	template <size_t WordCount>
+	ApproximateResult ApproximateNFA<WordCount>::_result(const bool accepted, const std::vector<MaskType>& levels, const size_t distance, const Indicies indicies, const auto& input) const
+	{
+		if (!accepted)
+			return ApproximateResult{ FSMResult(false, {}, { 0, 0 }, input), 0 };
+
+		return ApproximateResult{ FSMResult(true, m_Engine.toStateSet(levels[distance] & m_Engine.getFinalMask()), indicies, input), distance };
+	}
+
+	/**
+	* @brief Simulate the given input string using the given simulation method, allowing up to getMaxErrors() errors.
+	* @details Matches are chosen by their edit distance first:
+	* - FSM_MODE::MM_WHOLE_STRING: the distance of the whole string.
+	* - FSM_MODE::MM_LONGEST_PREFIX: the longest of the prefixes of the smallest distance.
+	* - FSM_MODE::MM_LONGEST_SUBSTRING: the best substring: of the smallest distance, the one that ends first, extended to the earliest start having that distance. The start is found by running the engine anchored from each earlier position in turn, so this mode costs more than the others.
+	* - FSM_MODE::MM_COUNT_ENDS: the number of positions at which a match ends; the distance is not reported.
+	* - FSM_MODE::MM_ANY_MATCH: the first match to end, with the indicies spanning the input up to its end (as for exact simulations).
+	* @param[in] input The input string to be simulated.
+	* @param[in] mode The simulation mode.
+	* @throw UnrecognizedSimModeException Thrown in case a mode other than the above is entered.
+	* @return ApproximateResult object indicating the result of the simulation, and the edit distance of the match.
+	*/
+	template <size_t WordCount>
+	template <typename InputT>
+	ApproximateResult ApproximateNFA<WordCount>::simulate(const InputT& input, const FSM_MODE mode) const
+	{
+		std::vector<MaskType> levels = m_StartLevels, prev(m_MaxErrors + 1);
+		std::optional<size_t> distance = this->_distance(levels);
+
+		switch (mode) {
+		case FSM_MODE::MM_WHOLE_STRING: {
+			for (IndexType i = 0; i < input.size() && levels.back().any(); i++)
+				this->_step(levels, prev, input[i], false);
+
+			distance = this->_distance(levels);
+
+			return this->_result(distance.has_value(), levels, distance.value_or(0), { 0, input.size() }, input);
+		}
+		case FSM_MODE::MM_LONGEST_PREFIX: {
+			std::optional<size_t> best = distance;
+			std::vector<MaskType> bestLevels = levels;
+			IndexType end = 0;
+
+			// later prefixes are longer, so they replace earlier ones of the same distance
+			for (IndexType i = 0; i < input.size() && levels.back().any(); i++) {
+				this->_step(levels, prev, input[i], false);
+				distance = this->_distance(levels);
+
+				if (distance && (!best || *distance <= *best)) {
+					best = distance;
+					bestLevels = levels;
+					end = i + 1;
+				}
+			}
+
+			return this->_result(best.has_value(), bestLevels, best.value_or(0), { 0, end }, input);
+		}
+		case FSM_MODE::MM_LONGEST_SUBSTRING: {
+			std::optional<size_t> best = distance;
+			std::vector<MaskType> bestLevels = levels;
+			IndexType end = 0;
+
+			// no match is better than an exact one
+			for (IndexType i = 0; i < input.size() && best != 0; i++) {
+				this->_step(levels, prev, input[i], true);
+				distance = this->_distance(levels);
+
+				if (distance && (!best || *distance < *best)) {
+					best = distance;
+					bestLevels = levels;
+					end = i + 1;
+				}
+			}
+
+			if (!best)
+				return this->_result(false, levels, 0, {}, input);
+
+			// find the earliest start of a match of the same distance ending at `end`
+			std::vector<MaskType> scratchLevels{}, scratchPrev(m_MaxErrors + 1);
+			IndexType start = 0;
+
+			for (; start < end; start++)
+				if (const std::optional<size_t> d = this->_anchored_distance(input, start, end, scratchLevels, scratchPrev); d && *d <= *best)
+					break;
+
+			return this->_result(true, bestLevels, *best, { start, end }, input);
+		}
+		case FSM_MODE::MM_COUNT_ENDS: {
+			size_t count = 0;
+
+			for (IndexType i = 0; i < input.size(); i++) {
+				this->_step(levels, prev, input[i], true);
+				count += this->_distance(levels).has_value();
+			}
+
+			return ApproximateResult{ FSMResult(count > 0, {}, { 0, 0 }, input, count), 0 };
+		}
+		case FSM_MODE::MM_ANY_MATCH: {
+			// the empty string is a substring of every input
+			if (distance)
+				return this->_result(true, levels, *distance, { 0, 0 }, input);
+
+			for (IndexType i = 0; i < input.size(); i++) {
+				this->_step(levels, prev, input[i], true);
+
+				if (distance = this->_distance(levels); distance)
+					return this->_result(true, levels, *distance, { 0, i + 1 }, input);
+			}
+
+			return this->_result(false, levels, 0, {}, input);
+		}
+		default:
+			throw UnrecognizedSimModeException();
+		}
+	}
+
+	/**
+	 * @brief Initialize a new matcher out of an engine simulating a machine without errors.
+	 * @throw StateLimitExceededException Thrown if there is no engine (the machine has too many states).
+	 */
+	inline ApproximateMatcher::ApproximateMatcher(BitParallelNFAVariant engine, const size_t maxErrors, const bool epsilonClosure) :
+		m_MaxErrors{ maxErrors }
+	{
+		if (std::holds_alternative<std::monostate>(engine)) {
+			const std::string message = "ApproximateMatcher: The machine has too many states to be simulated bit-parallel.";
+			Logger{}.log(LoggerInfo::LL_ERROR, message);
+			throw StateLimitExceededException{ message };
+		}
+
+		std::visit([this, maxErrors, epsilonClosure](auto& exact) {
+			if constexpr (!std::is_same_v<std::decay_t<decltype(exact)>, std::monostate>)
+				m_Engine = ApproximateNFA{ std::move(exact), maxErrors, epsilonClosure };
+			}, engine);
+	}
+
+	/**
+	 * @brief Initialize a new matcher of the strings within `maxErrors` edits of those accepted by an NFA.
+	 * @param[in] machine The NFA. It may be an epsilon NFA.
+	 * @param[in] maxErrors The maximum number of errors that a match may have.
+	 * @throw StateLimitExceededException Thrown if the NFA has more than 256 states reachable from its start state.
+	 */
+	template <typename TransFuncT, typename InputT>
+	ApproximateMatcher::ApproximateMatcher(const NonDeterFiniteAutomaton<TransFuncT, InputT>& machine, const size_t maxErrors) :
+		ApproximateMatcher{
+			compileBitParallelNFA(machine.getTransitionFunction(), machine.getFinalStates(), machine.getMachineType() == FSM_TYPE::MT_EPSILON_NFA),
+			maxErrors,
+			machine.getMachineType() == FSM_TYPE::MT_EPSILON_NFA
+		}
+	{
+		static_assert(sizeof(std::ranges::range_value_t<InputT>) == 1, "ApproximateMatcher: Only machines over byte-sized input are supported.");
+	}
+
+	/**
+	 * @brief Creates a matcher of the strings within `maxErrors` edits of `literal`.
+	 * @param[in] literal The literal, of at most 255 symbols.
+	 * @param[in] maxErrors The maximum number of errors that a match may have.
+	 * @throw StateLimitExceededException Thrown if the literal is longer than 255 symbols.
+	 */
+	inline ApproximateMatcher ApproximateMatcher::fromLiteral(std::string_view literal, const size_t maxErrors)
+	{
+		if (literal.size() >= BitParallelNFA<4>::MAX_STATE_COUNT) {
+			const std::string message = "ApproximateMatcher: The literal is too long to be simulated bit-parallel.";
+			Logger{}.log(LoggerInfo::LL_ERROR, message);
+			throw StateLimitExceededException{ message };
+		}
+
+		constexpr FSMStateType startState = FiniteStateMachine<TransFn<FSMTable>>::getStartState();
+
+		FSMTable table{};
+		const FSMStateType finalState = table.set(startState, std::string{ literal });
+
+		return ApproximateMatcher{ compileBitParallelNFA(TransFn<FSMTable>{ table }, FSMStateSetType{ finalState }, false), maxErrors, false };
+	}
+
+	/**
+	 * @brief Simulate the given input string using the given simulation method, allowing up to getMaxErrors() errors.
+	 * @see ApproximateNFA::simulate
+	 */
+	template <typename InputT>
+	ApproximateResult ApproximateMatcher::simulate(const InputT& input, const FSM_MODE mode) const
+	{
+		return std::visit([&input, mode](const auto& engine) -> ApproximateResult {
+			if constexpr (std::is_same_v<std::decay_t<decltype(engine)>, std::monostate>)
+				return ApproximateResult{ FSMResult(false, {}, { 0, 0 }, input), 0 };
+			else
+				return engine.simulate(input, mode);
+			}, m_Engine);
+	}
+
+}
@@ -0,0 +1,381 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include "FiniteStateMachine.h"
+
+// DECLARATIONS
+namespace m0st4fa::fsm {
+
+	/**
+	 * @brief The work done by a single worker of a BatchMatcher during a batch.
+	 */
+	struct WorkerStats {
+		//! @brief The number of inputs that the worker simulated.
+		size_t inputCount = 0;
+		//! @brief The total size of the inputs that the worker simulated.
+		size_t byteCount = 0;
+		//! @brief The number of times that the worker stole work from another worker.
+		size_t stealCount = 0;
+		//! @brief The time that the worker spent on the batch.
+		std::chrono::nanoseconds busyTime{};
+
+		/**
+		 * @brief Gets the throughput of the worker, in bytes per second.
+		 */
+		double getThroughput() const {
+			const double seconds = std::chrono::duration<double>(busyTime).count();
+			return seconds > 0 ? byteCount / seconds : 0.0;
+		}
+	};
+
+	/**
+	 * @brief Simulates a state machine against batches of independent inputs, in parallel.
+	 * @details The matcher owns a pool of worker threads that share a single (constant) machine. Each batch is split evenly among the workers, and each worker takes chunks off the front of its share, whose size shrinks as the share does (guided scheduling). A worker that runs out of work steals the back half of the remaining share of another worker, so that inputs of very different sizes do not leave workers idle. The calling thread takes part in every batch as the first worker.
+	 * @note The machine must outlive the matcher and must not be modified while a batch is running. Batches are run one at a time; calling simulate() from many threads at once is safe but serializes the batches.
+	 */
+	template <typename MachineT>
+	class BatchMatcher {
+
+		/**
+		 * @brief The share of the batch that is left to a worker, i.e. the indicies `[begin, end)`.
+		 * @note Shares are aligned to cache lines, so that workers do not contend on each other's shares unless they steal.
+		 */
+		struct alignas(64) Share {
+			std::mutex mutex;
+			size_t begin = 0;
+			size_t end = 0;
+		};
+
+		//! @brief The machine shared by the workers.
+		const MachineT* m_Machine = nullptr;
+		//! @brief The number of workers, including the calling thread.
+		size_t m_WorkerCount = 1;
+		//! @brief The share of each worker.
+		std::unique_ptr<Share[]> m_Shares{};
+		//! @brief The work done by each worker during the last batch.
+		std::vector<WorkerStats> m_Stats{};
+		//! @brief The background workers (every worker but the first).
+		std::vector<std::thread> m_Threads{};
+
+		//! @brief Simulates the input at the given index and returns its size.
+		std::function<size_t(size_t)> m_Task{};
+		//! @brief Set once a worker fails, so that the rest stop taking work.
+		std::atomic<bool> m_Cancelled = false;
+		//! @brief The first exception thrown by a worker during the current batch.
+		std::exception_ptr m_Error{};
+
+		//! @brief Serializes batches.
+		std::mutex m_BatchMutex{};
+		//! @brief Guards the fields below, which coordinate the background workers.
+		std::mutex m_Mutex{};
+		std::condition_variable m_WakeUp{};
+		std::condition_variable m_Done{};
+		size_t m_Generation = 0;
+		size_t m_Pending = 0;
+		bool m_Stop = false;
+
+		void _worker_loop(const size_t);
+		void _run(const size_t);
+		bool _take(const size_t, size_t&, size_t&);
+		bool _steal(const size_t);
+		void _run_batch(const size_t, std::function<size_t(size_t)>);
+
+	public:
+
+		//! @brief The largest number of inputs that a worker takes off its share at once.
+		static constexpr size_t MAX_CHUNK_SIZE = 256;
+
+		explicit BatchMatcher(const MachineT&, size_t = std::thread::hardware_concurrency());
+		~BatchMatcher();
+
+		BatchMatcher(const BatchMatcher&) = delete;
+		BatchMatcher& operator=(const BatchMatcher&) = delete;
+
+		template <typename InputT>
+		void simulate(std::span<const InputT>, std::span<FSMResult>, const FSM_MODE);
+
+		template <typename InputT>
+		std::vector<FSMResult> simulate(std::span<const InputT>, const FSM_MODE);
+
+		//! @brief Gets the number of workers, including the calling thread.
+		size_t getWorkerCount() const { return m_WorkerCount; };
+
+		//! @brief Gets the work done by each worker during the last batch.
+		const std::vector<WorkerStats>& getStats() const { return m_Stats; };
+
+	};
+
+}
+
+// IMPLEMENTATIONS
+namespace m0st4fa::fsm {
+
+	/**
+	 * @brief Initialize a new matcher and start its workers.
+	 * @param[in] machine The machine that every input is simulated against.
+	 * @param[in] workerCount The number of workers, including the calling thread. If it is 0 (e.g. the number of hardware threads is unknown), a single worker is used.
+	 * @note If a worker thread cannot be started, the matcher uses the workers that were started before it; see getWorkerCount().
+	 */
+	template <typename MachineT>
+	BatchMatcher<MachineT>::BatchMatcher(const MachineT& machine, size_t workerCount) :
+		m_Machine{ &machine }, m_WorkerCount{ std::max<size_t>(workerCount, 1) }
+	{
+		m_Shares = std::make_unique<Share[]>(m_WorkerCount);
+		m_Stats.resize(m_WorkerCount);
+
+		m_Threads.reserve(m_WorkerCount - 1);
+
+		try {
+			for (size_t worker = 1; worker < m_WorkerCount; worker++)
+				m_Threads.emplace_back(&BatchMatcher::_worker_loop, this, worker);
+		}
+		catch (const std::system_error&) {
+			// make do with the workers that were started (the calling thread being one of them), so that none is left unjoined
+			m_WorkerCount = m_Threads.size() + 1;
+			m_Stats.resize(m_WorkerCount);
+		}
+	}
+
+	/**
+	 * @brief Stops the workers and waits for them to exit.
+	 */
+	template <typename MachineT>
+	BatchMatcher<MachineT>::~BatchMatcher()
+	{
+		{
+			std::lock_guard lock{ m_Mutex };
+			m_Stop = true;
+		}
+
+		m_WakeUp.notify_all();
+
+		for (std::thread& thread : m_Threads)
+			thread.join();
+	}
+
+	/**
+	 * @brief Simulates the machine against every input of a batch, in parallel.
+	 * @param[in] inputs The inputs to simulate the machine against.
+	 * @param[out] results Receives the result of each input, at the same index as the input. The results refer to the inputs.
+	 * @param[in] mode The mode of the simulation.
+	 * @throw InvalidStateMachineArgumentsException Thrown if `results` and `inputs` are not of the same size.
+	 * @throw Any exception thrown by the simulation of any input (the first one thrown is rethrown once the workers stop).
+	 */
+	template <typename MachineT>
+	template <typename InputT>
+	void BatchMatcher<MachineT>::simulate(std::span<const InputT> inputs, std::span<FSMResult> results, const FSM_MODE mode)
+	{
+		if (inputs.size() != results.size()) {
+			const std::string message = "BatchMatcher: There must be exactly one result for every input.";
+			Logger{}.log(LoggerInfo::LL_ERROR, message);
+			throw InvalidStateMachineArgumentsException{ message };
+		}
+
+		this->_run_batch(inputs.size(), [this, inputs, results, mode](const size_t index) {
+			results[index] = m_Machine->simulate(inputs[index], mode);
+			return inputs[index].size();
+			});
+	}
+
+	/**
+	 * @brief Simulates the machine against every input of a batch, in parallel.
+	 * @param[in] inputs The inputs to simulate the machine against.
+	 * @param[in] mode The mode of the simulation.
+	 * @return The result of each input, at the same index as the input. The results refer to the inputs.
+	 */
+	template <typename MachineT>
+	template <typename InputT>
+	std::vector<FSMResult> BatchMatcher<MachineT>::simulate(std::span<const InputT> inputs, const FSM_MODE mode)
+	{
+		std::vector<FSMResult> results(inputs.size());
+
+		this->simulate(inputs, std::span<FSMResult>{ results }, mode);
+
+		return results;
+	}
+
+	/**
+	 * @brief Splits the indicies `[0, count)` among the workers, runs `task` on each of them and waits for all of them to finish.
+	 */
+	template <typename MachineT>
+	void BatchMatcher<MachineT>::_run_batch(const size_t count, std::function<size_t(size_t)> task)
+	{
+		std::lock_guard batchLock{ m_BatchMutex };
+
+		m_Task = std::move(task);
+		m_Cancelled = false;
+		m_Error = nullptr;
+
+		for (size_t worker = 0; worker < m_WorkerCount; worker++) {
+			Share& share = m_Shares[worker];
+			std::lock_guard lock{ share.mutex };
+			share.begin = count * worker / m_WorkerCount;
+			share.end = count * (worker + 1) / m_WorkerCount;
+		}
+
+		{
+			std::lock_guard lock{ m_Mutex };
+			m_Pending = m_WorkerCount - 1;
+			m_Generation++;
+		}
+
+		m_WakeUp.notify_all();
+
+		// the calling thread is the first worker
+		this->_run(0);
+
+		{
+			std::unique_lock lock{ m_Mutex };
+			m_Done.wait(lock, [this] { return m_Pending == 0; });
+		}
+
+		m_Task = nullptr;
+
+		if (m_Error)
+			std::rethrow_exception(m_Error);
+	}
+
+	/**
+	 * @brief The loop of a background worker: waits for a batch, runs it and reports back, until the matcher is destroyed.
+	 */
+	template <typename MachineT>
+	void BatchMatcher<MachineT>::_worker_loop(const size_t worker)
+	{
+		size_t generation = 0;
+
+		while (true) {
+			{
+				std::unique_lock lock{ m_Mutex };
+				m_WakeUp.wait(lock, [this, generation] { return m_Stop || m_Generation != generation; });
+
+				if (m_Stop)
+					return;
+
+				generation = m_Generation;
+			}
+
+			this->_run(worker);
+
+			{
+				std::lock_guard lock{ m_Mutex };
+				m_Pending--;
+			}
+
+			m_Done.notify_one();
+		}
+	}
+
+	/**
+	 * @brief Runs the worker's share of the current batch, then steals from the other workers until no work is left.
+	 */
+	template <typename MachineT>
+	void BatchMatcher<MachineT>::_run(const size_t worker)
+	{
+		// accumulate locally, so that workers do not write to the same cache lines
+		WorkerStats stats{};
+		const auto startTime = std::chrono::steady_clock::now();
+
+		try {
+			while (!m_Cancelled.load(std::memory_order_relaxed)) {
+				size_t first = 0, last = 0;
+
+				if (!this->_take(worker, first, last)) {
+					if (!this->_steal(worker))
+						break;
+
+					stats.stealCount++;
+					continue;
+				}
+
+				for (size_t index = first; index < last; index++)
+					stats.byteCount += m_Task(index);
+
+				stats.inputCount += last - first;
+			}
+		}
+		catch (...) {
+			std::lock_guard lock{ m_Mutex };
+
+			if (!m_Error)
+				m_Error = std::current_exception();
+
+			m_Cancelled = true;
+		}
+
+		stats.busyTime = std::chrono::steady_clock::now() - startTime;
+		m_Stats[worker] = stats;
+	}
+
+	/**
+	 * @brief Takes a chunk off the front of the worker's share.
+	 * @details The chunk is an eighth of the remaining share (at least one input and at most MAX_CHUNK_SIZE inputs), so that the chunks get smaller, and cheaper to wait for, as the batch nears its end.
+	 * @param[out] first The index of the first input of the chunk.
+	 * @param[out] last The index after the last input of the chunk.
+	 * @return `true` if a chunk was taken; `false` if the share is empty.
+	 */
+	template <typename MachineT>
+	bool BatchMatcher<MachineT>::_take(const size_t worker, size_t& first, size_t& last)
+	{
+		Share& share = m_Shares[worker];
+		std::lock_guard lock{ share.mutex };
+
+		const size_t remaining = share.end - share.begin;
+
+		if (!remaining)
+			return false;
+
+		first = share.begin;
+		last = first + std::clamp<size_t>(remaining / 8, 1, MAX_CHUNK_SIZE);
+		share.begin = last;
+
+		return true;
+	}
+
+	/**
+	 * @brief Steals the back half of the remaining share of some other worker, and makes it the worker's share.
+	 * @return `true` if anything was stolen; `false` if every other share is empty.
+	 */
+	template <typename MachineT>
+	bool BatchMatcher<MachineT>::_steal(const size_t worker)
+	{
+		for (size_t offset = 1; offset < m_WorkerCount; offset++) {
+			Share& victim = m_Shares[(worker + offset) % m_WorkerCount];
+			size_t first = 0, last = 0;
+
+			{
+				std::lock_guard lock{ victim.mutex };
+
+				const size_t remaining = victim.end - victim.begin;
+
+				if (!remaining)
+					continue;
+
+				first = victim.end - (remaining + 1) / 2;
+				last = victim.end;
+				victim.end = first;
+			}
+
+			Share& share = m_Shares[worker];
+			std::lock_guard lock{ share.mutex };
+			share.begin = first;
+			share.end = last;
+
+			return true;
+		}
+
+		return false;
+	}
+
+}
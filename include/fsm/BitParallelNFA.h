@@ -0,0 +1,431 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <variant>
+#include <assert.h>
+
+#include "FiniteStateMachine.h"
+#include "Prefilter.h"
+
+// DECLARATIONS
+namespace m0st4fa::fsm {
+
+	/**
+	 * @brief A set of NFA states, stored as a bit mask made of `WordCount` 64-bit words.
+	 * @details Bit `i` corresponds to the `i`-th state of the machine (in the compact numbering used by BitParallelNFA), not to the state `i` itself.
+	 */
+	template <size_t WordCount>
+	struct StateMask {
+		std::array<std::uint64_t, WordCount> words{};
+
+		//! @brief Adds the state whose bit index is `index` to the mask.
+		constexpr void set(const size_t index) noexcept {
+			words[index / 64] |= std::uint64_t{ 1 } << (index % 64);
+		}
+
+		//! @brief Checks whether the state whose bit index is `index` is in the mask.
+		constexpr bool test(const size_t index) const noexcept {
+			return (words[index / 64] >> (index % 64)) & 1;
+		}
+
+		//! @brief Checks whether the mask contains at least one state.
+		constexpr bool any() const noexcept {
+			for (const std::uint64_t word : words)
+				if (word)
+					return true;
+
+			return false;
+		}
+
+		constexpr StateMask& operator|=(const StateMask& rhs) noexcept {
+			for (size_t i = 0; i < WordCount; i++)
+				words[i] |= rhs.words[i];
+
+			return *this;
+		}
+
+		constexpr StateMask& operator&=(const StateMask& rhs) noexcept {
+			for (size_t i = 0; i < WordCount; i++)
+				words[i] &= rhs.words[i];
+
+			return *this;
+		}
+
+		constexpr StateMask operator|(const StateMask& rhs) const noexcept {
+			StateMask res{ *this };
+			return res |= rhs;
+		}
+
+		constexpr StateMask operator&(const StateMask& rhs) const noexcept {
+			StateMask res{ *this };
+			return res &= rhs;
+		}
+
+		constexpr auto operator<=>(const StateMask&) const = default;
+	};
+
+	/**
+	 * @brief A bit-parallel simulation engine for NFAs having at most `64 * WordCount` (reachable) states.
+	 * @details The whole set of active states is held in `WordCount` machine words. The NFA is compiled so that, for every input symbol, each state is mapped to the mask of states it leads to, with the epsilon closure of those states already folded in. A transition over a set of states then costs one OR per active state instead of the set unions done by NonDeterFiniteAutomaton.
+	 * Input symbols are grouped into classes of symbols on which every state behaves identically, so that the tables stay small.
+	 * @note Only byte-sized input symbols are supported. Objects of this type are typically created by compileBitParallelNFA() and used by NonDeterFiniteAutomaton automatically.
+	 */
+	template <size_t WordCount>
+	class BitParallelNFA {
+	public:
+		//! @brief The type of a set of states.
+		using MaskType = StateMask<WordCount>;
+
+		//! @brief The maximum number of states that an engine of this width can simulate.
+		static constexpr size_t MAX_STATE_COUNT = 64 * WordCount;
+
+		//! @brief The number of input symbols that an engine recognizes.
+		static constexpr size_t ALPHABET_SIZE = 256;
+
+	private:
+		//! @brief The class of each input symbol.
+		std::array<std::uint8_t, ALPHABET_SIZE> m_SymbolClasses{};
+		//! @brief The mask of states that each state leads to on each symbol class, indexed by `class * m_StateCount + state`.
+		std::vector<MaskType> m_Successors;
+		//! @brief The original state corresponding to each bit index.
+		std::vector<FSMStateType> m_States;
+		MaskType m_StartMask{};
+		MaskType m_FinalMask{};
+		size_t m_StateCount = 0;
+
+		std::optional<IndexType> _longest_prefix(const auto&, const IndexType, MaskType&) const;
+
+	public:
+		//! @brief Default constructor.
+		BitParallelNFA() = default;
+
+		/**
+		 * @brief Initialize a new engine out of an already-compiled NFA.
+		 * @param[in] symbolClasses The class of each input symbol.
+		 * @param[in] successors The states that each state leads to on each symbol class, indexed by `class * states.size() + state`, where states are given by their index into `states`.
+		 * @param[in] states The original states of the NFA. The start state must be the first.
+		 * @param[in] fStates The set of final states of the NFA.
+		 */
+		BitParallelNFA(const std::array<std::uint8_t, ALPHABET_SIZE>& symbolClasses, const std::vector<StateMask<4>>& successors, const std::vector<FSMStateType>& states, const FSMStateSetType& fStates);
+
+		//! @brief Gets the set of states that the simulation starts from.
+		const MaskType& getStartMask() const { return m_StartMask; };
+
+		//! @brief Gets the set of final states.
+		const MaskType& getFinalMask() const { return m_FinalMask; };
+
+		//! @brief Gets the number of states of the engine.
+		size_t getStateCount() const { return m_StateCount; };
+
+		//! @brief Checks whether `mask` contains at least one final state.
+		bool isFinal(const MaskType& mask) const {
+			return (mask & m_FinalMask).any();
+		}
+
+		/**
+		 * @brief Computes the set of states that the states of `active` lead to on `input`.
+		 * @param[in] active The set of active states.
+		 * @param[in] input The input symbol.
+		 * @return The (epsilon-closed) set of states that `active` leads to on `input`.
+		 */
+		template <typename SymbolT>
+		MaskType step(const MaskType& active, const SymbolT input) const noexcept {
+			MaskType next{};
+			const MaskType* const successors = m_Successors.data() + m_SymbolClasses[toSymbolIndex(input)] * m_StateCount;
+
+			for (size_t w = 0; w < WordCount; w++)
+				for (std::uint64_t bits = active.words[w]; bits; bits &= bits - 1)
+					next |= successors[w * 64 + std::countr_zero(bits)];
+
+			return next;
+		}
+
+		//! @brief Converts `mask` into a set of the original states of the NFA.
+		FSMStateSetType toStateSet(const MaskType& mask) const;
+
+		template <typename InputT>
+		FSMResult simulate(const InputT&, const FSM_MODE, const Prefilter& = {}) const;
+	};
+
+	/**
+	 * @brief An engine of whichever width fits a given NFA, or `std::monostate` if none does.
+	 */
+	using BitParallelNFAVariant = std::variant<std::monostate, BitParallelNFA<1>, BitParallelNFA<2>, BitParallelNFA<4>>;
+
+	template <typename TransFuncT>
+	BitParallelNFAVariant compileBitParallelNFA(const TransFuncT&, const FSMStateSetType&, const bool);
+
+}
+
+// IMPLEMENTATIONS
+namespace m0st4fa::fsm {
+
+	template <size_t WordCount>
+	BitParallelNFA<WordCount>::BitParallelNFA(const std::array<std::uint8_t, ALPHABET_SIZE>& symbolClasses, const std::vector<StateMask<4>>& successors, const std::vector<FSMStateType>& states, const FSMStateSetType& fStates) :
+		m_SymbolClasses{ symbolClasses }, m_States{ states }, m_StateCount{ states.size() }
+	{
+		assert(states.size() <= MAX_STATE_COUNT);
+
+		// narrow the masks down to the width of this engine
+		m_Successors.resize(successors.size());
+		for (size_t i = 0; i < successors.size(); i++)
+			std::copy_n(successors[i].words.begin(), WordCount, m_Successors[i].words.begin());
+
+		m_StartMask.set(0);
+		for (size_t i = 0; i < m_StateCount; i++)
+			if (fStates.contains(m_States[i]))
+				m_FinalMask.set(i);
+	}
+
+	template <size_t WordCount>
+	FSMStateSetType BitParallelNFA<WordCount>::toStateSet(const MaskType& mask) const
+	{
+		FSMStateSetType res;
+
+		for (size_t i = 0; i < m_StateCount; i++)
+			if (mask.test(i))
+				res.insert(m_States[i]);
+
+		return res;
+	}
+
+	/**
+	 * @brief Finds the longest prefix of `input.substr(start)` that the NFA accepts.
+	 * @param[in] input The input string.
+	 * @param[in] start The index at which the prefix starts.
+	 * @param[out] finalMask The final states reached at the end of the prefix, if any.
+	 * @return The index of the character after the prefix, if there is an accepted prefix.
+	 */
+	template <size_t WordCount>
+	std::optional<IndexType> BitParallelNFA<WordCount>::_longest_prefix(const auto& input, const IndexType start, MaskType& finalMask) const
+	{
+		std::optional<IndexType> end{};
+		MaskType active = m_StartMask;
+
+		if (this->isFinal(active)) {
+			end = start;
+			finalMask = active & m_FinalMask;
+		}
+
+		// stop as soon as no state is active, since no state can be activated again
+		for (IndexType i = start; i < input.size() && active.any(); i++) {
+			active = this->step(active, input[i]);
+
+			if (this->isFinal(active)) {
+				end = i + 1;
+				finalMask = active & m_FinalMask;
+			}
+		}
+
+		return end;
+	}
+
+	/**
+	* @brief Simulate the given input string using the given simulation method.
+	* @details The results are the same as those of NonDeterFiniteAutomaton<TransFuncT, InputT>::simulate(const InputT& input, FSM_MODE mode) const, except that the final states reported are those reached at the end of the match.
+	* @param[in] input The input string to be simulated.
+	* @param[in] mode The simulation mode.
+	* @param[in] prefilter Used to skip the positions at which no match can begin when searching for substrings.
+	* @throw UnrecognizedSimModeException Thrown in case an incorrect simulation mode is entered.
+	* @return FSMResult object indicating the result of the simulation.
+	*/
+	template <size_t WordCount>
+	template <typename InputT>
+	FSMResult BitParallelNFA<WordCount>::simulate(const InputT& input, const FSM_MODE mode, const Prefilter& prefilter) const
+	{
+		MaskType finalMask{};
+
+		switch (mode) {
+		case FSM_MODE::MM_WHOLE_STRING: {
+			MaskType active = m_StartMask;
+
+			for (IndexType i = 0; i < input.size() && active.any(); i++)
+				active = this->step(active, input[i]);
+
+			const bool accepted = this->isFinal(active);
+
+			return FSMResult(accepted, this->toStateSet(active & m_FinalMask), { 0, accepted ? input.size() : 0 }, input);
+		}
+		case FSM_MODE::MM_LONGEST_PREFIX: {
+			const std::optional<IndexType> end = this->_longest_prefix(input, 0, finalMask);
+
+			return FSMResult(end.has_value(), this->toStateSet(finalMask), { 0, end.value_or(0) }, input);
+		}
+		case FSM_MODE::MM_LONGEST_SUBSTRING: {
+			std::optional<Indicies> longest{};
+
+			// choose the longest substring or the first of many having the same length; stop once no later substring can be longer
+			for (IndexType start = prefilter.next(input, 0); start < input.size(); start = prefilter.next(input, start + 1)) {
+				if (longest && input.size() - start <= longest->end - longest->start)
+					break;
+
+				MaskType currFinalMask{};
+				const std::optional<IndexType> end = this->_longest_prefix(input, start, currFinalMask);
+
+				if (end && (!longest || *end - start > longest->end - longest->start)) {
+					longest = Indicies{ start, *end };
+					finalMask = currFinalMask;
+				}
+			}
+
+			if (longest)
+				return FSMResult(true, this->toStateSet(finalMask), *longest, input);
+
+			return FSMResult(false, {}, { 0, 0 }, input);
+		}
+		case FSM_MODE::MM_COUNT: {
+			size_t count = 0;
+
+			// continue after each non-empty match
+			for (IndexType start = prefilter.next(input, 0); start < input.size();) {
+				const std::optional<IndexType> end = this->_longest_prefix(input, start, finalMask);
+
+				if (end && *end > start) {
+					count++;
+					start = prefilter.next(input, *end);
+				}
+				else
+					start = prefilter.next(input, start + 1);
+			}
+
+			return FSMResult(count > 0, {}, { 0, 0 }, input, count);
+		}
+		case FSM_MODE::MM_COUNT_ENDS: {
+			size_t count = 0;
+			MaskType active{};
+
+			// run unanchored: a match might begin at every position, so the start state is added before each step
+			for (IndexType i = 0; i < input.size(); i++) {
+				if (!active.any()) {
+					i = prefilter.next(input, i);
+
+					if (i == input.size())
+						break;
+				}
+
+				active = this->step(active | m_StartMask, input[i]);
+				count += this->isFinal(active);
+			}
+
+			return FSMResult(count > 0, {}, { 0, 0 }, input, count);
+		}
+		case FSM_MODE::MM_ANY_MATCH: {
+			// the empty string is a substring of every input
+			if (this->isFinal(m_StartMask))
+				return FSMResult(true, this->toStateSet(m_StartMask & m_FinalMask), { 0, 0 }, input);
+
+			MaskType active{};
+
+			// run unanchored, stopping at the end of the first match
+			for (IndexType i = 0; i < input.size(); i++) {
+				if (!active.any()) {
+					i = prefilter.next(input, i);
+
+					if (i == input.size())
+						break;
+				}
+
+				active = this->step(active | m_StartMask, input[i]);
+
+				if (this->isFinal(active))
+					return FSMResult(true, this->toStateSet(active & m_FinalMask), { 0, i + 1 }, input);
+			}
+
+			return FSMResult(false, {}, { 0, 0 }, input);
+		}
+		default:
+			throw UnrecognizedSimModeException();
+		}
+	}
+
+	/**
+	 * @brief Compiles an NFA into a bit-parallel engine of the narrowest width that fits the states reachable from its start state.
+	 * @param[in] tranFn The transition function of the NFA.
+	 * @param[in] fStates The set of final states of the NFA.
+	 * @param[in] epsilonClosure Whether the NFA is an epsilon NFA (whether transitions on `'\0'` are epsilon-transitions that must be folded in).
+	 * @return The compiled engine, or `std::monostate` if the NFA has more states than the widest engine can hold.
+	 */
+	template <typename TransFuncT>
+	BitParallelNFAVariant compileBitParallelNFA(const TransFuncT& tranFn, const FSMStateSetType& fStates, const bool epsilonClosure)
+	{
+		constexpr size_t alphabetSize = BitParallelNFA<4>::ALPHABET_SIZE;
+		constexpr size_t maxStateCount = BitParallelNFA<4>::MAX_STATE_COUNT;
+		constexpr FSMStateType startState = FiniteStateMachine<TransFuncT>::getStartState();
+
+		// the reachable states, in the order they are discovered, and their indicies within `states`
+		std::vector<FSMStateType> states{ startState };
+		std::map<FSMStateType, size_t> indexOf{ {startState, 0} };
+		// the (epsilon-closed) states that each state leads to on each symbol, indexed by `state * alphabetSize + symbol`
+		std::vector<std::vector<FSMStateType>> targets{};
+		std::vector<FSMStateType> stack{};
+
+		// discover the reachable states breadth-first
+		for (size_t i = 0; i < states.size(); i++) {
+			for (size_t symbol = 0; symbol < alphabetSize; symbol++) {
+				std::vector<FSMStateType>& set = targets.emplace_back();
+				tranFn.forEachTarget(states[i], static_cast<unsigned char>(symbol), [&set](const FSMStateType target) {
+					set.push_back(target);
+				});
+
+				// fold the epsilon closure of the targets in
+				if (epsilonClosure) {
+					stack.assign(set.begin(), set.end());
+
+					while (stack.size()) {
+						const FSMStateType s = stack.back();
+						stack.pop_back();
+
+						tranFn.forEachTarget(s, '\0', [&set, &stack](const FSMStateType state) {
+							if (std::find(set.begin(), set.end(), state) == set.end()) {
+								set.push_back(state);
+								stack.push_back(state);
+							}
+						});
+					}
+				}
+
+				for (const FSMStateType state : set)
+					if (indexOf.emplace(state, states.size()).second) {
+						// the machine is too large to be simulated bit-parallel
+						if (states.size() == maxStateCount)
+							return std::monostate{};
+
+						states.push_back(state);
+					}
+			}
+		}
+
+		const size_t stateCount = states.size();
+
+		// group the symbols on which every state behaves identically into classes
+		std::array<std::uint8_t, alphabetSize> symbolClasses{};
+		std::vector<StateMask<4>> successors{};
+		std::map<std::vector<StateMask<4>>, std::uint8_t> classOf{};
+
+		for (size_t symbol = 0; symbol < alphabetSize; symbol++) {
+			std::vector<StateMask<4>> column(stateCount);
+
+			for (size_t i = 0; i < stateCount; i++)
+				for (const FSMStateType state : targets[i * alphabetSize + symbol])
+					column[i].set(indexOf.at(state));
+
+			const auto [it, inserted] = classOf.emplace(column, static_cast<std::uint8_t>(classOf.size()));
+			if (inserted)
+				successors.insert(successors.end(), column.begin(), column.end());
+
+			symbolClasses[symbol] = it->second;
+		}
+
+		if (stateCount <= BitParallelNFA<1>::MAX_STATE_COUNT)
+			return BitParallelNFA<1>{ symbolClasses, successors, states, fStates };
+		if (stateCount <= BitParallelNFA<2>::MAX_STATE_COUNT)
+			return BitParallelNFA<2>{ symbolClasses, successors, states, fStates };
+
+		return BitParallelNFA<4>{ symbolClasses, successors, states, fStates };
+	}
+
+}
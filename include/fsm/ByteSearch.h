@@ -0,0 +1,178 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define M0ST4FA_FSM_HAS_SSE2 1
+#endif
+
+// DECLARATIONS
+namespace m0st4fa::fsm {
+
+	/**
+	 * @brief A set of bytes, used to search for the first of many possible bytes.
+	 */
+	class ByteSet {
+		std::array<bool, 256> m_Bytes{};
+		//! @brief The first three bytes inserted into the set, used by the small-set search kernels.
+		std::array<char, 3> m_Needles{};
+		size_t m_Size = 0;
+
+	public:
+		//! @brief Adds `byte` to the set.
+		void insert(const unsigned char byte) noexcept {
+			if (m_Bytes[byte])
+				return;
+
+			if (m_Size < m_Needles.size())
+				m_Needles[m_Size] = static_cast<char>(byte);
+
+			m_Bytes[byte] = true;
+			m_Size++;
+		}
+
+		//! @brief Checks whether `byte` is in the set.
+		bool contains(const unsigned char byte) const noexcept {
+			return m_Bytes[byte];
+		}
+
+		//! @brief Gets the number of bytes in the set.
+		size_t size() const noexcept {
+			return m_Size;
+		}
+
+		//! @brief Checks whether the set is empty.
+		bool empty() const noexcept {
+			return m_Size == 0;
+		}
+
+		//! @brief Gets the first (up to) three bytes inserted into the set.
+		const std::array<char, 3>& getNeedles() const noexcept {
+			return m_Needles;
+		}
+	};
+
+	inline const char* findByte(const char*, const char*, const char) noexcept;
+
+	template <size_t N>
+	const char* findAnyOf(const char*, const char*, const std::array<char, N>&) noexcept;
+
+	inline const char* findAnyOf(const char*, const char*, const ByteSet&) noexcept;
+
+	inline size_t countByte(const char*, const char*, const char) noexcept;
+
+}
+
+// IMPLEMENTATIONS
+namespace m0st4fa::fsm {
+
+	/**
+	 * @brief Finds the first occurrence of `byte` within `[first, last)`.
+	 * @return A pointer to the occurrence, or `last` if there is none.
+	 */
+	inline const char* findByte(const char* first, const char* last, const char byte) noexcept
+	{
+		if (first >= last)
+			return last;
+
+		const void* const res = std::memchr(first, byte, last - first);
+
+		return res ? static_cast<const char*>(res) : last;
+	}
+
+	/**
+	 * @brief Finds the first byte within `[first, last)` that equals any of `needles`.
+	 * @details This is the `memchr2`/`memchr3` kernel: for two or three needles, 16 bytes are compared against every needle at once using SSE2 (when available).
+	 * @param[in] first Pointer to the first byte to search.
+	 * @param[in] last Pointer to the byte after the last byte to search.
+	 * @param[in] needles The bytes to search for.
+	 * @return A pointer to the first byte equal to one of `needles`, or `last` if there is none.
+	 */
+	template <size_t N>
+	const char* findAnyOf(const char* first, const char* last, const std::array<char, N>& needles) noexcept
+	{
+		static_assert(N >= 1 && N <= 3, "findAnyOf: Only up to three needles are supported.");
+
+		if constexpr (N == 1)
+			return findByte(first, last, needles[0]);
+		else {
+#ifdef M0ST4FA_FSM_HAS_SSE2
+			__m128i vNeedles[N];
+			for (size_t i = 0; i < N; i++)
+				vNeedles[i] = _mm_set1_epi8(needles[i]);
+
+			for (; last - first >= 16; first += 16) {
+				const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first));
+
+				__m128i eq = _mm_cmpeq_epi8(chunk, vNeedles[0]);
+				for (size_t i = 1; i < N; i++)
+					eq = _mm_or_si128(eq, _mm_cmpeq_epi8(chunk, vNeedles[i]));
+
+				if (const int mask = _mm_movemask_epi8(eq))
+					return first + std::countr_zero(static_cast<unsigned>(mask));
+			}
+#endif
+
+			for (; first < last; first++)
+				for (const char needle : needles)
+					if (*first == needle)
+						return first;
+
+			return last;
+		}
+	}
+
+	/**
+	 * @brief Finds the first byte within `[first, last)` that is in `bytes`.
+	 * @details The search uses the one-, two- or three-needle kernels if `bytes` is small enough, and a table lookup per byte otherwise.
+	 * @return A pointer to the first byte that is in `bytes`, or `last` if there is none.
+	 */
+	inline const char* findAnyOf(const char* first, const char* last, const ByteSet& bytes) noexcept
+	{
+		const std::array<char, 3>& needles = bytes.getNeedles();
+
+		switch (bytes.size()) {
+		case 0:
+			return last;
+		case 1:
+			return findByte(first, last, needles[0]);
+		case 2:
+			return findAnyOf(first, last, std::array<char, 2>{ needles[0], needles[1] });
+		case 3:
+			return findAnyOf(first, last, needles);
+		default:
+			for (; first < last; first++)
+				if (bytes.contains(static_cast<unsigned char>(*first)))
+					return first;
+
+			return last;
+		}
+	}
+
+	/**
+	 * @brief Counts the occurrences of `byte` within `[first, last)` (e.g. the newlines of a buffer).
+	 * @details 16 bytes are compared against `byte` at once using SSE2 (when available), and the matches of each comparison are counted as the bits of its mask.
+	 */
+	inline size_t countByte(const char* first, const char* last, const char byte) noexcept
+	{
+		size_t count = 0;
+
+#ifdef M0ST4FA_FSM_HAS_SSE2
+		const __m128i vByte = _mm_set1_epi8(byte);
+
+		for (; last - first >= 16; first += 16) {
+			const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first));
+			count += std::popcount(static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, vByte))));
+		}
+#endif
+
+		for (; first < last; first++)
+			count += *first == byte;
+
+		return count;
+	}
+
+}
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <optional>
+#include <vector>
+
+#include "FiniteStateMachine.h"
+
+// DECLARATIONS
+namespace m0st4fa::fsm {
+
+	/**
+	 * @brief The state of a DFA run over an input, after consuming the input up to some offset.
+	 */
+	struct Checkpoint {
+		//! @brief The (absolute) offset of the input up to which the run has consumed it.
+		IndexType offset = 0;
+		//! @brief The state that the DFA is in.
+		FSMStateType state = 0;
+		//! @brief The end of the longest prefix of the input accepted so far, if any.
+		std::optional<IndexType> acceptEnd{};
+		//! @brief The final state reached at the end of that prefix.
+		FSMStateType finalState = 0;
+	};
+
+	/**
+	 * @brief Records the state of a DFA run every `K` bytes of its input, so that the run can be resumed from any offset without starting over.
+	 * @details An index is filled by DeterFiniteAutomaton<TransFuncT, InputT>::simulate(const InputT&, const FSM_MODE, CheckpointIndex&) const and used by DeterFiniteAutomaton<TransFuncT, InputT>::resume. Checkpoint `i` is the state of the run at offset `i * K`; since the offsets are implicit, each checkpoint takes only its state, the end of the longest accepted prefix so far and the final state at that end. No checkpoints are recorded once the DFA dies; the state of the run at its death is recorded instead, since it holds for every offset after it.
+	 */
+	class CheckpointIndex {
+
+		//! @brief The number of bytes between consecutive checkpoints.
+		IndexType m_Interval = 1;
+		//! @brief The state of each checkpoint.
+		std::vector<FSMStateType> m_States{};
+		//! @brief The end of the longest accepted prefix of each checkpoint, or NO_MATCH.
+		std::vector<IndexType> m_AcceptEnds{};
+		//! @brief The final state at the end of the longest accepted prefix of each checkpoint.
+		std::vector<FSMStateType> m_FinalStates{};
+		//! @brief The state of the run at the offset at which the DFA died, if it did.
+		std::optional<Checkpoint> m_Death{};
+
+	public:
+
+		//! @brief Stands for the end of the longest accepted prefix of a checkpoint at which no prefix has been accepted.
+		static constexpr IndexType NO_MATCH = static_cast<IndexType>(-1);
+
+		/**
+		 * @brief Initialize a new, empty index.
+		 * @param[in] interval The number of bytes between consecutive checkpoints.
+		 * @throw InvalidStateMachineArgumentsException Thrown if `interval` is 0.
+		 */
+		explicit CheckpointIndex(const IndexType interval) : m_Interval{ interval } {
+			if (!interval) {
+				const std::string message = "CheckpointIndex: The interval between checkpoints cannot be 0.";
+				Logger{}.log(LoggerInfo::LL_ERROR, message);
+				throw InvalidStateMachineArgumentsException{ message };
+			}
+		};
+
+		//! @brief Gets the number of bytes between consecutive checkpoints.
+		IndexType getInterval() const { return m_Interval; };
+
+		//! @brief Gets the number of checkpoints.
+		size_t size() const { return m_States.size(); };
+
+		//! @brief Gets the offset at which the next checkpoint is to be recorded.
+		IndexType getNextOffset() const { return this->size() * m_Interval; };
+
+		//! @brief Gets the memory taken by the checkpoints, in bytes.
+		size_t getSizeInBytes() const {
+			return this->size() * (2 * sizeof(FSMStateType) + sizeof(IndexType));
+		}
+
+		//! @brief Removes every checkpoint.
+		void clear() {
+			m_States.clear();
+			m_AcceptEnds.clear();
+			m_FinalStates.clear();
+			m_Death.reset();
+		}
+
+		/**
+		 * @brief Records `checkpoint` as the next checkpoint.
+		 * @note `checkpoint.offset` must be getNextOffset().
+		 */
+		void push(const Checkpoint& checkpoint) {
+			m_States.push_back(checkpoint.state);
+			m_AcceptEnds.push_back(checkpoint.acceptEnd.value_or(NO_MATCH));
+			m_FinalStates.push_back(checkpoint.finalState);
+		}
+
+		//! @brief Records `death` as the state of the run at the offset at which the DFA died.
+		void setDeath(const Checkpoint& death) { m_Death = death; };
+
+		//! @brief Gets the state of the run at the offset at which the DFA died, if it did.
+		const std::optional<Checkpoint>& getDeath() const { return m_Death; };
+
+		/**
+		 * @brief Gets the checkpoint at index `i`.
+		 */
+		Checkpoint at(const size_t i) const {
+			const IndexType acceptEnd = m_AcceptEnds.at(i);
+
+			return Checkpoint{ i * m_Interval, m_States[i], acceptEnd == NO_MATCH ? std::nullopt : std::optional<IndexType>{ acceptEnd }, m_FinalStates[i] };
+		}
+
+		/**
+		 * @brief Gets the last checkpoint at or before `offset`.
+		 * @return The checkpoint, or nothing if the index is empty.
+		 */
+		std::optional<Checkpoint> nearest(const IndexType offset) const {
+			if (m_States.empty())
+				return std::nullopt;
+
+			return this->at(std::min<size_t>(offset / m_Interval, this->size() - 1));
+		}
+
+	};
+
+}
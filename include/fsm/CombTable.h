@@ -0,0 +1,281 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+
+#include "DFATable.h"
+
+// DECLARATIONS
+namespace m0st4fa::fsm {
+
+	/**
+	 * @brief The sizes of a CombTable and of the dense table that it was compressed from.
+	 * @see CombTable::getCompressionReport
+	 */
+	struct CompressionReport {
+		//! @brief The number of states of the table.
+		size_t stateCount = 0;
+		//! @brief The number of byte classes of the table.
+		size_t classCount = 0;
+		//! @brief The number of (state, class) cells of the dense table.
+		size_t denseCellCount = 0;
+		//! @brief The number of cells stored by the compressed table (the ones not inherited from a default state).
+		size_t storedCellCount = 0;
+		//! @brief The number of slots of the `next` and `check` arrays, stored cells and holes between them included.
+		size_t slotCount = 0;
+		//! @brief The size of the dense table, in bytes.
+		size_t denseSizeInBytes = 0;
+		//! @brief The size of the compressed table, in bytes.
+		size_t compressedSizeInBytes = 0;
+
+		//! @brief Gets the size of the compressed table relative to that of the dense table (less than 1 if it is smaller).
+		double getRatio() const {
+			return denseSizeInBytes ? double(compressedSizeInBytes) / double(denseSizeInBytes) : 1.0;
+		}
+	};
+
+	/**
+	 * @brief A transition table for DFAs over bytes, compressed by row displacement (a "comb vector") with default-state chaining.
+	 * @details Bytes are first grouped into classes, as by DFATable. Each state may then name a default state whose row it mostly shares, and stores only the cells in which it differs from it. The stored cells of all states are packed into a single pair of `next` and `check` arrays, each state's cells being displaced by its `base` so that they fall into slots left free by the others. The cell of `state` on class `c` is at slot `base[state] + c` if `check` there is `state`; otherwise the lookup moves on to the default state, and ends at the dead state once there is none. This is the layout of the `yy_base`, `yy_def`, `yy_nxt` and `yy_chk` tables of flex.
+	 * It can be used in place of FSMTable by TransitionFunction (e.g. `DeterFiniteAutomaton<TransFn<CombTable>>`), trading a few extra comparisons per transition for a table that fits in cache for machines with thousands of states.
+	 * @note Only inputs of byte-sized symbols are supported; the dead state must not be left (its row must be all dead states).
+	 */
+	class CombTable {
+	public:
+		//! @brief The number of input symbols (bytes) that the table recognizes.
+		static constexpr size_t ALPHABET_SIZE = DFATable::ALPHABET_SIZE;
+
+		//! @brief Stands for the absence of a default state, and marks the free slots of the `check` array.
+		static constexpr FSMStateType NO_STATE = static_cast<FSMStateType>(-1);
+
+		//! @brief The maximum number of earlier states considered as the default state of a state.
+		static constexpr size_t MAX_DEFAULT_CANDIDATES = 64;
+
+		//! @brief The maximum length of a chain of default states, which bounds the cost of a transition.
+		static constexpr size_t MAX_CHAIN_LENGTH = 4;
+
+	private:
+		//! @brief The class of each byte.
+		DFATable::ClassMapType m_Classes{};
+		//! @brief The number of byte classes.
+		size_t m_ClassCount = 1;
+		//! @brief The slot of the cell of each state on class 0.
+		std::vector<std::uint32_t> m_Base{};
+		//! @brief The default state of each state, or NO_STATE.
+		std::vector<FSMStateType> m_Default{};
+		//! @brief The next state held by each slot.
+		std::vector<FSMStateType> m_Next{};
+		//! @brief The state that owns each slot, or NO_STATE if the slot is free.
+		std::vector<FSMStateType> m_Check{};
+		//! @brief The sizes of the table and of the dense table it was compressed from.
+		CompressionReport m_Report{};
+
+		/**
+		 * @brief Gets the slot holding the cell of `state` on class `c`, or nothing if neither it nor its default states store that cell.
+		 */
+		const FSMStateType* _find(FSMStateType state, const size_t c) const noexcept {
+			for (; state != NO_STATE; state = m_Default[state]) {
+				const size_t slot = m_Base[state] + c;
+
+				if (m_Check[slot] == state)
+					return &m_Next[slot];
+			}
+
+			return nullptr;
+		}
+
+	public:
+
+		//! @brief Default constructor. The constructed table maps every state to the dead state.
+		CombTable() = default;
+
+		explicit CombTable(const DFATable&);
+
+		//! @brief Compiles an FSMTable of a DFA into a compressed table. @see DFATable::DFATable(const FSMTable&)
+		explicit CombTable(const FSMTable& table) : CombTable{ DFATable{ table } } {};
+
+		/**
+		 * @brief Gets the state that `state` is mapped to on `input`.
+		 * @return The next state, or the dead state if there is no such entry.
+		 */
+		template<typename InputT = char>
+		FSMStateType nextState(const FSMStateType state, const InputT input) const noexcept(true) {
+			const size_t symbol = toSymbolIndex(input);
+
+			if (state >= this->size() || symbol >= ALPHABET_SIZE)
+				return FSMStateType{};
+
+			const FSMStateType* const cell = this->_find(state, m_Classes[symbol]);
+
+			return cell ? *cell : FSMStateType{};
+		}
+
+		/**
+		 * @brief Gets the states that `state` is mapped to on `input`, as a view.
+		 * @return A view of the next state, or an empty view if `state` is mapped to the dead state.
+		 * @see FSMTable::targets(const FSMStateType state, const InputT input) const
+		 */
+		template<typename InputT = char>
+		std::span<const FSMStateType> targets(const FSMStateType state, const InputT input) const noexcept(true) {
+			const size_t symbol = toSymbolIndex(input);
+
+			if (state >= this->size() || symbol >= ALPHABET_SIZE)
+				return {};
+
+			const FSMStateType* const cell = this->_find(state, m_Classes[symbol]);
+
+			return { cell, cell && *cell != FSMStateType{} ? size_t{ 1 } : size_t{ 0 } };
+		}
+
+		/**
+		 * @brief Accesses the table entry indexed by `state` and `input`.
+		 * @return A copy of the table entry indexed by `state` and `input` (empty if `state` is mapped to the dead state).
+		 */
+		template<typename InputT = char>
+		FSMStateSetType operator()(const FSMStateType state, const InputT input) const noexcept(true) {
+			const std::span<const FSMStateType> res = this->targets(state, input);
+
+			return res.empty() ? FSMStateSetType{} : FSMStateSetType{ res.front() };
+		}
+
+		//! @brief Does nothing; the table is always laid out for simulation. @see FSMTable::freeze() const
+		void freeze() const {};
+
+		//! @brief Gets the number of rows (states) of the table.
+		size_t size() const {
+			return m_Base.size();
+		}
+
+		//! @brief Gets the number of byte classes.
+		size_t getClassCount() const {
+			return m_ClassCount;
+		}
+
+		//! @brief Gets the default state of `state`, or NO_STATE if it has none.
+		FSMStateType getDefault(const FSMStateType state) const {
+			return m_Default.at(state);
+		}
+
+		//! @brief Gets the size of the table, in bytes.
+		size_t getSizeInBytes() const {
+			return sizeof(m_Classes) + m_Base.size() * sizeof(std::uint32_t) + (m_Default.size() + m_Next.size() + m_Check.size()) * sizeof(FSMStateType);
+		}
+
+		//! @brief Gets the sizes of the table and of the dense table it was compressed from.
+		const CompressionReport& getCompressionReport() const {
+			return m_Report;
+		}
+
+	};
+
+}
+
+// IMPLEMENTATIONS
+namespace m0st4fa::fsm {
+
+	/**
+	 * @brief Compresses a dense table.
+	 * @details Each state takes as its default state the one, among the MAX_DEFAULT_CANDIDATES states before it, whose (resolved) row shares the most cells with its own, as long as that saves more cells than it costs and the chain of defaults stays within MAX_CHAIN_LENGTH. States without a default store only their live cells, the rest falling back to the dead state. The states are then packed, those with the most stored cells first, each at the lowest base at which all its cells fall into free slots.
+	 * @param[in] table The dense table to compress.
+	 */
+	inline CombTable::CombTable(const DFATable& table) :
+		m_Classes{ table.getClassMap() }, m_ClassCount{ table.getClassCount() }
+	{
+		const size_t stateCount = table.size();
+		const size_t classCount = m_ClassCount;
+		const std::vector<FSMStateType>& dense = table.getTransitions();
+
+		m_Base.assign(stateCount, 0);
+		m_Default.assign(stateCount, NO_STATE);
+
+		// the classes on which each state stores a cell
+		std::vector<std::vector<std::uint32_t>> stored(stateCount);
+		std::vector<size_t> chainLength(stateCount, 1);
+
+		for (size_t state = 0; state < stateCount; state++) {
+			const FSMStateType* const row = dense.data() + state * classCount;
+
+			// without a default state, only the live cells are stored
+			size_t bestCost = std::count_if(row, row + classCount, [](const FSMStateType s) { return s != FSMStateType{}; });
+			FSMStateType bestDefault = NO_STATE;
+
+			for (size_t candidate = state > MAX_DEFAULT_CANDIDATES ? state - MAX_DEFAULT_CANDIDATES : 0; candidate < state; candidate++) {
+				if (chainLength[candidate] >= MAX_CHAIN_LENGTH)
+					continue;
+
+				const FSMStateType* const candidateRow = dense.data() + candidate * classCount;
+				const size_t cost = classCount - std::inner_product(row, row + classCount, candidateRow, size_t{ 0 }, std::plus<>{}, std::equal_to<>{});
+
+				if (cost < bestCost) {
+					bestCost = cost;
+					bestDefault = static_cast<FSMStateType>(candidate);
+				}
+			}
+
+			m_Default[state] = bestDefault;
+
+			if (bestDefault != NO_STATE)
+				chainLength[state] = chainLength[bestDefault] + 1;
+
+			const FSMStateType* const defaultRow = bestDefault == NO_STATE ? nullptr : dense.data() + bestDefault * classCount;
+
+			for (size_t c = 0; c < classCount; c++)
+				if (defaultRow ? row[c] != defaultRow[c] : row[c] != FSMStateType{})
+					stored[state].push_back(static_cast<std::uint32_t>(c));
+		}
+
+		// pack the states with the most cells first, while there is still room between the slots
+		std::vector<FSMStateType> order(stateCount);
+		std::iota(order.begin(), order.end(), FSMStateType{ 0 });
+		std::stable_sort(order.begin(), order.end(), [&stored](const FSMStateType lhs, const FSMStateType rhs) {
+			return stored[lhs].size() > stored[rhs].size();
+			});
+
+		size_t firstFree = 0;
+
+		for (const FSMStateType state : order) {
+			const std::vector<std::uint32_t>& cells = stored[state];
+
+			if (cells.empty())
+				continue;
+
+			// find the lowest base at which all the cells of the state fall into free slots
+			size_t base = firstFree > cells.front() ? firstFree - cells.front() : 0;
+
+			for (;; base++) {
+				if (m_Check.size() < base + classCount) {
+					m_Next.resize(base + classCount, FSMStateType{});
+					m_Check.resize(base + classCount, NO_STATE);
+				}
+
+				if (std::all_of(cells.begin(), cells.end(), [this, base](const std::uint32_t c) { return m_Check[base + c] == NO_STATE; }))
+					break;
+			}
+
+			m_Base[state] = static_cast<std::uint32_t>(base);
+
+			for (const std::uint32_t c : cells) {
+				m_Next[base + c] = dense[state * classCount + c];
+				m_Check[base + c] = state;
+			}
+
+			while (firstFree < m_Check.size() && m_Check[firstFree] != NO_STATE)
+				firstFree++;
+		}
+
+		// every base must leave room for a full row, so that lookups on any class stay within the arrays
+		const size_t slotCount = stateCount ? *std::max_element(m_Base.begin(), m_Base.end()) + classCount : 0;
+		m_Next.resize(std::max(m_Next.size(), slotCount), FSMStateType{});
+		m_Check.resize(std::max(m_Check.size(), slotCount), NO_STATE);
+
+		m_Report.stateCount = stateCount;
+		m_Report.classCount = classCount;
+		m_Report.denseCellCount = dense.size();
+		m_Report.storedCellCount = std::accumulate(stored.begin(), stored.end(), size_t{ 0 }, [](const size_t sum, const auto& cells) { return sum + cells.size(); });
+		m_Report.slotCount = m_Next.size();
+		m_Report.denseSizeInBytes = table.getSizeInBytes();
+		m_Report.compressedSizeInBytes = this->getSizeInBytes();
+	}
+
+}
@@ -1,8 +1,15 @@
 #pragma once
 
+#include "CheckpointIndex.h"
 #include "FiniteStateMachine.h"
-#include <ranges>
-#include <assert.h>
+#include "Prefilter.h"
+#include "StateAccelerator.h"
+#include "StrideTable.h"
+#include "UnanchoredTable.h"
+#include <algorithm>
+#include <memory>
+#include <optional>
+#include <vector>
 
 
 // DECLARATIONS
@@ -14,15 +21,34 @@ namespace m0st4fa::fsm {
 	template <typename TransFuncT, typename InputT = std::string_view>
 	class DeterFiniteAutomaton : public FiniteStateMachine<TransFuncT, InputT> {
 		using Base = FiniteStateMachine<TransFuncT, InputT>;
-		using SubstringType = Substring<FSMStateType>;
 
 		// private methods
 		FSMResult _simulate_whole_string(const InputT&) const;
 		FSMResult _simulate_longest_prefix(const InputT&) const;
 		FSMResult _simulate_longest_substring(const InputT&) const;
-
-		bool _check_accepted_longest_prefix(const std::vector<FSMStateType>&, size_t&) const;
-		bool _check_accepted_substring(const InputT&, std::vector<FSMStateType>&, const size_t, size_t&) const;
+		FSMResult _simulate_count(const InputT&) const;
+		FSMResult _simulate_count_ends(const InputT&) const;
+		FSMResult _simulate_any_match(const InputT&) const;
+
+		template <typename CallbackT>
+		void _run_unanchored(const InputT&, CallbackT) const;
+
+		std::optional<IndexType> _longest_prefix(const InputT&, const IndexType, FSMStateType&) const;
+		FSMStateType _run_strided(const InputT&) const;
+		std::optional<IndexType> _longest_prefix_strided(const InputT&, const IndexType, FSMStateType&) const;
+
+		void _run_checkpointed(const InputT&, const IndexType, Checkpoint&, CheckpointIndex*) const;
+		FSMResult _checkpointed_result(const InputT&, const Checkpoint&, const FSM_MODE) const;
+		void _check_checkpointed_mode(const FSM_MODE) const;
+
+		//! @brief Used to skip the positions at which no match can begin when searching for substrings.
+		Prefilter m_Prefilter{};
+		//! @brief Used to skip over runs of input on which a state loops to itself. It is never modified once built, so copies of the machine share it.
+		std::shared_ptr<const StateAccelerator> m_Accelerator = std::make_shared<const StateAccelerator>();
+		//! @brief Used to consume two bytes per transition, if the machine was given FSM_FLAG::FF_STRIDE_2 and is small enough. It is never modified once built, so copies of the machine share it.
+		std::shared_ptr<const StrideTable> m_Stride = std::make_shared<const StrideTable>();
+		//! @brief Used to run the machine unanchored with a single state per byte, if it is small enough. It is never modified once built, so copies of the machine share it.
+		std::shared_ptr<const UnanchoredTable> m_Unanchored = std::make_shared<const UnanchoredTable>();
 
 	public:
 		
@@ -36,19 +62,80 @@ namespace m0st4fa::fsm {
 		 * @param[in] tranFn The transition function of the new DFA object.
 		 * @param[in] flags The flags given to the new DFA object.
 		 */
-		DeterFiniteAutomaton(const FSMStateSetType& fStates, const TransFuncT& tranFn, FlagsType flags = FSM_FLAG::FF_FLAG_NONE) :
-			FiniteStateMachine<TransFuncT, InputT>{ fStates, tranFn, FSM_TYPE::MT_DFA, flags }
+		DeterFiniteAutomaton(const FSMStateSetType& fStates, TransFuncT tranFn, FlagsType flags = FSM_FLAG::FF_FLAG_NONE) :
+			FiniteStateMachine<TransFuncT, InputT>{ fStates, std::move(tranFn), FSM_TYPE::MT_DFA, flags },
+			m_Prefilter{ this->m_TransitionFunc, fStates, false },
+			m_Accelerator{ std::make_shared<const StateAccelerator>(this->m_TransitionFunc) }
+		{
+			if constexpr (sizeof(std::ranges::range_value_t<InputT>) == 1) {
+				if (flags & FSM_FLAG::FF_STRIDE_2)
+					m_Stride = std::make_shared<const StrideTable>(this->m_TransitionFunc, fStates);
+
+				m_Unanchored = std::make_shared<const UnanchoredTable>(this->m_TransitionFunc, fStates);
+			}
+		};
+		/**
+		 * @brief Copy constructor for DFA objects. The accelerator and the stride table are shared with `rhs`.
+		 */
+		DeterFiniteAutomaton(const DeterFiniteAutomaton&) = default;
+		/**
+		 * @brief Move constructor for DFA objects.
+		 * @details The accelerator and the stride table are shared with `rhs` rather than taken from it, so that `rhs` remains usable.
+		 */
+		DeterFiniteAutomaton(DeterFiniteAutomaton&& rhs) noexcept(std::is_nothrow_move_constructible_v<Base>) :
+			Base{ std::move(rhs) },
+			m_Prefilter{ std::move(rhs.m_Prefilter) },
+			m_Accelerator{ rhs.m_Accelerator },
+			m_Stride{ rhs.m_Stride },
+			m_Unanchored{ rhs.m_Unanchored }
 		{};
 		/**
 		 * @brief Copy assignment operator for DFA objects.
 		 */
 		DeterFiniteAutomaton& operator=(const DeterFiniteAutomaton& rhs) {
 			this->Base::operator=(rhs);
+			this->m_Prefilter = rhs.m_Prefilter;
+			this->m_Accelerator = rhs.m_Accelerator;
+			this->m_Stride = rhs.m_Stride;
+			this->m_Unanchored = rhs.m_Unanchored;
+			return *this;
+		}
+		/**
+		 * @brief Move assignment operator for DFA objects.
+		 * @details The accelerator and the stride table are shared with `rhs` rather than taken from it, so that `rhs` remains usable.
+		 */
+		DeterFiniteAutomaton& operator=(DeterFiniteAutomaton&& rhs) noexcept(std::is_nothrow_move_assignable_v<Base>) {
+			this->Base::operator=(std::move(rhs));
+			this->m_Prefilter = std::move(rhs.m_Prefilter);
+			this->m_Accelerator = rhs.m_Accelerator;
+			this->m_Stride = rhs.m_Stride;
+			this->m_Unanchored = rhs.m_Unanchored;
 			return *this;
 		}
 
 		FSMResult simulate(const InputT&, const FSM_MODE) const;
+		FSMResult simulate(const InputT&, const FSM_MODE, CheckpointIndex&) const;
+		FSMResult resume(const InputT&, const FSM_MODE, const CheckpointIndex&, const IndexType = 0) const;
+
+		//! @brief Gets the accelerator used to skip over runs of input on which a state loops to itself.
+		const StateAccelerator& getAccelerator() const { return *m_Accelerator; };
 
+		/**
+		 * @brief Checks whether the machine consumes two bytes per transition.
+		 * @details This is the case for machines over bytes given FSM_FLAG::FF_STRIDE_2 whose StrideTable is at most StrideTable::DEFAULT_MAX_SIZE bytes.
+		 */
+		bool isStrided() const {
+			return not m_Stride->empty();
+		}
+
+		//! @brief Gets the table used to consume two bytes per transition, which is empty unless the machine is strided.
+		const StrideTable& getStrideTable() const { return *m_Stride; };
+
+		/**
+		 * @brief Gets the table used to run the machine unanchored (in the FSM_MODE::MM_COUNT_ENDS and FSM_MODE::MM_ANY_MATCH modes).
+		 * @details It is empty for machines over input that is not byte-sized, and for machines with more than UnanchoredTable::DEFAULT_MAX_STATES states or sets of states, which keep the set of states they are in while running.
+		 */
+		const UnanchoredTable& getUnanchoredTable() const { return *m_Unanchored; };
 		
 	};
 
@@ -75,15 +162,26 @@ namespace m0st4fa::fsm {
 		FSMStateType currState = startState;
 
 		/**
-		 * Follow a path through the machine using the characters of the string.
+		 * Follow a path through the machine using the characters of the string, two at a time if the machine is strided.
 		 * Break if you hit a dead state since it is dead.
+		 * Whenever the machine loops to the same state, skip the run of characters it keeps looping on, if the state is accelerated.
 		*/
-		for (auto c : input) {
-			currState = (FSMStateType)this->m_TransitionFunc(currState, c);
+		if (this->isStrided())
+			currState = this->_run_strided(input);
+		else
+			for (IndexType charIndex = 0; charIndex < input.size();) {
+				const FSMStateType nextState = this->m_TransitionFunc.nextState(currState, input[charIndex++]);
+
+				if (nextState == Base::DEAD_STATE) {
+					currState = nextState;
+					break;
+				}
 
-			if (currState == Base::DEAD_STATE)
-				break;
-		}
+				if (nextState == currState)
+					charIndex = m_Accelerator->skip(input, charIndex, currState);
+
+				currState = nextState;
+			}
 
 		bool accepted = this->_is_state_final(currState);
 
@@ -98,202 +196,336 @@ namespace m0st4fa::fsm {
 	template<typename TransFuncT, typename InputT>
 	FSMResult DeterFiniteAutomaton<TransFuncT, InputT>::_simulate_longest_prefix(const InputT& input) const
 	{
-		FSMStateType startState = FiniteStateMachine<TransFuncT, InputT>::START_STATE;
-		FSMStateType currState = startState;
-		/**
-		* keeps track of the path taken through the machine.
-		* Will be used to figure out the longest matched prefix, if any.
-		*/ 
-		std::vector matchedStates = { currState };
-		// character index of the last matching character, or 0
-		size_t charIndex = 0;
+		FSMStateType finalState = Base::DEAD_STATE;
+		const std::optional<IndexType> end = _longest_prefix(input, 0, finalState);
+
+		if (end)
+			return FSMResult(true, finalState, { 0, *end }, input);
+
+		return FSMResult(false, {}, { 0, 0 }, input);
+	}
+
+	/**
+	 * @brief Simulates the DFA against `input` looking for the longest substring, which might be the entire string.
+	 * @details If many substrings have the same length, the first of them is chosen.
+	 * @param[in] input The input string against which the simulation will run.
+	 * @return FSMResult object that indicates the result of the simulation.
+	 */
+	template<typename TransFuncT, typename InputT>
+	FSMResult DeterFiniteAutomaton<TransFuncT, InputT>::_simulate_longest_substring(const InputT& input) const
+	{
+		constexpr FSMStateType startState = FiniteStateMachine<TransFuncT, InputT>::START_STATE;
+
+		std::optional<Indicies> longest{};
+		FSMStateType finalState = startState;
 
 		/**
-		 * Follow a path through the machine using the characters of the string.
-		 * Keep track of that path in order to be able to find the longest prefix if the whole string is not accepted.
-		 * Break if you hit a dead state since it is dead.
+		 * Find the longest prefix starting at each position at which a match can begin.
+		 * Stop once the rest of the input is not longer than the longest substring found so far.
 		*/
-		for (; charIndex < input.size(); charIndex++) {
-			const char c = input[charIndex];
+		for (IndexType startIndex = m_Prefilter.next(input, 0); startIndex < input.size(); startIndex = m_Prefilter.next(input, startIndex + 1)) {
 
-			// get next state
-			currState = (FSMStateType)this->m_TransitionFunc(currState, c);
+			if (longest && input.size() - startIndex <= longest->end - longest->start)
+				break;
 
-			// break out if it is dead
-			if (currState == Base::DEAD_STATE) {
-				if (charIndex != 0)
-					charIndex--;
+			FSMStateType currFinalState = startState;
+			const std::optional<IndexType> end = _longest_prefix(input, startIndex, currFinalState);
 
-				break;
+			// if the substring was accepted and is longer than the previously caught
+			if (end && (!longest || *end - startIndex > longest->end - longest->start)) {
+				longest = Indicies{ startIndex, *end };
+				finalState = currFinalState;
 			}
-
-			// update our path through the machine
-			matchedStates.push_back(currState);
 		}
 
-		if (charIndex == input.size())
-			charIndex--;
+		if (longest)
+			return FSMResult(true, finalState, *longest, input);
+
+		// if there was no accepted substring
+		return FSMResult(false, { startState }, { 0, 0 }, input);
+	};
+	
+	/**
+	 * @brief Simulates the DFA against `input` counting the non-empty, non-overlapping leftmost-longest matches.
+	 * @details Each match is the longest prefix accepted from the first position, after the end of the previous match, at which a non-empty prefix is accepted. Nothing is allocated per match.
+	 * @param[in] input The input string against which the simulation will run.
+	 * @return FSMResult object whose `count` is the number of matches; it is accepted if there is at least one.
+	 */
+	template<typename TransFuncT, typename InputT>
+	FSMResult DeterFiniteAutomaton<TransFuncT, InputT>::_simulate_count(const InputT& input) const
+	{
+		size_t count = 0;
+		FSMStateType finalState = Base::DEAD_STATE;
+
+		for (IndexType startIndex = m_Prefilter.next(input, 0); startIndex < input.size();) {
+			const std::optional<IndexType> end = _longest_prefix(input, startIndex, finalState);
 
-		// figure out whether there is an accepted longest prefix
-		bool accepted = _check_accepted_longest_prefix(matchedStates, charIndex);
+			// continue after the match, if there is one
+			if (end && *end > startIndex) {
+				count++;
+				startIndex = m_Prefilter.next(input, *end);
+			}
+			else
+				startIndex = m_Prefilter.next(input, startIndex + 1);
+		}
 
-		const IndexType	start = 0;
-		const IndexType end = accepted ? charIndex + 1 : 0;
+		return FSMResult(count > 0, {}, { 0, 0 }, input, count);
+	}
 
-		// Note: it is guaranteed that there will be one final state; it is just that this data structure is used for both NFA and DFA
-		const FSMStateSetType finalStates = this->_get_final_states_from_state_set(matchedStates.back());
+	/**
+	 * @brief Simulates the DFA against `input` counting the positions at which at least one non-empty match ends.
+	 * @param[in] input The input string against which the simulation will run.
+	 * @return FSMResult object whose `count` is the number of positions; it is accepted if there is at least one.
+	 */
+	template<typename TransFuncT, typename InputT>
+	FSMResult DeterFiniteAutomaton<TransFuncT, InputT>::_simulate_count_ends(const InputT& input) const
+	{
+		size_t count = 0;
+
+		this->_run_unanchored(input, [&count](const IndexType, const FSMStateType) {
+			count++;
+			return false;
+			});
 
-		return FSMResult(accepted, finalStates, { start, end }, input);
+		return FSMResult(count > 0, {}, { 0, 0 }, input, count);
 	}
 
 	/**
-	 * @brief Simulates the DFA against `input` looking for the longest substring, which might be the entire string.
+	 * @brief Simulates the DFA against `input` checking whether any substring of it is accepted, stopping at the end of the first match found.
 	 * @param[in] input The input string against which the simulation will run.
-	 * @return FSMResult object that indicates the result of the simulation.
+	 * @return FSMResult object that is accepted if there is a match; its indicies span the input up to the end of the first match to end, and its final state is the one reached there.
 	 */
 	template<typename TransFuncT, typename InputT>
-	FSMResult DeterFiniteAutomaton<TransFuncT, InputT>::_simulate_longest_substring(const InputT& input) const
+	FSMResult DeterFiniteAutomaton<TransFuncT, InputT>::_simulate_any_match(const InputT& input) const
 	{
-		constexpr FSMStateType startState = FiniteStateMachine<TransFuncT, InputT>::START_STATE;
-		/**
-		* keeps track of the path taken through the machine.
-		* Will be used to figure out the longest matched prefix, if any.
-		*/
-		std::vector matchedStates = { {startState } };
-		size_t startIndex = 0;
-		size_t charIndex = 0;
+		constexpr FSMStateType startState = Base::START_STATE;
 
-		std::vector<SubstringType> matchedStatesSets{};
+		// the empty string is a substring of every input
+		if (this->_is_state_final(startState))
+			return FSMResult(true, { startState }, { 0, 0 }, input);
 
-		/**
-		 * Follow a path through the machine using the characters of the string until you check all the characters.
-		 * Keep track of that path in order to be able to find the longest prefix if the whole string is not accepted.
-		 * If a substring was not accepted, start matching the next substring if any
-		*/
-		for (; charIndex < input.size(); charIndex = ++startIndex) {
+		std::optional<FSMResult> res{};
 
-			// check whether the substring is accepted (and populate everything given by reference)
-			bool accepted = _check_accepted_substring(input, matchedStates, startIndex, charIndex);
+		this->_run_unanchored(input, [&res, &input](const IndexType end, const FSMStateType finalState) {
+			res = FSMResult(true, { finalState }, { 0, end }, input);
+			return true;
+			});
 
-			// if the substring was accepted
-			if (accepted) {
-				matchedStatesSets.push_back(SubstringType{ matchedStates, startIndex, charIndex + 1 });
+		return res ? *res : FSMResult(false, {}, { 0, 0 }, input);
+	}
 
-				// if the rest of the input is less than the current substring in length, leave
-				if ((input.size() - startIndex) < matchedStates.size())
-					break;
+	/**
+	 * @brief Runs the DFA unanchored over `input`, in a single pass, reporting each position at which at least one non-empty match ends.
+	 * @details The set of states the DFA is in, one for each position at which a match might have begun, gets the start state added before each character. States that die are dropped, and positions at which the set is empty are skipped by the prefilter.
+	 * If the machine has an UnanchoredTable, each set is a single state of the table, so a character costs a single lookup. Otherwise, the set is kept as is, and a state reached by many matches is kept once (matches that reach the same state behave the same from there on).
+	 * @param[in] input The input string against which the simulation will run.
+	 * @param[in] onMatchEnd Called with the index after the last character of the matches and the smallest of the final states they reach; returns whether to stop.
+	 */
+	template<typename TransFuncT, typename InputT>
+	template<typename CallbackT>
+	void DeterFiniteAutomaton<TransFuncT, InputT>::_run_unanchored(const InputT& input, CallbackT onMatchEnd) const
+	{
+		if (!m_Unanchored->empty()) {
+			const UnanchoredTable& table = *m_Unanchored;
+			std::uint32_t current = UnanchoredTable::EMPTY_STATE;
+
+			for (IndexType charIndex = 0; charIndex < input.size(); charIndex++) {
+				if (current == UnanchoredTable::EMPTY_STATE) {
+					charIndex = m_Prefilter.next(input, charIndex);
+
+					if (charIndex == input.size())
+						break;
+				}
+
+				const std::uint32_t entry = table.step(current, input[charIndex]);
+				current = entry & UnanchoredTable::STATE_MASK;
+
+				if ((entry & UnanchoredTable::FINAL) && onMatchEnd(charIndex + 1, table.getFinalState(current)))
+					return;
 			}
 
-			matchedStates.resize(1);
+			return;
 		}
 
-		if (matchedStatesSets.size()) {
+		std::vector<FSMStateType> current{}, next{};
+		// the index after the character at which each state was last reached, to keep it once in `next`
+		std::vector<IndexType> marks{};
 
-			const SubstringType* longest = nullptr;
-			size_t size = 0;
+		for (IndexType charIndex = 0; charIndex < input.size(); charIndex++) {
+			if (current.empty()) {
+				charIndex = m_Prefilter.next(input, charIndex);
 
-			// choose the longest substring or the first of many having the same length
-			std::ranges::reverse_view rv{ matchedStatesSets };
-			for (const auto& data : rv) {
-				// if the length of this substring is longer than that of the previously catched
-				if (data.size() > size) {
-					longest = &data;
-					size = longest->size();
-				}
+				if (charIndex == input.size())
+					break;
 			}
 
-			const size_t startIndex = longest->indicies.start;
-			const size_t endIndex = longest->indicies.end;
+			// a match might begin here
+			current.push_back(Base::START_STATE);
+
+			FSMStateType finalState = Base::DEAD_STATE;
+			next.clear();
+
+			for (const FSMStateType state : current) {
+				const FSMStateType nextState = this->m_TransitionFunc.nextState(state, input[charIndex]);
 
-			// get the final states we've reached
-			const FSMStateType finalState = matchedStates.back();
+				if (nextState == Base::DEAD_STATE)
+					continue;
 
-			return FSMResult(true, finalState, { startIndex, endIndex }, input);
+				if (marks.size() <= nextState)
+					marks.resize(nextState + 1);
+
+				if (marks[nextState] == charIndex + 1)
+					continue;
+
+				marks[nextState] = charIndex + 1;
+				next.push_back(nextState);
+
+				if (this->_is_state_final(nextState) && (finalState == Base::DEAD_STATE || nextState < finalState))
+					finalState = nextState;
+			}
+
+			current.swap(next);
+
+			if (finalState != Base::DEAD_STATE && onMatchEnd(charIndex + 1, finalState))
+				return;
 		}
+	}
 
-		// if there was no accepted substring
-		return FSMResult(false, { startState }, { 0, 0 }, input);
-	};
-	
 	/**
-	* @brief Simulates the DFA against `input` looking for the longest prefix. It also updates `charIndex` to the index of the last character of that prefix.
-	* @param[in] matchedStates The set of states that form the path taken through the machine after simulating the machine against `input`.
-	* @param[out] charIndex The index of the last character of the matched prefix, if found; otherwise, 0.
-	* @return `true` if a prefix matches, `false` otherwise.
+	* @brief Finds the longest prefix of the substring of `input` starting from `startIndex` that the DFA accepts.
+	* @param[in] input The input string against which the simulation will run.
+	* @param[in] startIndex The index, within `input`, at which the prefix starts.
+	* @param[out] finalState The final state reached at the end of the prefix, if any.
+	* @return The index of the character after the last character of the prefix, if there is an accepted prefix.
 	**/
 	template<typename TransFuncT, typename InputT>
-	inline bool DeterFiniteAutomaton<TransFuncT, InputT>::_check_accepted_longest_prefix(const std::vector<FSMStateType>& matchedStates, size_t& charIndex) const
+	std::optional<IndexType> DeterFiniteAutomaton<TransFuncT, InputT>::_longest_prefix(const InputT& input, const IndexType startIndex, FSMStateType& finalState) const
 	{
-		constexpr FSMStateType startState = FiniteStateMachine<TransFuncT, InputT>::START_STATE;
+		if (this->isStrided())
+			return this->_longest_prefix_strided(input, startIndex, finalState);
+
+		FSMStateType currState = FiniteStateMachine<TransFuncT, InputT>::START_STATE;
+		std::optional<IndexType> end{};
+
+		if (this->_is_state_final(currState)) {
+			end = startIndex;
+			finalState = currState;
+		}
 
 		/**
-		* Loop through the path from the end seeking the closes final state.
-		* Update the character index as you do so.
+		 * Follow a path through the machine until the end of the string or until you reach a dead state.
+		 * Keep track of the end of the last accepted prefix as you go.
+		 * If the machine loops to the same state, all the characters it skips keep it in that state, so the prefix is checked once after skipping.
 		*/
-		std::ranges::reverse_view rv{ matchedStates };
-		for (const FSMStateSetType& state : rv)
-		{
+		for (IndexType charIndex = startIndex; charIndex < input.size();) {
+			const FSMStateType nextState = this->m_TransitionFunc.nextState(currState, input[charIndex++]);
+
+			// break out if it is dead
+			if (nextState == Base::DEAD_STATE)
+				break;
+
+			if (nextState == currState)
+				charIndex = m_Accelerator->skip(input, charIndex, currState);
 
-			if (this->_is_state_final(state))
-				return true;
+			currState = nextState;
 
-			charIndex--;
+			if (this->_is_state_final(currState)) {
+				end = charIndex;
+				finalState = currState;
+			}
 		}
 
-		// make sure `charIndex` does not get below 0
-		if (charIndex < 0)
-			charIndex = 0;
+		return end;
+	};
 
-		return false;
-	}
+	/**
+	* @brief Runs the DFA over the whole of `input`, two bytes per transition.
+	* @param[in] input The input string against which the simulation will run.
+	* @return The state that the DFA is in at the end of the input, or the dead state if it has died.
+	**/
+	template<typename TransFuncT, typename InputT>
+	FSMStateType DeterFiniteAutomaton<TransFuncT, InputT>::_run_strided(const InputT& input) const
+	{
+		const StrideTable& stride = *m_Stride;
+		FSMStateType currState = Base::START_STATE;
+		IndexType charIndex = 0;
+
+		// whether the states passed through are final does not matter to the whole string
+		while (charIndex + 1 < input.size()) {
+			const FSMStateType nextState = stride.step(currState, input[charIndex], input[charIndex + 1]) & StrideTable::STATE_MASK;
+			charIndex += 2;
+
+			if (nextState == Base::DEAD_STATE)
+				return nextState;
+
+			if (nextState == currState)
+				charIndex = m_Accelerator->skip(input, charIndex, currState);
+
+			currState = nextState;
+		}
+
+		// the byte left over by an odd length, if any
+		if (charIndex < input.size())
+			currState = this->m_TransitionFunc.nextState(currState, input[charIndex]);
+
+		return currState;
+	};
 
 	/**
-	* @brief Checks whether the substring starting from `startIndex` accepts. It also updates `charIndex` to the index of the last character of that substring.
-	* @param[in] matchedStates The set of states that form the path taken through the machine after simulating the machine against `input`.
-	* @param[in] startIndex The index, within `input`, at which the substring starts.
-	* @param[out] charIndex The index of the last checked character (the last that didn't result in a dead state).
-	* @return `true` if a substring starting from startIndex has accepted; `false` otherwise.
+	* @brief Finds the longest prefix of the substring of `input` starting from `startIndex` that the DFA accepts, two bytes per transition.
+	* @details The prefix may end after either byte of a transition: an accept after the first one is flagged by its entry (see StrideTable::MID_FINAL), and only then is the state it is in looked up.
+	* @see _longest_prefix
 	**/
 	template<typename TransFuncT, typename InputT>
-	bool DeterFiniteAutomaton<TransFuncT, InputT>::_check_accepted_substring(const InputT& input, std::vector<FSMStateType>& matchedStates, const size_t startIndex, size_t& charIndex) const
+	std::optional<IndexType> DeterFiniteAutomaton<TransFuncT, InputT>::_longest_prefix_strided(const InputT& input, const IndexType startIndex, FSMStateType& finalState) const
 	{
-		assert(startIndex == charIndex);
+		const StrideTable& stride = *m_Stride;
+		FSMStateType currState = Base::START_STATE;
+		std::optional<IndexType> end{};
 
-		FSMStateType startState = FiniteStateMachine<TransFuncT, InputT>::START_STATE;
-		FSMStateType currState = startState;
-		// start from startIndex until the end of the string or until you reach a dead state
-			/**
-			* The value of charIndex will be correct because the last time we increment it, the condition is guaranteed to fail.
-			* This guarantees that charIndex will always equal: the number of matched characters + startIndex.
-			*/
+		if (this->_is_state_final(currState)) {
+			end = startIndex;
+			finalState = currState;
+		}
 
-		for (; charIndex < input.size(); charIndex++) {
-			// get next state
-			auto c = input[charIndex];
-			currState = FSMStateType(this->m_TransitionFunc(currState, c));
+		IndexType charIndex = startIndex;
 
-			// break out if it is dead
-			if (currState == Base::DEAD_STATE) {
-				charIndex--; // do not keep count of the last character
-				break;
+		while (charIndex + 1 < input.size()) {
+			const std::uint32_t entry = stride.step(currState, input[charIndex], input[charIndex + 1]);
+			const FSMStateType nextState = entry & StrideTable::STATE_MASK;
+
+			if (entry & StrideTable::MID_FINAL) {
+				end = charIndex + 1;
+				finalState = this->m_TransitionFunc.nextState(currState, input[charIndex]);
 			}
 
-			// update the path through the machine
-			matchedStates.push_back(currState);
-		};
+			charIndex += 2;
 
-		// make sure charIndex is less that input.size() even if the entire string accepts
-		if (charIndex == input.size())
-			charIndex--;
+			if (nextState == Base::DEAD_STATE)
+				return end;
 
-		// endIndex = number of characters checked + the offset of the substring into the input string
-		size_t endIndex = matchedStates.size() + startIndex;
-		//this->m_Logger.logDebug(std::format("at _check_accepted_substring: charIndex: {}, endIndex: {}\n", charIndex, endIndex));
+			if (nextState == currState)
+				charIndex = m_Accelerator->skip(input, charIndex, currState);
 
-		// figure out whether there is an accepted longest prefix
-		bool accepted = _check_accepted_longest_prefix(matchedStates, endIndex);
-		
-		return accepted;
+			currState = nextState;
+
+			if (entry & StrideTable::END_FINAL) {
+				end = charIndex;
+				finalState = currState;
+			}
+		}
+
+		// the byte left over by an odd length, if any
+		if (charIndex < input.size()) {
+			const FSMStateType nextState = this->m_TransitionFunc.nextState(currState, input[charIndex]);
+
+			if (nextState != Base::DEAD_STATE && this->_is_state_final(nextState)) {
+				end = charIndex + 1;
+				finalState = nextState;
+			}
+		}
+
+		return end;
 	};
 
 	/**
@@ -313,6 +545,12 @@ namespace m0st4fa::fsm {
 			return this->_simulate_longest_prefix(input);
 		case FSM_MODE::MM_LONGEST_SUBSTRING:
 			return this->_simulate_longest_substring(input);
+		case FSM_MODE::MM_COUNT:
+			return this->_simulate_count(input);
+		case FSM_MODE::MM_COUNT_ENDS:
+			return this->_simulate_count_ends(input);
+		case FSM_MODE::MM_ANY_MATCH:
+			return this->_simulate_any_match(input);
 		default:
 			std::cerr << "Unreachable: simulate() cannot reach this point." << std::endl;
 			throw UnrecognizedSimModeException();
@@ -320,4 +558,153 @@ namespace m0st4fa::fsm {
 
 	}
 
-}
\ No newline at end of file
+	/**
+	* @brief Runs the DFA over `input` from the state of a run at some offset, recording the checkpoints it passes into `index`, if any.
+	* @param[in] input The input string, which holds the bytes of the whole input starting at offset `inputOffset`.
+	* @param[in] inputOffset The (absolute) offset of the first byte of `input`.
+	* @param[in, out] run The state of the run, which is updated up to the end of `input` or the death of the DFA.
+	* @param[out] index The index into which checkpoints are recorded, or `nullptr`.
+	**/
+	template<typename TransFuncT, typename InputT>
+	void DeterFiniteAutomaton<TransFuncT, InputT>::_run_checkpointed(const InputT& input, const IndexType inputOffset, Checkpoint& run, CheckpointIndex* index) const
+	{
+		// records the checkpoints up to the offset of the run; the machine has been in its current state at each of them, since it has either just entered it or looped on it
+		const auto record = [&]() {
+			if (!index)
+				return;
+
+			for (IndexType offset = index->getNextOffset(); offset <= run.offset; offset = index->getNextOffset())
+				index->push(this->_is_state_final(run.state) ? Checkpoint{ offset, run.state, offset, run.state } : Checkpoint{ offset, run.state, run.acceptEnd, run.finalState });
+		};
+
+		for (IndexType charIndex = run.offset - inputOffset; charIndex < input.size();) {
+			record();
+
+			const FSMStateType nextState = this->m_TransitionFunc.nextState(run.state, input[charIndex++]);
+
+			if (nextState == Base::DEAD_STATE) {
+				run.state = nextState;
+				run.offset = inputOffset + charIndex;
+
+				if (index)
+					index->setDeath(run);
+
+				return;
+			}
+
+			if (nextState == run.state)
+				charIndex = m_Accelerator->skip(input, charIndex, run.state);
+
+			run.state = nextState;
+			run.offset = inputOffset + charIndex;
+
+			if (this->_is_state_final(run.state)) {
+				run.acceptEnd = run.offset;
+				run.finalState = run.state;
+			}
+		}
+
+		record();
+	};
+
+	/**
+	* @brief Gets the result of simulating the input up to the offset of `run` using the given simulation method.
+	**/
+	template<typename TransFuncT, typename InputT>
+	FSMResult DeterFiniteAutomaton<TransFuncT, InputT>::_checkpointed_result(const InputT& input, const Checkpoint& run, const FSM_MODE mode) const
+	{
+		if (mode == FSM_MODE::MM_WHOLE_STRING) {
+			const bool accepted = this->_is_state_final(run.state);
+
+			return FSMResult(accepted, accepted ? FSMStateSetType{ run.state } : FSMStateSetType{ Base::START_STATE }, { 0, accepted ? run.offset : 0 }, input);
+		}
+
+		if (run.acceptEnd)
+			return FSMResult(true, run.finalState, { 0, *run.acceptEnd }, input);
+
+		return FSMResult(false, {}, { 0, 0 }, input);
+	};
+
+	/**
+	* @brief Checks that `mode` runs over the input from its start only, which is what checkpoints can resume.
+	* @throw UnrecognizedSimModeException Thrown if `mode` is neither MM_WHOLE_STRING nor MM_LONGEST_PREFIX.
+	**/
+	template<typename TransFuncT, typename InputT>
+	void DeterFiniteAutomaton<TransFuncT, InputT>::_check_checkpointed_mode(const FSM_MODE mode) const
+	{
+		if (mode != FSM_MODE::MM_WHOLE_STRING && mode != FSM_MODE::MM_LONGEST_PREFIX) {
+			Logger{}.log(LoggerInfo::LL_ERROR, "DeterFiniteAutomaton: Only MM_WHOLE_STRING and MM_LONGEST_PREFIX simulations can be checkpointed.");
+			throw UnrecognizedSimModeException();
+		}
+	}
+
+	/**
+	* @brief Simulate the given input string using the given simulation method, recording a checkpoint every `index.getInterval()` bytes.
+	* @details The checkpoints allow resume() to re-run the simulation from any offset of the input without going over the bytes before it again.
+	* @param[in] input The input string to be simulated.
+	* @param[in] mode The simulation mode, which is either MM_WHOLE_STRING or MM_LONGEST_PREFIX.
+	* @param[out] index The index into which the checkpoints are recorded, replacing its previous checkpoints.
+	* @throw UnrecognizedSimModeException Thrown if `mode` is neither MM_WHOLE_STRING nor MM_LONGEST_PREFIX.
+	* @return FSMResult object indicating the result of the simulation.
+	*/
+	template<typename TransFuncT, typename InputT>
+	FSMResult DeterFiniteAutomaton<TransFuncT, InputT>::simulate(const InputT& input, const FSM_MODE mode, CheckpointIndex& index) const
+	{
+		this->_check_checkpointed_mode(mode);
+
+		constexpr FSMStateType startState = Base::START_STATE;
+		const bool isStartFinal = this->_is_state_final(startState);
+		Checkpoint run{ 0, startState, isStartFinal ? std::optional<IndexType>{ 0 } : std::nullopt, isStartFinal ? startState : Base::DEAD_STATE };
+
+		index.clear();
+		this->_run_checkpointed(input, 0, run, &index);
+
+		return this->_checkpointed_result(input, run, mode);
+	}
+
+	/**
+	* @brief Re-runs a checkpointed simulation over a window of its input, from the last checkpoint within the window.
+	* @details The result is that of simulating the first `inputOffset + input.size()` bytes of the whole input; only the bytes after the last checkpoint at or before the end of the window are gone over. The window may extend past the input that the checkpoints were recorded over, e.g. to resume a simulation as more input arrives.
+	* @param[in] input The window, which holds the bytes of the whole input starting at offset `inputOffset`.
+	* @param[in] mode The simulation mode, which is either MM_WHOLE_STRING or MM_LONGEST_PREFIX.
+	* @param[in] index The checkpoints recorded by simulating the whole input.
+	* @param[in] inputOffset The (absolute) offset of the first byte of `input`.
+	* @throw UnrecognizedSimModeException Thrown if `mode` is neither MM_WHOLE_STRING nor MM_LONGEST_PREFIX.
+	* @throw InvalidStateMachineArgumentsException Thrown if the window contains no checkpoint (and the DFA did not die before its end).
+	* @return FSMResult object indicating the result of the simulation; its indicies are absolute offsets of the whole input. Its input is the window if the window begins at offset 0, so that getMatch() slices the match out of it; otherwise, its input is empty (the match begins before the window), and so is the match that getMatch() returns.
+	*/
+	template<typename TransFuncT, typename InputT>
+	FSMResult DeterFiniteAutomaton<TransFuncT, InputT>::resume(const InputT& input, const FSM_MODE mode, const CheckpointIndex& index, const IndexType inputOffset) const
+	{
+		this->_check_checkpointed_mode(mode);
+
+		const IndexType windowEnd = inputOffset + input.size();
+
+		// the match begins at the start of the whole input, so it can only be sliced out of a window that begins there too
+		auto result = [&input, mode, inputOffset, this](const Checkpoint& run) {
+			FSMResult res = this->_checkpointed_result(input, run, mode);
+
+			if (inputOffset)
+				res.input = {};
+
+			return res;
+		};
+
+		// the DFA stays dead after it dies
+		if (index.getDeath() && index.getDeath()->offset <= windowEnd)
+			return result(*index.getDeath());
+
+		std::optional<Checkpoint> run = index.nearest(windowEnd);
+
+		if (!run || run->offset < inputOffset) {
+			const std::string message = "DeterFiniteAutomaton: The window of the input to resume the simulation over contains no checkpoint.";
+			Logger{}.log(LoggerInfo::LL_ERROR, message);
+			throw InvalidStateMachineArgumentsException{ message };
+		}
+
+		this->_run_checkpointed(input, inputOffset, *run, nullptr);
+
+		return result(*run);
+	}
+
+}
@@ -0,0 +1,231 @@
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+
+#include "DFA.h"
+#include "DFATable.h"
+
+// DECLARATIONS
+namespace m0st4fa::fsm {
+
+	/**
+	 * @brief The set operation that a product DFA recognizes the language of.
+	 * @see makeProductDFA
+	 */
+	enum class PRODUCT_OPERATION {
+		//! @brief Strings accepted by either machine.
+		PO_UNION = 0,
+
+		//! @brief Strings accepted by both machines.
+		PO_INTERSECTION,
+
+		//! @brief Strings accepted by the first machine but not by the second.
+		PO_DIFFERENCE,
+
+		//! @brief Strings accepted by exactly one of the machines.
+		PO_SYMMETRIC_DIFFERENCE,
+
+		//! @brief The number of enumerators that this enumeration has.
+		PO_OPERATION_COUNT,
+	};
+
+	/**
+	 * @brief The type of the DFAs built by product construction.
+	 */
+	using ProductDFA = DeterFiniteAutomaton<TransFn<DFATable>>;
+
+	//! @brief The default maximum number of states of a product DFA.
+	constexpr size_t DEFAULT_MAX_PRODUCT_STATES = size_t{ 1 } << 16;
+
+	template <typename LhsT, typename RhsT, typename AcceptT>
+	ProductDFA buildProductDFA(const LhsT&, const RhsT&, AcceptT, const size_t = DEFAULT_MAX_PRODUCT_STATES);
+
+	template <typename LhsT, typename RhsT>
+	ProductDFA makeProductDFA(const LhsT&, const RhsT&, const PRODUCT_OPERATION, const size_t = DEFAULT_MAX_PRODUCT_STATES);
+
+	template <typename DFAT>
+	ProductDFA makeComplementDFA(const DFAT&, const size_t = DEFAULT_MAX_PRODUCT_STATES);
+
+}
+
+// IMPLEMENTATIONS
+namespace m0st4fa::fsm {
+
+	/**
+	 * @brief Builds a DFA that runs two DFAs over bytes in lock-step, and accepts according to whether each of them accepts.
+	 * @details The states of the product are pairs of states of the two DFAs, explored breadth first from the pair of start states, so that unreachable pairs are never built. The pairs from which no accepting pair can be reached are then trimmed (merged into the dead state), and the rest are renumbered in the order they were discovered. The result is stored as a DFATable.
+	 * The dead state of either DFA takes part in the product like any other state; e.g. the union keeps running the first DFA after the second one dies, and the complement of a DFA has an explicit accepting sink in place of its dead state.
+	 * @param[in] lhs The first DFA.
+	 * @param[in] rhs The second DFA.
+	 * @param[in] accepts A callable that takes whether the state of `lhs` is final and whether the state of `rhs` is final, and returns whether their pair is final.
+	 * @param[in] maxStates The maximum number of pairs that may be explored, counting the pair of dead states if it is reachable (but not the placeholder that stands for the dead state of the product).
+	 * @return The product DFA.
+	 * @throw StateLimitExceededException Thrown if more than `maxStates` pairs are reachable.
+	 * @throw InvalidStateMachineArgumentsException Thrown if the product accepts no string at all (a DFA must have final states).
+	 */
+	template <typename LhsT, typename RhsT, typename AcceptT>
+	ProductDFA buildProductDFA(const LhsT& lhs, const RhsT& rhs, AcceptT accepts, const size_t maxStates)
+	{
+		constexpr size_t alphabetSize = DFATable::ALPHABET_SIZE;
+		constexpr FSMStateType deadState = ProductDFA::getDeadState();
+		constexpr FSMStateType startState = ProductDFA::getStartState();
+
+		const auto& lhsFn = lhs.getTransitionFunction();
+		const auto& rhsFn = rhs.getTransitionFunction();
+
+		// the pair of each product state (the first entry stands for the dead state), and the product state of each pair
+		std::vector<std::pair<FSMStateType, FSMStateType>> pairs{ {deadState, deadState}, {startState, startState} };
+		std::unordered_map<std::uint64_t, FSMStateType> stateOf{ {(std::uint64_t{ startState } << 32) | startState, startState} };
+		// the next product state of each (product state, byte) pair
+		std::vector<FSMStateType> transitions(2 * alphabetSize);
+
+		for (size_t state = startState; state < pairs.size(); state++) {
+			const auto [lhsState, rhsState] = pairs[state];
+			transitions.resize((state + 1) * alphabetSize);
+
+			for (size_t symbol = 0; symbol < alphabetSize; symbol++) {
+				const unsigned char byte = static_cast<unsigned char>(symbol);
+				const FSMStateType lhsNext = lhsState == deadState ? deadState : lhsFn.nextState(lhsState, byte);
+				const FSMStateType rhsNext = rhsState == deadState ? deadState : rhsFn.nextState(rhsState, byte);
+
+				const auto [it, inserted] = stateOf.try_emplace((std::uint64_t{ lhsNext } << 32) | rhsNext, static_cast<FSMStateType>(pairs.size()));
+
+				if (inserted) {
+					// the first entry of `pairs` is the placeholder of the dead state, so with the pair just discovered, `pairs.size()` pairs have been explored
+					if (pairs.size() > maxStates) {
+						const std::string message = std::format("buildProductDFA: The product DFA has more than {} states.", maxStates);
+						Logger{}.log(LoggerInfo::LL_ERROR, message);
+						throw StateLimitExceededException{ message };
+					}
+
+					pairs.emplace_back(lhsNext, rhsNext);
+				}
+
+				transitions[state * alphabetSize + symbol] = it->second;
+			}
+		}
+
+		const size_t stateCount = pairs.size();
+
+		// find the states from which a final state can be reached, walking the transitions backwards from the final states
+		std::vector<size_t> predecessorOffsets(stateCount + 1);
+		std::vector<FSMStateType> predecessors(transitions.size());
+
+		for (const FSMStateType target : transitions)
+			predecessorOffsets[target + 1]++;
+		for (size_t state = 0; state < stateCount; state++)
+			predecessorOffsets[state + 1] += predecessorOffsets[state];
+
+		std::vector<size_t> fill{ predecessorOffsets.begin(), predecessorOffsets.end() - 1 };
+		for (size_t i = 0; i < transitions.size(); i++)
+			predecessors[fill[transitions[i]]++] = static_cast<FSMStateType>(i / alphabetSize);
+
+		std::vector<bool> isFinal(stateCount), isAlive(stateCount);
+		std::vector<FSMStateType> stack{};
+
+		for (size_t state = startState; state < stateCount; state++) {
+			isFinal[state] = accepts(lhs.getFinalStates().contains(pairs[state].first), rhs.getFinalStates().contains(pairs[state].second));
+
+			if (isFinal[state]) {
+				isAlive[state] = true;
+				stack.push_back(static_cast<FSMStateType>(state));
+			}
+		}
+
+		while (stack.size()) {
+			const FSMStateType state = stack.back();
+			stack.pop_back();
+
+			for (size_t i = predecessorOffsets[state]; i < predecessorOffsets[state + 1]; i++) {
+				const FSMStateType predecessor = predecessors[i];
+
+				if (predecessor != deadState && !isAlive[predecessor]) {
+					isAlive[predecessor] = true;
+					stack.push_back(predecessor);
+				}
+			}
+		}
+
+		if (!isAlive[startState]) {
+			const std::string message = "buildProductDFA: The product DFA accepts no string.";
+			Logger{}.log(LoggerInfo::LL_ERROR, message);
+			throw InvalidStateMachineArgumentsException{ message };
+		}
+
+		// renumber the states that are kept, in the order they were discovered; the rest become the dead state
+		std::vector<FSMStateType> renumbered(stateCount, deadState);
+		FSMStateType keptCount = 1;
+
+		for (size_t state = startState; state < stateCount; state++)
+			if (isAlive[state])
+				renumbered[state] = keptCount++;
+
+		std::vector<FSMStateType> trimmed(size_t{ keptCount } * alphabetSize);
+		FSMStateSetType finalStates{};
+
+		for (size_t state = startState; state < stateCount; state++) {
+			if (!isAlive[state])
+				continue;
+
+			const FSMStateType newState = renumbered[state];
+
+			for (size_t symbol = 0; symbol < alphabetSize; symbol++)
+				trimmed[newState * alphabetSize + symbol] = renumbered[transitions[state * alphabetSize + symbol]];
+
+			if (isFinal[state])
+				finalStates.insert(newState);
+		}
+
+		return ProductDFA{ finalStates, TransFn<DFATable>{ DFATable::fromTransitions(trimmed) } };
+	}
+
+	/**
+	 * @brief Builds a DFA that recognizes the union, intersection, difference or symmetric difference of the languages of two DFAs over bytes.
+	 * @param[in] lhs The first DFA.
+	 * @param[in] rhs The second DFA.
+	 * @param[in] operation The set operation.
+	 * @param[in] maxStates The maximum number of states that may be explored.
+	 * @return The product DFA, which checks both conditions in a single pass over the input.
+	 * @throw InvalidStateMachineArgumentsException Thrown if `operation` is invalid, or if the product accepts no string at all.
+	 * @throw StateLimitExceededException Thrown if the product has more than `maxStates` states.
+	 * @see buildProductDFA
+	 */
+	template <typename LhsT, typename RhsT>
+	ProductDFA makeProductDFA(const LhsT& lhs, const RhsT& rhs, const PRODUCT_OPERATION operation, const size_t maxStates)
+	{
+		switch (operation) {
+		case PRODUCT_OPERATION::PO_UNION:
+			return buildProductDFA(lhs, rhs, [](const bool l, const bool r) { return l || r; }, maxStates);
+		case PRODUCT_OPERATION::PO_INTERSECTION:
+			return buildProductDFA(lhs, rhs, [](const bool l, const bool r) { return l && r; }, maxStates);
+		case PRODUCT_OPERATION::PO_DIFFERENCE:
+			return buildProductDFA(lhs, rhs, [](const bool l, const bool r) { return l && !r; }, maxStates);
+		case PRODUCT_OPERATION::PO_SYMMETRIC_DIFFERENCE:
+			return buildProductDFA(lhs, rhs, [](const bool l, const bool r) { return l != r; }, maxStates);
+		default: {
+			const std::string message = "makeProductDFA: The product operation is invalid.";
+			Logger{}.log(LoggerInfo::LL_ERROR, message);
+			throw InvalidStateMachineArgumentsException{ message };
+		}
+		}
+	}
+
+	/**
+	 * @brief Builds a DFA that accepts exactly the strings of bytes that `dfa` rejects.
+	 * @details The dead state of `dfa` becomes an explicit accepting sink.
+	 * @param[in] dfa The DFA to complement.
+	 * @param[in] maxStates The maximum number of states that may be explored.
+	 * @return The complement DFA.
+	 * @throw InvalidStateMachineArgumentsException Thrown if `dfa` accepts every string.
+	 * @throw StateLimitExceededException Thrown if the complement has more than `maxStates` states.
+	 */
+	template <typename DFAT>
+	ProductDFA makeComplementDFA(const DFAT& dfa, const size_t maxStates)
+	{
+		// the product of a DFA with itself has one state per state of the DFA
+		return buildProductDFA(dfa, dfa, [](const bool l, const bool) { return !l; }, maxStates);
+	}
+
+}
@@ -0,0 +1,368 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <map>
+#include <numeric>
+
+#include "FiniteStateMachine.h"
+
+// DECLARATIONS
+namespace m0st4fa::fsm {
+
+	/**
+	 * @brief A dense transition table for DFAs over bytes, compressed by grouping bytes into classes.
+	 * @details Bytes on which every state behaves identically are grouped into a single class, and the table stores one cell per (state, class) pair, which holds the next state. This makes a transition two array lookups, with no per-state allocation, and keeps the table small for typical alphabets.
+	 * The cells are as narrow as the number of states allows: 1 byte for up to 256 states, 2 bytes for up to 65536 states and 4 bytes otherwise. The width is chosen once, when the table is built, along with the mask that a cell is read with, so a transition reads every width the same way (a load of a full FSMStateType, masked down to the cell) and never branches on it.
+	 * It can be used in place of FSMTable by TransitionFunction (e.g. `DeterFiniteAutomaton<TransFn<DFATable>>`), either built directly out of its arrays or compiled from an FSMTable.
+	 * @note Only inputs of byte-sized symbols are supported; the dead state must not be left (its row must be all dead states).
+	 */
+	class DFATable {
+	public:
+		//! @brief The number of input symbols (bytes) that the table recognizes.
+		static constexpr size_t ALPHABET_SIZE = 256;
+
+		//! @brief The type of the map from bytes to their classes.
+		using ClassMapType = std::array<std::uint8_t, ALPHABET_SIZE>;
+
+	private:
+		//! @brief The class of each byte.
+		ClassMapType m_Classes{};
+		//! @brief The number of byte classes (the length of each row).
+		size_t m_ClassCount = 1;
+		//! @brief The number of states (rows).
+		size_t m_StateCount = 0;
+		//! @brief The base-2 logarithm of the width of each cell, in bytes (0, 1 or 2).
+		size_t m_CellShift = 0;
+		//! @brief The bits of a load of a full FSMStateType at a cell that belong to the cell.
+		FSMStateType m_CellMask = std::numeric_limits<std::uint8_t>::max();
+		//! @brief The next state of each (state, class) pair, `1 << m_CellShift` bytes each, indexed by `state * m_ClassCount + class`; padded so that the last cell can be read by a load of a full FSMStateType.
+		std::vector<unsigned char> m_Cells{};
+		//! @brief Each state, indexed by itself, for targets() to return views of.
+		std::vector<FSMStateType> m_StateIds{};
+
+		void _store(const std::vector<FSMStateType>&);
+		template <typename CellT>
+		void _store_cells(const std::vector<FSMStateType>&);
+
+		//! @brief Gets the next state held by the cell at `index`.
+		FSMStateType _cell(const size_t index) const noexcept {
+			FSMStateType cell;
+			std::memcpy(&cell, m_Cells.data() + (index << m_CellShift), sizeof(cell));
+
+			// the cell is the first bytes loaded, which are the high-order ones on big-endian targets
+			if constexpr (std::endian::native == std::endian::big)
+				cell >>= (sizeof(FSMStateType) - (size_t{ 1 } << m_CellShift)) * 8;
+
+			return cell & m_CellMask;
+		}
+
+	public:
+
+		//! @brief Default constructor. The constructed table maps every state to the dead state.
+		DFATable() = default;
+
+		DFATable(const ClassMapType&, const size_t, std::vector<FSMStateType>);
+
+		explicit DFATable(const FSMTable&);
+
+		static DFATable fromTransitions(std::span<const FSMStateType>);
+
+		void foldCase(const bool = true);
+
+		/**
+		 * @brief Gets the state that `state` is mapped to on `input`.
+		 * @return The next state, or the dead state if there is no such entry.
+		 */
+		template<typename InputT = char>
+		FSMStateType nextState(const FSMStateType state, const InputT input) const noexcept(true) {
+			const size_t symbol = toSymbolIndex(input);
+
+			if (state >= this->size() || symbol >= ALPHABET_SIZE)
+				return FSMStateType{};
+
+			return this->_cell(state * m_ClassCount + m_Classes[symbol]);
+		}
+
+		/**
+		 * @brief Gets the states that `state` is mapped to on `input`, as a view.
+		 * @return A view of the next state, or an empty view if `state` is mapped to the dead state.
+		 * @see FSMTable::targets(const FSMStateType state, const InputT input) const
+		 */
+		template<typename InputT = char>
+		std::span<const FSMStateType> targets(const FSMStateType state, const InputT input) const noexcept(true) {
+			const size_t symbol = toSymbolIndex(input);
+
+			if (state >= this->size() || symbol >= ALPHABET_SIZE)
+				return {};
+
+			const FSMStateType next = this->_cell(state * m_ClassCount + m_Classes[symbol]);
+
+			return { m_StateIds.data() + next, next == FSMStateType{} ? size_t{ 0 } : size_t{ 1 } };
+		}
+
+		/**
+		 * @brief Accesses the table entry indexed by `state` and `input`.
+		 * @return A copy of the table entry indexed by `state` and `input` (empty if `state` is mapped to the dead state).
+		 */
+		template<typename InputT = char>
+		FSMStateSetType operator()(const FSMStateType state, const InputT input) const noexcept(true) {
+			const std::span<const FSMStateType> res = this->targets(state, input);
+
+			return res.empty() ? FSMStateSetType{} : FSMStateSetType{ res.front() };
+		}
+
+		//! @brief Does nothing; the table is always laid out for simulation. @see FSMTable::freeze() const
+		void freeze() const {};
+
+		//! @brief Gets the number of rows (states) of the table.
+		size_t size() const {
+			return m_StateCount;
+		}
+
+		//! @brief Gets the number of byte classes.
+		size_t getClassCount() const {
+			return m_ClassCount;
+		}
+
+		//! @brief Gets the class of `byte`.
+		std::uint8_t getClass(const unsigned char byte) const {
+			return m_Classes[byte];
+		}
+
+		//! @brief Gets the map from bytes to their classes.
+		const ClassMapType& getClassMap() const {
+			return m_Classes;
+		}
+
+		//! @brief Gets the width of each cell of the table, in bytes.
+		size_t getStateIdWidth() const {
+			return size_t{ 1 } << m_CellShift;
+		}
+
+		/**
+		 * @brief Gets the narrowest width, in bytes, of a cell that can hold any of `stateCount` states.
+		 */
+		static constexpr size_t getStateIdWidthFor(const size_t stateCount) {
+			return stateCount <= (size_t{ 1 } << 8) ? 1 : stateCount <= (size_t{ 1 } << 16) ? 2 : sizeof(FSMStateType);
+		}
+
+		/**
+		 * @brief Gets the next state of each (state, class) pair, indexed by `state * getClassCount() + class`.
+		 * @return A copy of the cells, widened to FSMStateType.
+		 */
+		std::vector<FSMStateType> getTransitions() const {
+			std::vector<FSMStateType> res(m_StateCount * m_ClassCount);
+
+			for (size_t i = 0; i < res.size(); i++)
+				res[i] = this->_cell(i);
+
+			return res;
+		}
+
+		//! @brief Gets the size of the table, in bytes.
+		size_t getSizeInBytes() const {
+			return sizeof(m_Classes) + m_Cells.size() + m_StateCount * sizeof(FSMStateType);
+		}
+
+	};
+
+}
+
+// IMPLEMENTATIONS
+namespace m0st4fa::fsm {
+
+	/**
+	 * @brief Initialize a new table out of its arrays.
+	 * @param[in] classes The class of each byte.
+	 * @param[in] classCount The number of byte classes.
+	 * @param[in] next The next state of each (state, class) pair, indexed by `state * classCount + class`.
+	 * @throw InvalidStateMachineArgumentsException Thrown if a byte has a class out of range, the size of `next` is not a multiple of `classCount`, or a cell of `next` holds a state that has no row (every state that the table leads to must have a row).
+	 */
+	inline DFATable::DFATable(const ClassMapType& classes, const size_t classCount, std::vector<FSMStateType> next) :
+		m_Classes{ classes }, m_ClassCount{ classCount }
+	{
+		const bool classesInRange = std::all_of(classes.begin(), classes.end(), [classCount](const std::uint8_t c) { return c < classCount; });
+
+		if (!classCount || !classesInRange || next.size() % classCount) {
+			const std::string message = "DFATable: The classes of the table do not match its transitions.";
+			Logger{}.log(LoggerInfo::LL_ERROR, message);
+			throw InvalidStateMachineArgumentsException{ message };
+		}
+
+		this->_store(next);
+	}
+
+	/**
+	 * @brief Compiles an FSMTable of a DFA into a dense table.
+	 * @details Every state of `table` keeps its number. If an entry holds many states, the first (smallest) of them is taken, as DeterFiniteAutomaton does.
+	 * @param[in] table The table to compile.
+	 * @throw InvalidStateMachineArgumentsException Thrown if `table` has entries on symbols that are not bytes.
+	 */
+	inline DFATable::DFATable(const FSMTable& table)
+	{
+		// the number of states is the number of rows, or more, if a state with no row is reachable
+		size_t stateCount = table.size();
+
+		for (size_t state = 0; state < table.size(); state++) {
+			const auto& row = table.at(static_cast<FSMStateType>(state));
+
+			for (size_t symbol = 0; symbol < row.size(); symbol++) {
+				if (row[symbol].empty())
+					continue;
+
+				if (symbol >= ALPHABET_SIZE) {
+					const std::string message = "DFATable: Only tables over bytes can be compiled.";
+					Logger{}.log(LoggerInfo::LL_ERROR, message);
+					throw InvalidStateMachineArgumentsException{ message };
+				}
+
+				stateCount = std::max<size_t>(stateCount, *row[symbol].begin() + 1);
+			}
+		}
+
+		// lay the table out a full row of bytes per state, then compress it
+		std::vector<FSMStateType> transitions(stateCount * ALPHABET_SIZE);
+
+		for (size_t state = 0; state < table.size(); state++)
+			for (size_t symbol = 0; symbol < ALPHABET_SIZE; symbol++) {
+				const std::span<const FSMStateType> targets = table.targets(static_cast<FSMStateType>(state), symbol);
+				transitions[state * ALPHABET_SIZE + symbol] = targets.empty() ? FSMStateType{} : targets.front();
+			}
+
+		*this = DFATable::fromTransitions(transitions);
+	}
+
+	/**
+	 * @brief Makes the table match ASCII letters regardless of their case.
+	 * @details Each state is sent, on both cases of a letter, to the state it is sent to on either of them. The table is then rebuilt, so the two cases usually end up in the same class and no transition costs more than before.
+	 * @param[in] deterministic Ignored; the table is always deterministic.
+	 * @throw InvalidStateMachineArgumentsException Thrown if a state leads to different (live) states on the two cases of a letter.
+	 * @see FSMTable::foldCase
+	 */
+	inline void DFATable::foldCase([[maybe_unused]] const bool deterministic)
+	{
+		std::vector<FSMStateType> transitions(m_StateCount * ALPHABET_SIZE);
+
+		for (size_t state = 0; state < m_StateCount; state++) {
+			FSMStateType* const row = transitions.data() + state * ALPHABET_SIZE;
+
+			for (size_t symbol = 0; symbol < ALPHABET_SIZE; symbol++)
+				row[symbol] = this->_cell(state * m_ClassCount + m_Classes[symbol]);
+
+			for (size_t lower = 'a'; lower <= 'z'; lower++) {
+				const size_t upper = lower - 'a' + 'A';
+
+				if (row[lower] != FSMStateType{} && row[upper] != FSMStateType{} && row[lower] != row[upper]) {
+					const std::string message = "DFATable: Folding case would make the table non-deterministic.";
+					Logger{}.log(LoggerInfo::LL_ERROR, message);
+					throw InvalidStateMachineArgumentsException{ message };
+				}
+
+				row[lower] = row[upper] = std::max(row[lower], row[upper]);
+			}
+		}
+
+		*this = DFATable::fromTransitions(transitions);
+	}
+
+	/**
+	 * @brief Builds a dense table out of the next state of every (state, byte) pair, grouping the bytes on which every state behaves identically into classes.
+	 * @param[in] transitions The next state of each (state, byte) pair, indexed by `state * ALPHABET_SIZE + byte`.
+	 * @return The compressed table.
+	 * @throw InvalidStateMachineArgumentsException Thrown if the size of `transitions` is not a multiple of ALPHABET_SIZE, or a transition leads to a state that has no row.
+	 */
+	inline DFATable DFATable::fromTransitions(std::span<const FSMStateType> transitions)
+	{
+		if (transitions.size() % ALPHABET_SIZE) {
+			const std::string message = "DFATable: The transitions must hold a full row of bytes per state.";
+			Logger{}.log(LoggerInfo::LL_ERROR, message);
+			throw InvalidStateMachineArgumentsException{ message };
+		}
+
+		const size_t stateCount = transitions.size() / ALPHABET_SIZE;
+		DFATable res{};
+
+		// group the bytes on which every state behaves identically into classes
+		std::map<std::vector<FSMStateType>, std::uint8_t> classOf{};
+		std::vector<std::vector<FSMStateType>> columns{};
+
+		for (size_t symbol = 0; symbol < ALPHABET_SIZE; symbol++) {
+			std::vector<FSMStateType> column(stateCount);
+
+			for (size_t state = 0; state < stateCount; state++)
+				column[state] = transitions[state * ALPHABET_SIZE + symbol];
+
+			const auto [it, inserted] = classOf.emplace(column, static_cast<std::uint8_t>(columns.size()));
+			if (inserted)
+				columns.push_back(std::move(column));
+
+			res.m_Classes[symbol] = it->second;
+		}
+
+		res.m_ClassCount = columns.size();
+		std::vector<FSMStateType> next(stateCount * res.m_ClassCount);
+
+		for (size_t c = 0; c < res.m_ClassCount; c++)
+			for (size_t state = 0; state < stateCount; state++)
+				next[state * res.m_ClassCount + c] = columns[c][state];
+
+		res._store(next);
+
+		return res;
+	}
+
+	/**
+	 * @brief Stores the cells of the table in the narrowest width that fits its states.
+	 * @details This is the only place the width is branched on; the mask and shift that the cells are read with are fixed here.
+	 * @param[in] next The next state of each (state, class) pair, indexed by `state * m_ClassCount + class`.
+	 * @throw InvalidStateMachineArgumentsException Thrown if a cell holds a state that has no row.
+	 */
+	inline void DFATable::_store(const std::vector<FSMStateType>& next)
+	{
+		m_StateCount = next.size() / m_ClassCount;
+
+		if (std::any_of(next.begin(), next.end(), [this](const FSMStateType state) { return state >= m_StateCount; })) {
+			const std::string message = "DFATable: Every state that the table leads to must have a row.";
+			Logger{}.log(LoggerInfo::LL_ERROR, message);
+			throw InvalidStateMachineArgumentsException{ message };
+		}
+
+		switch (getStateIdWidthFor(m_StateCount)) {
+		case 1:
+			this->_store_cells<std::uint8_t>(next);
+			break;
+		case 2:
+			this->_store_cells<std::uint16_t>(next);
+			break;
+		default:
+			this->_store_cells<FSMStateType>(next);
+		}
+
+		m_StateIds.resize(m_StateCount);
+		std::iota(m_StateIds.begin(), m_StateIds.end(), FSMStateType{ 0 });
+	}
+
+	/**
+	 * @brief Stores the cells of the table as cells of type `CellT`, and sets the shift and mask that they are read with.
+	 * @param[in] next The next state of each (state, class) pair, each of which fits in `CellT`.
+	 */
+	template <typename CellT>
+	void DFATable::_store_cells(const std::vector<FSMStateType>& next)
+	{
+		static_assert(sizeof(CellT) <= sizeof(FSMStateType) && std::has_single_bit(sizeof(CellT)));
+
+		m_CellShift = std::countr_zero(sizeof(CellT));
+		m_CellMask = static_cast<FSMStateType>(std::numeric_limits<CellT>::max());
+		m_Cells.assign(next.size() * sizeof(CellT) + (sizeof(FSMStateType) - sizeof(CellT)), 0);
+
+		for (size_t i = 0; i < next.size(); i++) {
+			const CellT cell = static_cast<CellT>(next[i]);
+			std::memcpy(m_Cells.data() + i * sizeof(CellT), &cell, sizeof(CellT));
+		}
+	}
+
+}
@@ -10,6 +10,10 @@
 #include <functional>
 #include <concepts>
 #include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <span>
+#include <type_traits>
 
 #include "utility/Logger.h"
 #include "tabulate/table.hpp"
@@ -36,6 +40,15 @@ namespace m0st4fa::fsm {
 
 	};
 
+	/**
+	 * @brief The exception thrown when building a state machine would take more states than allowed.
+	 */
+	struct StateLimitExceededException : public std::length_error {
+
+		StateLimitExceededException(const std::string& message) : std::length_error{ message } {};
+
+	};
+
 }
 
 // TYPE ALIASES AND CONCEPTS (AND A RELATED STRUCT)
@@ -62,6 +75,8 @@ namespace m0st4fa::fsm {
 		FSMStateSetType(const SetType& set) : m_StateSet{ set } {};
 		FSMStateSetType(const FSMStateType state) : m_StateSet{ state } {};
 		FSMStateSetType() = default;
+		FSMStateSetType(const FSMStateSetType&) = default;
+		FSMStateSetType(FSMStateSetType&&) noexcept = default;
 
 		// CONVERSION
 		explicit operator SetType() const {
@@ -90,6 +105,16 @@ namespace m0st4fa::fsm {
 			this->m_StateSet = rhs.m_StateSet;
 			return *this;
 		}
+		FSMStateSetType& operator=(FSMStateSetType&& rhs) noexcept {
+			this->m_StateSet = std::move(rhs.m_StateSet);
+			return *this;
+		}
+		void clear() noexcept {
+			m_StateSet.clear();
+		}
+		void swap(FSMStateSetType& other) noexcept {
+			m_StateSet.swap(other.m_StateSet);
+		}
 
 		// ITERATORS
 		SetType::iterator begin() {
@@ -120,7 +145,7 @@ namespace m0st4fa::fsm {
 
 	/**
 	 * @brief Flags given to finite state machine upon initialization.
-	 * @note Not implemented yet.
+	 * @see FSM_FLAG
 	 */
 	using FlagsType = unsigned;
 
@@ -133,6 +158,20 @@ namespace m0st4fa::fsm {
 	template <typename T>
 	concept StateSetConcept = std::is_same_v<T, FSMStateSetType> || std::is_same_v<T, std::vector<FSMStateType>>;
 
+	/**
+	 * @brief Converts an input symbol into the index used to access transition tables.
+	 * @details Integral symbols are reinterpreted as unsigned, so that characters above `0x7F` (negative when `char` is signed) index the table the same way bytes do.
+	 * @param[in] input The input symbol (typically a character).
+	 * @return The non-negative index corresponding to `input`.
+	 */
+	template <typename InputT>
+	constexpr size_t toSymbolIndex(const InputT input) noexcept {
+		if constexpr (std::is_integral_v<InputT>)
+			return static_cast<std::make_unsigned_t<InputT>>(input);
+		else
+			return static_cast<size_t>(input);
+	}
+
 	template <StateSetConcept T>
 	std::ostream& operator<<(std::ostream& os, const T& set)
 	{
@@ -181,6 +220,15 @@ namespace m0st4fa::fsm {
 		//! @brief Look for the longest substring, which might be the entire string.
 		MM_LONGEST_SUBSTRING,
 
+		//! @brief Count the non-empty, non-overlapping matches, each of which is the longest one beginning at the leftmost position after the previous one. The count is stored in FSMResult::count.
+		MM_COUNT,
+
+		//! @brief Count the positions of the input at which at least one non-empty match (beginning anywhere) ends. The count is stored in FSMResult::count. DFAs over bytes count them in a single pass, at one lookup per byte (see UnanchoredTable).
+		MM_COUNT_ENDS,
+
+		//! @brief Check whether any substring (possibly empty) accepts, stopping at the end of the first match found. The indicies span the input up to the end of that match.
+		MM_ANY_MATCH,
+
 		//! @brief The default value.
 		MM_NONE,
 
@@ -209,20 +257,36 @@ namespace m0st4fa::fsm {
 
 	/**
 	 * @brief Flags to customize the behavior of the FSM.
-	 * @note Right now, they are not implemented.
-	 * @todo Implement the commented out flags (in the source code) in the state machines.
+	 * @details Flags are bits, and can be combined with `|`. They are honored when the machine is constructed, so they cost nothing while simulating.
 	 * @see NonDeterFiniteAutomaton
 	 * @see DeterFiniteAutomaton
 	 */
 	enum FSM_FLAG {
-		//FF_CASE_INSENSITIVE,
-		//FF_CASE_SENSITIVE,
-
-		//! @brief The default value.
+		//! @brief The default value. Matching is case-sensitive.
 		FF_FLAG_NONE = 0,
 
-		//! @brief The number of enumerators that this enumeration has.
-		FF_FLAG_COUNT
+		/**
+		 * @brief Match ASCII letters regardless of their case.
+		 * @details The transitions of the machine on each letter are merged with those on the same letter in the other case when the machine is constructed, so the input is neither copied nor folded while simulating.
+		 * @see FSMTable::foldCase
+		 */
+		FF_CASE_INSENSITIVE = 1 << 0,
+
+		/**
+		 * @brief Consume two bytes per transition, where the machine allows it (DFAs over bytes only; ignored by NFAs).
+		 * @details A StrideTable is built when the machine is constructed, unless it would be too large, in which case the machine consumes one byte at a time as usual. It is used by the simulations that run the machine from a single position at a time (all modes but FSM_MODE::MM_COUNT_ENDS and FSM_MODE::MM_ANY_MATCH), with the same results.
+		 * @see DeterFiniteAutomaton::isStrided
+		 */
+		FF_STRIDE_2 = 1 << 1,
+
+		//! @brief The mask of all the flags, e.g. to check that a combination holds no unknown flag (`(flags & ~FF_FLAG_ALL) == 0`).
+		FF_FLAG_ALL = FF_CASE_INSENSITIVE | FF_STRIDE_2,
+
+		/**
+		 * @brief Formerly the number of enumerators that this enumeration has, which it no longer is since the enumerators became bit flags.
+		 * @deprecated Kept, with the value it had, so that existing code still compiles; use FF_FLAG_ALL to check for unknown flags instead.
+		 */
+		FF_FLAG_COUNT [[deprecated("FSM_FLAG enumerators are bit flags; use FF_FLAG_ALL instead")]] = FF_FLAG_ALL
 	};
 
 }
@@ -245,6 +309,7 @@ namespace m0st4fa::fsm {
 	public:
 		TransitionFunction() = default;
 		TransitionFunction(const TableT& table) : m_Table(table) {}
+		TransitionFunction(TableT&& table) : m_Table(std::move(table)) {}
 		
 		/**
 		 * @brief Accesses the table entry indexed by `state` and `input`.
@@ -278,15 +343,83 @@ namespace m0st4fa::fsm {
 		template <typename InputT>
 		FSMStateSetType operator()(const FSMStateSetType& stateSet, const InputT input) const {
 			FSMStateSetType res;
-			
-			for (FSMStateType state : stateSet) {
-				FSMStateSetType tmp = m_Table(state, input);
-				res.insert(tmp.begin(), tmp.end());
-			}
+
+			this->operator()(stateSet, input, res);
 				
 			return res;
 		}
 
+		/**
+		 * @brief Writes the states that every state in `stateSet` is mapped to on `input` into `out`.
+		 * @details This is the same as operator()(const FSMStateSetType& stateSet, const InputT input) const, except that the result is written into a buffer supplied (and typically reused across calls) by the caller, and table entries are never copied.
+		 * @param[in] stateSet The set of states whose corresponding entires will be accessed.
+		 * @param[in] input The input used to access the entry corresponding to a given state.
+		 * @param[out] out The buffer that receives the result. It is cleared first. If it is a `std::vector`, it is left sorted and free of duplicates.
+		 */
+		template <typename InputT, StateSetConcept SetT>
+		void operator()(const FSMStateSetType& stateSet, const InputT input, SetT& out) const {
+			out.clear();
+
+			for (FSMStateType state : stateSet)
+				for (FSMStateType target : m_Table.targets(state, input)) {
+					if constexpr (std::is_same_v<SetT, FSMStateSetType>)
+						out.insert(target);
+					else
+						out.push_back(target);
+				}
+
+			if constexpr (not std::is_same_v<SetT, FSMStateSetType>) {
+				std::sort(out.begin(), out.end());
+				out.erase(std::unique(out.begin(), out.end()), out.end());
+			}
+		}
+
+		/**
+		 * @brief Calls `fun` with every state that `state` is mapped to on `input`, without copying the table entry.
+		 * @param[in] state The state whose corresponding entry will be visited.
+		 * @param[in] input The input used to access the entry corresponding to `state`.
+		 * @param[in] fun The callable that is called with each target state.
+		 */
+		template <typename InputT, typename FunT>
+		void forEachTarget(const FSMStateType state, const InputT input, FunT&& fun) const {
+			for (const FSMStateType target : m_Table.targets(state, input))
+				fun(target);
+		}
+
+		/**
+		 * @brief Gets the state that `state` is mapped to on `input`, as used by deterministic machines.
+		 * @return The first (smallest) state of the table entry indexed by `state` and `input`, or the dead state if the entry is empty.
+		 */
+		template <typename InputT>
+		FSMStateType nextState(const FSMStateType state, const InputT input) const noexcept(true) {
+			// dense deterministic tables store the next state directly
+			if constexpr (requires { { m_Table.nextState(state, input) } -> std::same_as<FSMStateType>; })
+				return m_Table.nextState(state, input);
+
+			const std::span<const FSMStateType> targets = m_Table.targets(state, input);
+
+			return targets.empty() ? FSMStateType{} : targets.front();
+		}
+
+		/**
+		 * @brief Builds the contiguous layout of the underlying table ahead of time.
+		 * @see FSMTable::freeze() const
+		 */
+		void freeze() const {
+			m_Table.freeze();
+		}
+
+		/**
+		 * @brief Makes the underlying table match ASCII letters regardless of their case.
+		 * @see FSMTable::foldCase
+		 */
+		void foldCase(const bool deterministic) requires requires(TableT& table) { table.foldCase(deterministic); } {
+			m_Table.foldCase(deterministic);
+		}
+
+		//! @brief Gets the underlying table.
+		const TableT& getTable() const { return m_Table; };
+
 	};
 
 	template<typename TableT = FSMTable>
@@ -330,6 +463,17 @@ namespace m0st4fa::fsm {
 			return false;
 		}
 		
+		/**
+		* @brief Checks whether `state` is a final state and returns a boolean indicating it.
+		* @details This is the same as _is_state_final(const FSMStateSetType& state) const, without constructing a set out of `state` first.
+		* @param[in] state The state to check for whether it is final or not.
+		* @return `True` if `state` is a final state; `False` otherwise.
+		**/
+		inline bool _is_state_final(const FSMStateType state) const
+		{
+			return this->getFinalStates().contains(state);
+		}
+
 		/**
 		* @brief Searches for the final states within a state set and returns them.
 		* @param[in] state The state set that will be searched.
@@ -380,8 +524,8 @@ namespace m0st4fa::fsm {
 		 * @param[in] machineType The type of the state machine.
 		 * @param[in] flags The flags given to the state machine.
 		 */
-		FiniteStateMachine(const FSMStateSetType& fStates, const TransFuncT& tranFn, FSM_TYPE machineType ,FlagsType flags) :
-			m_FinalStates { fStates }, m_TransitionFunc{ tranFn }, m_MachineType {machineType}, m_Flags{flags}
+		FiniteStateMachine(const FSMStateSetType& fStates, TransFuncT tranFn, FSM_TYPE machineType ,FlagsType flags) :
+			m_FinalStates { fStates }, m_TransitionFunc{ std::move(tranFn) }, m_MachineType {machineType}, m_Flags{flags}
 			{
 			
 			if (fStates.empty()) {
@@ -395,9 +539,33 @@ namespace m0st4fa::fsm {
 				m_Logger.log(LoggerInfo::LL_ERROR, message);
 				throw InvalidStateMachineArgumentsException{ message };
 			};
+
+			if (flags & FSM_FLAG::FF_CASE_INSENSITIVE) {
+				if constexpr (requires { m_TransitionFunc.foldCase(true); })
+					m_TransitionFunc.foldCase(machineType == FSM_TYPE::MT_DFA);
+				else {
+					const std::string message = "FSM: The transition table of the machine cannot fold case.";
+					m_Logger.log(LoggerInfo::LL_ERROR, message);
+					throw InvalidStateMachineArgumentsException{ message };
+				}
+			}
+
+			// the table of a machine is never modified after construction, so lay it out for simulation right away
+			if constexpr (requires { m_TransitionFunc.freeze(); })
+				m_TransitionFunc.freeze();
 		
 		};
 
+		/**
+		 * @brief Copy constructor.
+		 * @details The transition function is copied; to make copying a machine cheap, hold its table through a SharedTable.
+		 */
+		FiniteStateMachine(const FiniteStateMachine&) = default;
+		/**
+		 * @brief Move constructor. The transition function is moved rather than copied.
+		 */
+		FiniteStateMachine(FiniteStateMachine&&) = default;
+
 		/**
 		 * @brief Copy operator for the state machine.
 		 * @param[in] rhs The right hand side (right argument) of the copy operator.
@@ -412,12 +580,29 @@ namespace m0st4fa::fsm {
 			return *this;
 		}
 
+		/**
+		 * @brief Move operator for the state machine.
+		 * @param[in] rhs The right hand side (right argument) of the move operator, whose transition function and final states are moved from.
+		 * @return A reference to the state machine after assignment.
+		 */
+		FiniteStateMachine& operator=(FiniteStateMachine&& rhs) noexcept(std::is_nothrow_move_assignable_v<TransFuncT>) {
+			this->m_TransitionFunc = std::move(rhs.m_TransitionFunc);
+			this->m_Flags = rhs.m_Flags;
+			this->m_MachineType = rhs.m_MachineType;
+			this->m_FinalStates = std::move(rhs.m_FinalStates);
+
+			return *this;
+		}
+
 		//! @brief Gets the final states of the state machine.
 		const FSMStateSetType& getFinalStates() const { return m_FinalStates; };
 
 		//! @brief Gets the flags of the state machine.
 		FlagsType getFlags() const { return m_Flags; };
 
+		//! @brief Gets the transition function of the state machine.
+		const TransFuncT& getTransitionFunction() const { return m_TransitionFunc; };
+
 		//! @brief Gets the type of the state machine. For a DFA, the type is always `FSM_TYPE::MT_DFA`; for an NFA it varies.
 		FSM_TYPE getMachineType() const { return m_MachineType; };
 	};
@@ -447,6 +632,38 @@ namespace m0st4fa::fsm {
 	private:
 		mutable VecType m_Table;
 
+		/**
+		 * @brief The contiguous (frozen) layout of the table, used by simulation.
+		 * @details The states that `state` is mapped to on `input` are stored back to back in `m_Targets`, within the range `[m_Offsets[cell], m_Offsets[cell + 1])`, where `cell = state * m_Width + input`.
+		 * @see freeze() const
+		 */
+		mutable std::vector<size_t> m_Offsets;
+		//! @brief The target states of every table entry, stored contiguously. @see m_Offsets
+		mutable std::vector<FSMStateType> m_Targets;
+		//! @brief The number of rows of the table when it was last frozen.
+		mutable size_t m_Rows = 0;
+		//! @brief The length of the longest row of the table when it was last frozen.
+		mutable size_t m_Width = 0;
+
+		/**
+		 * @brief Whether the table has (possibly) been modified since it was last frozen, and the mutex that rebuilding the layout from constant member functions is guarded by.
+		 * @details A copy of it starts with a mutex of its own, so that tables remain copyable.
+		 */
+		struct FreezeState {
+			std::atomic<bool> dirty = true;
+			std::mutex mutex{};
+
+			FreezeState() = default;
+			FreezeState(const FreezeState& rhs) : dirty{ rhs.dirty.load(std::memory_order_acquire) } {};
+			FreezeState& operator=(const FreezeState& rhs) {
+				dirty.store(rhs.dirty.load(std::memory_order_acquire), std::memory_order_release);
+				return *this;
+			}
+		};
+
+		//! @brief Whether the contiguous layout is stale. @see freeze() const
+		mutable FreezeState m_Freeze{};
+
 		std::vector<size_t> get_column_sizes() const {
 			std::vector<size_t> columnSizes{};
 			for (const auto& row : this->m_Table) {
@@ -538,48 +755,142 @@ namespace m0st4fa::fsm {
 		 */
 		template<typename InputT = char>
 		FSMStateSetType& operator()(const FSMStateType& state, const InputT input) noexcept(true) {
+			const size_t symbol = toSymbolIndex(input);
+
+			// the entry might be modified through the returned reference
+			m_Freeze.dirty.store(true, std::memory_order_relaxed);
 
 			if (m_Table.size() <= state)
 				m_Table.resize(state + 1);
 
 			std::vector<FSMStateSetType>& stateMap = m_Table.at(state);
 
-			if (stateMap.size() <= input)
-				stateMap.resize(input + 1);
+			if (stateMap.size() <= symbol)
+				stateMap.resize(symbol + 1);
 
-			return stateMap.at(input);
+			return stateMap.at(symbol);
 		}
 
 		/**
 		 * @brief Accesses the table entry indexed by `state` and `input`.
 		 * @param[in] state The state whose corresponding entry will be accessed.
 		 * @param[in] input The input (typically character) used to access the entry corresponding to a given state.
-		 * @return A constant reference to the table entry indexed by `state` and `input`.
+		 * @return A constant reference to the table entry indexed by `state` and `input`, which is empty if there is no such entry.
 		 */
 		template<typename InputT = char>
 		const FSMStateSetType& operator()(const FSMStateType& state, const InputT input) const noexcept(true) {
-			if (m_Table.size() <= state)
-				m_Table.resize(state + 1);
+			// the table is never modified through constant access, so that it can be shared among threads
+			static const FSMStateSetType emptyEntry{};
+			const size_t symbol = toSymbolIndex(input);
 
-			std::vector<FSMStateSetType>& stateMap = m_Table.at(state);
+			if (m_Table.size() <= state || m_Table[state].size() <= symbol)
+				return emptyEntry;
+
+			return m_Table[state][symbol];
+		}
+
+		/**
+		 * @brief Gets the states that `state` is mapped to on `input`, without copying them.
+		 * @details The states are read from the contiguous layout of the table, which is rebuilt first if the table has been modified since it was last frozen. It may be called from many threads at once (see freeze() const).
+		 * @param[in] state The state whose corresponding entry will be accessed.
+		 * @param[in] input The input (typically character) used to access the entry corresponding to `state`.
+		 * @return A view of the (sorted) states of the table entry indexed by `state` and `input`. The view is empty if there is no such entry, and it is invalidated once the table is modified.
+		 */
+		template<typename InputT = char>
+		std::span<const FSMStateType> targets(const FSMStateType state, const InputT input) const noexcept(true) {
+			if (m_Freeze.dirty.load(std::memory_order_acquire))
+				this->freeze();
+
+			const size_t symbol = toSymbolIndex(input);
+
+			if (state >= m_Rows || symbol >= m_Width)
+				return {};
+
+			const size_t cell = state * m_Width + symbol;
+			const FSMStateType* const first = m_Targets.data();
+
+			return { first + m_Offsets[cell], first + m_Offsets[cell + 1] };
+		}
+
+		/**
+		 * @brief Builds the contiguous layout of the table, which is used by targets() const.
+		 * @details Every row is padded to the length of the longest row, so that the entry of any (state, input) pair is found with a single multiplication. Calling this is only needed to build the layout ahead of time; otherwise, it is built lazily, by the first call to targets() const since the table was last modified. It does nothing if the layout is up to date.
+		 * Many threads may read a table at once through its constant member functions, whether it is frozen or not: the layout is rebuilt under a mutex, by whichever of them gets there first, and published to the others before they read it. Modifying a table while another thread reads it is a data race, as it is for standard containers.
+		 */
+		void freeze() const {
+			std::lock_guard lock{ m_Freeze.mutex };
+
+			// another thread may have rebuilt the layout while this one waited
+			if (!m_Freeze.dirty.load(std::memory_order_relaxed))
+				return;
+
+			m_Rows = m_Table.size();
+			m_Width = 0;
+			for (const auto& row : m_Table)
+				m_Width = std::max(m_Width, row.size());
+
+			m_Offsets.assign(m_Rows * m_Width + 1, 0);
+			m_Targets.clear();
 
-			if (stateMap.size() <= input)
-				stateMap.resize(input + 1);
+			for (size_t state = 0; state < m_Rows; state++) {
+				const StateSetVecType& row = m_Table[state];
 
-			// Impossible to throw an exception, as sizes of both dimensions have been already checked.
-			return stateMap.at(input);
+				for (size_t symbol = 0; symbol < m_Width; symbol++) {
+					if (symbol < row.size())
+						m_Targets.insert(m_Targets.end(), row[symbol].begin(), row[symbol].end());
+
+					m_Offsets[state * m_Width + symbol + 1] = m_Targets.size();
+				}
+			}
+
+			m_Freeze.dirty.store(false, std::memory_order_release);
+		}
+
+		/**
+		 * @brief Makes the table match ASCII letters regardless of their case.
+		 * @details The entries of every state on each letter and on the same letter in the other case are merged, and the union is stored under both. Other symbols are left as they are.
+		 * @param[in] deterministic Whether the table belongs to a DFA, in which case merging two entries that lead to different states is an error.
+		 * @throw InvalidStateMachineArgumentsException Thrown if `deterministic` is `true` and a state leads to different states on the two cases of a letter.
+		 */
+		void foldCase(const bool deterministic = false) {
+			m_Freeze.dirty.store(true, std::memory_order_relaxed);
+
+			for (StateSetVecType& row : m_Table)
+				for (size_t lower = 'a'; lower <= 'z'; lower++) {
+					const size_t upper = lower - 'a' + 'A';
+
+					if (row.size() <= upper)
+						continue;
+
+					if (row.size() <= lower)
+						row.resize(lower + 1);
+
+					FSMStateSetType& lowerEntry = row[lower];
+					FSMStateSetType& upperEntry = row[upper];
+					lowerEntry.insert(upperEntry.begin(), upperEntry.end());
+
+					if (deterministic && lowerEntry.size() > 1) {
+						const std::string message = "FSMTable: Folding case would make the table of a DFA non-deterministic.";
+						logger.log(LoggerInfo::LL_ERROR, message);
+						throw InvalidStateMachineArgumentsException{ message };
+					}
+
+					upperEntry = lowerEntry;
+				}
 		}
 
 		/**
 		 * @brief Accesses the set of states corresponding to `state` (on all of its characters).
 		 * @param[in] state The state used to index the table.
-		 * @return A *vector* of *sets of states*. `state` is mapped to each set of states in this vector via some input character (you can get the set of states corresponding to a given input (assuming it exists) by indexing the vector).
+		 * @return A *vector* of *sets of states*. `state` is mapped to each set of states in this vector via some input character (you can get the set of states corresponding to a given input (assuming it exists) by indexing the vector). The vector is empty if `state` has no row.
 		 */
 		const StateSetVecType& operator[](const FSMStateType& state) const {
+			static const StateSetVecType emptyRow{};
+
 			if (m_Table.size() <= state)
-				m_Table.resize(state + 1);
+				return emptyRow;
 
-			return m_Table.at(state);
+			return m_Table[state];
 		}
 
 		/**
@@ -593,10 +904,7 @@ namespace m0st4fa::fsm {
 		 * @brief Same as operator[](const FSMStateType& state) const.
 		 */
 		const StateSetVecType& at(const FSMStateType& state) const {
-			if (m_Table.size() <= state)
-				m_Table.resize(state + 1);
-
-			return m_Table.at(state);
+			return this->operator[](state);
 		}
 
 		template<typename InputT>
@@ -604,6 +912,7 @@ namespace m0st4fa::fsm {
 
 		//! @return Iterator to the beginning.
 		ItType begin() {
+			m_Freeze.dirty.store(true, std::memory_order_relaxed);
 			return m_Table.begin();
 		}
 		//! @return Constant iterator to the beginning.
@@ -613,6 +922,7 @@ namespace m0st4fa::fsm {
 
 		//! @return Iterator to the end.
 		ItType end() {
+			m_Freeze.dirty.store(true, std::memory_order_relaxed);
 			return m_Table.end();
 		}
 		//! @return Constant iterator the end.
@@ -682,9 +992,34 @@ namespace m0st4fa::fsm {
 		 */
 		Indicies indicies;
 		/**
-		 * @brief The input string that the simulation was performed against.
+		 * @brief The input string that the simulation was performed against (empty if the input was not a string of `char`s).
+		 */
+		std::string_view input;
+		/**
+		 * @brief The number of matches counted by a FSM_MODE::MM_COUNT or FSM_MODE::MM_COUNT_ENDS simulation; 0 for the other modes.
 		 */
-		const std::string_view input;
+		size_t count = 0;
+
+		// CONSTRUCTORS
+		/**
+		 * @brief Default constructor. The constructed result is a rejection.
+		 */
+		FSMResult() = default;
+		/**
+		 * @brief Initialize a new result.
+		 * @param[in] accepted Whether the string was accepted.
+		 * @param[in] finalState The final states used for the simulation.
+		 * @param[in] indicies The indicies of the accepting string, if any.
+		 * @param[in] input The input that the simulation was performed against; it is kept only if it is a string of `char`s.
+		 * @param[in] count The number of matches counted, if any.
+		 */
+		template <typename InputT>
+		FSMResult(const bool accepted, FSMStateSetType finalState, const Indicies indicies, const InputT& input, const size_t count = 0) :
+			accepted{ accepted }, finalState{ std::move(finalState) }, indicies{ indicies }, count{ count }
+		{
+			if constexpr (std::is_convertible_v<const InputT&, std::string_view>)
+				this->input = input;
+		}
 
 		// UTILITY FUNCTIONS
 		/**
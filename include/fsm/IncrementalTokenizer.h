@@ -0,0 +1,226 @@
+#pragma once
+
+#include <algorithm>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "DFA.h"
+
+// DECLARATIONS
+namespace m0st4fa::fsm {
+
+	/**
+	 * @brief A token found by IncrementalTokenizer.
+	 */
+	struct Token {
+		//! @brief The indicies of the token within the text.
+		Indicies indicies;
+		//! @brief The final state reached at the end of the token, which tells its kind; the dead state for a byte that begins no token.
+		FSMStateType state = 0;
+		//! @brief The index after the last byte examined to find the token (one past the end of the text if the machine was still alive there).
+		IndexType scanEnd = 0;
+
+		/**
+		 * @brief Compares this Token object with another for equality.
+		 */
+		bool operator==(const Token&) const = default;
+	};
+
+	/**
+	 * @brief The tokens replaced by an edit.
+	 * @see IncrementalTokenizer::edit
+	 */
+	struct TokenEdit {
+		//! @brief The index of the first token that was re-lexed.
+		size_t first = 0;
+		//! @brief The number of old tokens that were removed.
+		size_t removedCount = 0;
+		//! @brief The number of new tokens that took their place.
+		size_t insertedCount = 0;
+	};
+
+	/**
+	 * @brief Splits a text into tokens using a DFA, and keeps them up to date as the text is edited.
+	 * @details Tokens are found by maximal munch: each token is the longest non-empty prefix of the rest of the text that the DFA accepts; a byte that begins no token becomes a token of its own, whose state is the dead state. Every token begins in the start state, so a token depends only on the bytes from its start to its scan end.
+	 * After an edit, only the tokens whose scan reached into the edited range are re-lexed, from the first of them onwards, until a new token ends exactly where an old token after the edit begins; from there on, the old tokens are reused (shifted by the change in length). This makes re-lexing proportional to the size of the edit rather than to the size of the text.
+	 * @note The machine must outlive the tokenizer.
+	 */
+	template <typename DFAT>
+	class IncrementalTokenizer {
+
+		//! @brief The machine that recognizes the tokens.
+		const DFAT* m_Machine = nullptr;
+		//! @brief The text being tokenized.
+		std::string m_Text{};
+		//! @brief The tokens of the text, in order.
+		std::vector<Token> m_Tokens{};
+		//! @brief The largest number of bytes that any token has been scanned past its end.
+		IndexType m_MaxLookahead = 0;
+
+		Token _lex_token(const IndexType);
+		size_t _first_affected_token(const IndexType) const;
+
+	public:
+
+		IncrementalTokenizer(const DFAT&, std::string);
+
+		TokenEdit edit(const IndexType, const IndexType, std::string_view);
+
+		//! @brief Gets the text being tokenized.
+		const std::string& getText() const { return m_Text; };
+
+		//! @brief Gets the tokens of the text, in order.
+		const std::vector<Token>& getTokens() const { return m_Tokens; };
+
+		//! @brief Gets the text of `token`.
+		std::string_view getLexeme(const Token& token) const {
+			return std::string_view{ m_Text }.substr(token.indicies.start, token.indicies.end - token.indicies.start);
+		}
+
+	};
+
+}
+
+// IMPLEMENTATIONS
+namespace m0st4fa::fsm {
+
+	/**
+	 * @brief Initialize a new tokenizer and tokenize `text`.
+	 * @param[in] machine The DFA that recognizes the tokens; its final states tell the kinds of the tokens.
+	 * @param[in] text The text to tokenize.
+	 */
+	template <typename DFAT>
+	IncrementalTokenizer<DFAT>::IncrementalTokenizer(const DFAT& machine, std::string text) :
+		m_Machine{ &machine }, m_Text{ std::move(text) }
+	{
+		for (IndexType pos = 0; pos < m_Text.size(); pos = m_Tokens.back().indicies.end)
+			m_Tokens.push_back(this->_lex_token(pos));
+	}
+
+	/**
+	 * @brief Finds the token that begins at `pos`.
+	 */
+	template <typename DFAT>
+	Token IncrementalTokenizer<DFAT>::_lex_token(const IndexType pos)
+	{
+		constexpr FSMStateType deadState = DFAT::getDeadState();
+		const auto& tranFn = m_Machine->getTransitionFunction();
+
+		Token token{ { pos, pos }, deadState, pos };
+		FSMStateType state = DFAT::getStartState();
+		IndexType charIndex = pos;
+
+		// follow the text until the machine dies, remembering the last final state
+		while (charIndex < m_Text.size()) {
+			state = tranFn.nextState(state, m_Text[charIndex++]);
+
+			if (state == deadState)
+				break;
+
+			if (m_Machine->getFinalStates().contains(state)) {
+				token.indicies.end = charIndex;
+				token.state = state;
+			}
+		}
+
+		// the machine was still alive at the end of the text, so appending to the text might extend the token
+		token.scanEnd = state != deadState ? m_Text.size() + 1 : charIndex;
+
+		// a byte that begins no token is a token of its own
+		if (token.indicies.end == pos) {
+			token.indicies.end = pos + 1;
+			token.state = deadState;
+			token.scanEnd = std::max(token.scanEnd, pos + 1);
+		}
+
+		m_MaxLookahead = std::max(m_MaxLookahead, token.scanEnd - token.indicies.end);
+
+		return token;
+	}
+
+	/**
+	 * @brief Finds the first token whose scan reached the byte at `pos` (or the end of the text, if `pos` is there).
+	 * @return The index of the token, or the number of tokens if there is none.
+	 */
+	template <typename DFAT>
+	size_t IncrementalTokenizer<DFAT>::_first_affected_token(const IndexType pos) const
+	{
+		// the first token that ends after `pos` is affected, if any is
+		size_t first = std::upper_bound(m_Tokens.begin(), m_Tokens.end(), pos, [](const IndexType p, const Token& token) {
+			return p < token.indicies.end;
+			}) - m_Tokens.begin();
+
+		// earlier tokens are affected if they were scanned past `pos`; no token ending more than m_MaxLookahead bytes before `pos` can have been
+		for (size_t i = first; i-- > 0 && m_Tokens[i].indicies.end + m_MaxLookahead > pos; )
+			if (m_Tokens[i].scanEnd > pos)
+				first = i;
+
+		return first;
+	}
+
+	/**
+	 * @brief Replaces the bytes `[start, end)` of the text with `replacement` and updates the tokens.
+	 * @param[in] start The index of the first byte replaced.
+	 * @param[in] end The index after the last byte replaced.
+	 * @param[in] replacement The bytes that take their place.
+	 * @return The tokens that were replaced; the tokens after them are unchanged, other than being shifted.
+	 * @throw InvalidStateMachineArgumentsException Thrown if `[start, end)` is not a range of the text.
+	 */
+	template <typename DFAT>
+	TokenEdit IncrementalTokenizer<DFAT>::edit(const IndexType start, const IndexType end, std::string_view replacement)
+	{
+		if (start > end || end > m_Text.size()) {
+			const std::string message = "IncrementalTokenizer: The edited range is out of the text.";
+			Logger{}.log(LoggerInfo::LL_ERROR, message);
+			throw InvalidStateMachineArgumentsException{ message };
+		}
+
+		m_Text.replace(start, end - start, replacement);
+
+		// the change in length, which old positions after the edit are shifted by
+		const std::ptrdiff_t delta = static_cast<std::ptrdiff_t>(replacement.size()) - static_cast<std::ptrdiff_t>(end - start);
+		const IndexType newEnd = start + replacement.size();
+
+		const size_t first = this->_first_affected_token(start);
+		size_t resync = first;
+		std::vector<Token> newTokens{};
+
+		IndexType pos = first < m_Tokens.size() ? m_Tokens[first].indicies.start : (m_Tokens.empty() ? 0 : m_Tokens.back().indicies.end);
+
+		while (pos < m_Text.size()) {
+			// once past the edit, stop at the first old token that begins where the new ones end
+			if (pos >= newEnd) {
+				const IndexType oldPos = static_cast<IndexType>(pos - delta);
+
+				while (resync < m_Tokens.size() && m_Tokens[resync].indicies.start < oldPos)
+					resync++;
+
+				if (resync < m_Tokens.size() && m_Tokens[resync].indicies.start == oldPos)
+					break;
+			}
+
+			newTokens.push_back(this->_lex_token(pos));
+			pos = newTokens.back().indicies.end;
+		}
+
+		// no old token was reused
+		if (pos >= m_Text.size())
+			resync = m_Tokens.size();
+
+		// shift the reused tokens, then splice the new tokens in place of the replaced ones
+		for (size_t i = resync; i < m_Tokens.size(); i++) {
+			Token& token = m_Tokens[i];
+			token.indicies = Indicies{ token.indicies.start + delta, token.indicies.end + delta };
+			token.scanEnd += delta;
+		}
+
+		const TokenEdit res{ first, resync - first, newTokens.size() };
+
+		m_Tokens.erase(m_Tokens.begin() + first, m_Tokens.begin() + resync);
+		m_Tokens.insert(m_Tokens.begin() + first, newTokens.begin(), newTokens.end());
+
+		return res;
+	}
+
+}
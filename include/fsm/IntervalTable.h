@@ -0,0 +1,236 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <vector>
+
+#include "FiniteStateMachine.h"
+
+// DECLARATIONS
+namespace m0st4fa::fsm {
+
+	/**
+	 * @brief The transitions of a state on an inclusive range of symbols.
+	 * @see IntervalTable
+	 */
+	struct IntervalTransition {
+		//! @brief The state that the transitions leave.
+		FSMStateType state = 0;
+		//! @brief The first symbol of the range.
+		std::uint32_t first = 0;
+		//! @brief The last symbol of the range.
+		std::uint32_t last = 0;
+		//! @brief The states that the transitions lead to (one for DFAs).
+		std::vector<FSMStateType> targets{};
+	};
+
+	/**
+	 * @brief A transition table that stores the transitions of each state as sorted ranges of symbols, for machines over large alphabets (e.g. streams of token IDs).
+	 * @details Its memory is proportional to the number of ranges rather than to the size of the alphabet. The range that holds a symbol is found by a branch-free binary search over the first symbols of the ranges of the state; states whose ranges all lie within DIRECT_INDEX_LIMIT symbols are instead looked up directly in an array covering that window. Each range may lead to many states, so the table serves NFAs as well as DFAs; for epsilon NFAs, symbol 0 stands for epsilon, as it does in FSMTable.
+	 * It can be used in place of FSMTable by TransitionFunction (e.g. `DeterFiniteAutomaton<TransFn<IntervalTable>, std::span<const std::uint32_t>>`).
+	 */
+	class IntervalTable {
+	public:
+		//! @brief The type of the symbols that the table recognizes.
+		using SymbolType = std::uint32_t;
+
+		//! @brief The maximum number of symbols spanned by the ranges of a state for it to be indexed directly.
+		static constexpr size_t DIRECT_INDEX_LIMIT = 64;
+
+		//! @brief Stands for the absence of a range holding a symbol.
+		static constexpr std::uint32_t NO_RANGE = std::numeric_limits<std::uint32_t>::max();
+
+	private:
+		//! @brief The index of the first range of each state, indexed by the state (with one more entry for the end of the last state).
+		std::vector<std::uint32_t> m_RowOffsets{ 0 };
+		//! @brief The first symbol of each range.
+		std::vector<SymbolType> m_Firsts{};
+		//! @brief The last symbol of each range.
+		std::vector<SymbolType> m_Lasts{};
+		//! @brief The index of the first target of each range (with one more entry for the end of the last range).
+		std::vector<std::uint32_t> m_TargetOffsets{ 0 };
+		//! @brief The targets of all ranges.
+		std::vector<FSMStateType> m_Targets{};
+		//! @brief The index of the direct window of each state within `m_Direct` (with one more entry); states with an empty window are searched instead.
+		std::vector<std::uint32_t> m_DirectOffsets{ 0 };
+		//! @brief The range holding each symbol of the windows of the states that are indexed directly (from their first symbol on), or NO_RANGE.
+		std::vector<std::uint32_t> m_Direct{};
+
+		std::uint32_t _find(const FSMStateType, const size_t) const noexcept;
+
+	public:
+
+		//! @brief Default constructor. The constructed table maps every state to the dead state.
+		IntervalTable() = default;
+
+		explicit IntervalTable(std::vector<IntervalTransition>);
+
+		/**
+		 * @brief Gets the states that `state` is mapped to on `input`, as a view.
+		 * @see FSMTable::targets(const FSMStateType state, const InputT input) const
+		 */
+		template<typename InputT = char>
+		std::span<const FSMStateType> targets(const FSMStateType state, const InputT input) const noexcept(true) {
+			const std::uint32_t range = this->_find(state, toSymbolIndex(input));
+
+			if (range == NO_RANGE)
+				return {};
+
+			return { m_Targets.data() + m_TargetOffsets[range], m_TargetOffsets[range + 1] - m_TargetOffsets[range] };
+		}
+
+		/**
+		 * @brief Gets the state that `state` is mapped to on `input`.
+		 * @return The first state that `state` is mapped to, or the dead state if there is none.
+		 */
+		template<typename InputT = char>
+		FSMStateType nextState(const FSMStateType state, const InputT input) const noexcept(true) {
+			const std::span<const FSMStateType> res = this->targets(state, input);
+
+			return res.empty() ? FSMStateType{} : res.front();
+		}
+
+		/**
+		 * @brief Accesses the table entry indexed by `state` and `input`.
+		 * @return A copy of the table entry indexed by `state` and `input`.
+		 */
+		template<typename InputT = char>
+		FSMStateSetType operator()(const FSMStateType state, const InputT input) const noexcept(true) {
+			FSMStateSetType res{};
+
+			for (const FSMStateType target : this->targets(state, input))
+				res.insert(target);
+
+			return res;
+		}
+
+		//! @brief Does nothing; the table is always laid out for simulation. @see FSMTable::freeze() const
+		void freeze() const {};
+
+		//! @brief Gets the number of rows (states) of the table.
+		size_t size() const {
+			return m_RowOffsets.size() - 1;
+		}
+
+		//! @brief Gets the number of ranges of the table.
+		size_t getRangeCount() const {
+			return m_Firsts.size();
+		}
+
+		//! @brief Checks whether `state` is looked up directly rather than searched.
+		bool isDirectlyIndexed(const FSMStateType state) const {
+			return state < this->size() && m_DirectOffsets[state] != m_DirectOffsets[state + 1];
+		}
+
+		//! @brief Gets the size of the table, in bytes.
+		size_t getSizeInBytes() const {
+			return (m_RowOffsets.size() + m_TargetOffsets.size() + m_DirectOffsets.size() + m_Direct.size()) * sizeof(std::uint32_t) +
+				(m_Firsts.size() + m_Lasts.size()) * sizeof(SymbolType) + m_Targets.size() * sizeof(FSMStateType);
+		}
+
+	};
+
+}
+
+// IMPLEMENTATIONS
+namespace m0st4fa::fsm {
+
+	/**
+	 * @brief Initialize a new table out of the transitions of its states on ranges of symbols.
+	 * @param[in] transitions The transitions, in any order. The ranges of the same state must not overlap.
+	 * @throw InvalidStateMachineArgumentsException Thrown if a range is empty or overlaps another range of the same state.
+	 */
+	inline IntervalTable::IntervalTable(std::vector<IntervalTransition> transitions)
+	{
+		std::sort(transitions.begin(), transitions.end(), [](const IntervalTransition& lhs, const IntervalTransition& rhs) {
+			return lhs.state != rhs.state ? lhs.state < rhs.state : lhs.first < rhs.first;
+			});
+
+		size_t stateCount = 0;
+
+		for (size_t i = 0; i < transitions.size(); i++) {
+			const IntervalTransition& transition = transitions[i];
+			const bool overlaps = i && transitions[i - 1].state == transition.state && transitions[i - 1].last >= transition.first;
+
+			if (transition.first > transition.last || overlaps) {
+				const std::string message = "IntervalTable: The ranges of a state must be non-empty and must not overlap.";
+				Logger{}.log(LoggerInfo::LL_ERROR, message);
+				throw InvalidStateMachineArgumentsException{ message };
+			}
+
+			stateCount = std::max<size_t>(stateCount, size_t{ transition.state } + 1);
+			for (const FSMStateType target : transition.targets)
+				stateCount = std::max<size_t>(stateCount, size_t{ target } + 1);
+		}
+
+		m_RowOffsets.assign(stateCount + 1, 0);
+		m_DirectOffsets.assign(stateCount + 1, 0);
+
+		for (const IntervalTransition& transition : transitions) {
+			m_RowOffsets[transition.state + 1]++;
+			m_Firsts.push_back(transition.first);
+			m_Lasts.push_back(transition.last);
+			m_Targets.insert(m_Targets.end(), transition.targets.begin(), transition.targets.end());
+			m_TargetOffsets.push_back(static_cast<std::uint32_t>(m_Targets.size()));
+		}
+
+		for (size_t state = 0; state < stateCount; state++)
+			m_RowOffsets[state + 1] += m_RowOffsets[state];
+
+		// index the states whose ranges lie within a small window directly
+		for (size_t state = 0; state < stateCount; state++) {
+			const std::uint32_t begin = m_RowOffsets[state], end = m_RowOffsets[state + 1];
+
+			if (end - begin > 1 && size_t{ m_Lasts[end - 1] } - m_Firsts[begin] < DIRECT_INDEX_LIMIT) {
+				const SymbolType windowStart = m_Firsts[begin];
+				const size_t windowStartIndex = m_Direct.size();
+
+				m_Direct.resize(windowStartIndex + (m_Lasts[end - 1] - windowStart + 1), NO_RANGE);
+
+				for (std::uint32_t range = begin; range < end; range++)
+					std::fill(m_Direct.begin() + windowStartIndex + (m_Firsts[range] - windowStart), m_Direct.begin() + windowStartIndex + (m_Lasts[range] - windowStart + 1), range);
+			}
+
+			m_DirectOffsets[state + 1] = static_cast<std::uint32_t>(m_Direct.size());
+		}
+	}
+
+	/**
+	 * @brief Finds the range of `state` that holds `symbol`.
+	 * @return The index of the range, or NO_RANGE if there is none.
+	 */
+	inline std::uint32_t IntervalTable::_find(const FSMStateType state, const size_t symbol) const noexcept
+	{
+		if (state >= this->size())
+			return NO_RANGE;
+
+		const std::uint32_t begin = m_RowOffsets[state], end = m_RowOffsets[state + 1];
+
+		if (begin == end || symbol < m_Firsts[begin])
+			return NO_RANGE;
+
+		// the window of a state that is indexed directly begins at its first symbol
+		if (const std::uint32_t directBegin = m_DirectOffsets[state], directEnd = m_DirectOffsets[state + 1]; directBegin != directEnd) {
+			const size_t offset = symbol - m_Firsts[begin];
+
+			return offset < directEnd - directBegin ? m_Direct[directBegin + offset] : NO_RANGE;
+		}
+
+		// find the last range that begins at or before the symbol; the loop has no branch other than its condition
+		const SymbolType* first = m_Firsts.data() + begin;
+		size_t count = end - begin;
+
+		while (count > 1) {
+			const size_t half = count / 2;
+			first = first[half] <= symbol ? first + half : first;
+			count -= half;
+		}
+
+		const std::uint32_t range = static_cast<std::uint32_t>(first - m_Firsts.data());
+
+		return symbol <= m_Lasts[range] ? range : NO_RANGE;
+	}
+
+}
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <string_view>
+#include <vector>
+
+#include "ByteSearch.h"
+#include "FiniteStateMachine.h"
+
+// DECLARATIONS
+namespace m0st4fa::fsm {
+
+	/**
+	 * @brief A line of a buffer that contains a match.
+	 * @see forEachMatchingLine
+	 */
+	struct MatchingLine {
+		//! @brief The number of the line, counting from 1 (as `grep -n` does).
+		size_t number = 0;
+		//! @brief The indicies of the line within the buffer, without its newline.
+		Indicies indicies;
+
+		/**
+		 * @brief Compares this MatchingLine object with another for equality.
+		 */
+		bool operator==(const MatchingLine&) const = default;
+	};
+
+	template <typename MachineT, typename CallbackT>
+	size_t forEachMatchingLine(const MachineT&, std::string_view, CallbackT&&);
+
+	template <typename MachineT>
+	std::vector<MatchingLine> findMatchingLines(const MachineT&, std::string_view);
+
+	template <typename MachineT>
+	size_t countMatchingLines(const MachineT&, std::string_view);
+
+}
+
+// IMPLEMENTATIONS
+namespace m0st4fa::fsm {
+
+	/**
+	 * @brief Finds the lines of a buffer of newline-delimited lines that contain a match of a machine (as `grep` does), calling `onLine` with each of them, in order.
+	 * @details Rather than simulating the machine line by line, the machine is run unanchored (see FSM_MODE::MM_ANY_MATCH) over the rest of the buffer at once, so the prefilter skips whole runs of lines that cannot match. The line where the first match ends is then found with a vectorized search for newlines (see countByte()), and checked on its own, since the match may have begun on an earlier line. Either way, the search resumes after that line, so the rest of a line that has matched is never read.
+	 * A line is a run of bytes ended by a newline (`'\n'`) or by the end of the buffer; a buffer ending with a newline has no empty last line.
+	 * @param[in] machine The machine (a DFA or an NFA over `std::string_view`) whose matches are looked for.
+	 * @param[in] buffer The lines.
+	 * @param[in] onLine Called with the MatchingLine of each line that contains a match.
+	 * @return The number of lines that contain a match.
+	 */
+	template <typename MachineT, typename CallbackT>
+	size_t forEachMatchingLine(const MachineT& machine, std::string_view buffer, CallbackT&& onLine)
+	{
+		const char* const data = buffer.data();
+		const char* const last = data + buffer.size();
+
+		size_t matchCount = 0;
+		// the line at `lineStart` is numbered `lineNumber`
+		size_t lineNumber = 1;
+		IndexType lineStart = 0;
+
+		while (lineStart < buffer.size()) {
+			const FSMResult res = machine.simulate(buffer.substr(lineStart), FSM_MODE::MM_ANY_MATCH);
+
+			if (!res.accepted)
+				break;
+
+			// find the line that holds the last byte of the match (or the empty match)
+			const IndexType matchLast = lineStart + (res.indicies.end ? res.indicies.end - 1 : 0);
+			const char* const matchLineStart = [&]() {
+				for (const char* p = data + matchLast; p > data + lineStart; p--)
+					if (p[-1] == '\n')
+						return p;
+
+				return data + lineStart;
+			}();
+
+			lineNumber += countByte(data + lineStart, matchLineStart, '\n');
+
+			const char* const matchLineEnd = findByte(matchLineStart, last, '\n');
+			const std::string_view line{ matchLineStart, static_cast<size_t>(matchLineEnd - matchLineStart) };
+
+			// the match may have begun on an earlier line; if so, no match ends earlier, so the earlier lines hold none
+			if ((matchLineStart == data + lineStart && line.size() >= res.indicies.end) || machine.simulate(line, FSM_MODE::MM_ANY_MATCH).accepted) {
+				const IndexType start = matchLineStart - data;
+
+				matchCount++;
+				onLine(MatchingLine{ lineNumber, Indicies{ start, start + line.size() } });
+			}
+
+			lineStart = matchLineEnd - data + 1;
+			lineNumber++;
+		}
+
+		return matchCount;
+	}
+
+	/**
+	 * @brief Finds the lines of a buffer that contain a match of a machine.
+	 * @see forEachMatchingLine
+	 */
+	template <typename MachineT>
+	std::vector<MatchingLine> findMatchingLines(const MachineT& machine, std::string_view buffer)
+	{
+		std::vector<MatchingLine> res{};
+
+		forEachMatchingLine(machine, buffer, [&res](const MatchingLine& line) { res.push_back(line); });
+
+		return res;
+	}
+
+	/**
+	 * @brief Counts the lines of a buffer that contain a match of a machine (as `grep -c` does).
+	 * @see forEachMatchingLine
+	 */
+	template <typename MachineT>
+	size_t countMatchingLines(const MachineT& machine, std::string_view buffer)
+	{
+		return forEachMatchingLine(machine, buffer, [](const MatchingLine&) {});
+	}
+
+}
@@ -0,0 +1,328 @@
+#pragma once
+
+#include <algorithm>
+#include <coroutine>
+#include <deque>
+#include <exception>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "FiniteStateMachine.h"
+
+// DECLARATIONS
+namespace m0st4fa::fsm {
+
+	/**
+	 * @brief A coroutine that lazily produces the matches found in a stream, as they complete.
+	 * @details The generator is started by the first `co_await next()`, and runs until it finds a match, which it hands to the awaiting coroutine, or until it awaits input that is not there yet, in which case both stay suspended until the source resumes the generator. Control is handed back and forth by symmetric transfer, so a single thread can drive any number of generators from an event loop, without a thread, or even a stack, per stream.
+	 * @see findMatches
+	 */
+	class MatchGenerator {
+	public:
+
+		/**
+		 * @brief The promise of the coroutine, as required by the language.
+		 */
+		struct promise_type {
+			//! @brief The match last yielded, if any.
+			std::optional<Indicies> current{};
+			//! @brief The coroutine awaiting the next match, if any.
+			std::coroutine_handle<> consumer{};
+			//! @brief The exception that ended the coroutine, if any.
+			std::exception_ptr exception{};
+
+			/**
+			 * @brief Suspends the generator and resumes the coroutine awaiting the next match (if there is none, the generator returns to whoever resumed it).
+			 */
+			struct ResumeConsumer {
+				bool await_ready() const noexcept { return false; }
+
+				std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> handle) const noexcept {
+					const std::coroutine_handle<> consumer = std::exchange(handle.promise().consumer, {});
+					return consumer ? consumer : std::noop_coroutine();
+				}
+
+				void await_resume() const noexcept {}
+			};
+
+			MatchGenerator get_return_object() noexcept { return MatchGenerator{ std::coroutine_handle<promise_type>::from_promise(*this) }; }
+			std::suspend_always initial_suspend() const noexcept { return {}; }
+			ResumeConsumer final_suspend() const noexcept { return {}; }
+			ResumeConsumer yield_value(const Indicies indicies) noexcept { current = indicies; return {}; }
+			void return_void() noexcept { current.reset(); }
+			void unhandled_exception() noexcept { current.reset(); exception = std::current_exception(); }
+		};
+
+	private:
+		//! @brief The coroutine, owned by this object.
+		std::coroutine_handle<promise_type> m_Handle{};
+
+	public:
+
+		//! @brief Default constructor. The constructed generator has finished.
+		MatchGenerator() = default;
+
+		//! @brief Initialize a new generator, which takes ownership of `handle`.
+		explicit MatchGenerator(const std::coroutine_handle<promise_type> handle) noexcept : m_Handle{ handle } {};
+
+		MatchGenerator(const MatchGenerator&) = delete;
+		MatchGenerator& operator=(const MatchGenerator&) = delete;
+
+		//! @brief Move constructor.
+		MatchGenerator(MatchGenerator&& rhs) noexcept : m_Handle{ std::exchange(rhs.m_Handle, {}) } {};
+
+		//! @brief Move assignment operator.
+		MatchGenerator& operator=(MatchGenerator&& rhs) noexcept {
+			if (this != &rhs) {
+				if (m_Handle)
+					m_Handle.destroy();
+
+				m_Handle = std::exchange(rhs.m_Handle, {});
+			}
+
+			return *this;
+		}
+
+		//! @brief Destroys the coroutine, wherever it is suspended.
+		~MatchGenerator() {
+			if (m_Handle)
+				m_Handle.destroy();
+		}
+
+		/**
+		 * @brief Gets the next match, to be awaited by a coroutine (e.g. `while (auto match = co_await generator.next())`).
+		 * @details The generator is resumed, and the awaiting coroutine is resumed once a match is found or the stream ends. Awaiting again before the previous await has completed is undefined.
+		 * @return An awaitable whose result is the indicies of the next match (within the whole stream), or nothing once the stream has ended.
+		 * @throw Rethrows the exception that ended the generator, if any (e.g. one thrown by the source).
+		 */
+		auto next() noexcept {
+			struct Awaiter {
+				std::coroutine_handle<promise_type> handle;
+
+				bool await_ready() const noexcept { return !handle || handle.done(); }
+
+				std::coroutine_handle<> await_suspend(const std::coroutine_handle<> consumer) const noexcept {
+					handle.promise().consumer = consumer;
+					return handle;
+				}
+
+				std::optional<Indicies> await_resume() const {
+					if (!handle)
+						return std::nullopt;
+
+					if (handle.promise().exception)
+						std::rethrow_exception(handle.promise().exception);
+
+					return handle.done() ? std::nullopt : handle.promise().current;
+				}
+			};
+
+			return Awaiter{ m_Handle };
+		}
+
+		//! @brief Checks whether the generator has finished (the stream has ended, or an exception was thrown).
+		bool isDone() const {
+			return !m_Handle || m_Handle.done();
+		}
+
+	};
+
+	/**
+	 * @brief A single-threaded asynchronous source of chunks, fed by a producer (e.g. the callback of a pipe or of a decompressor).
+	 * @details A coroutine awaiting read() is suspended until a chunk is pushed or the channel is closed, and is then resumed inline, from within push() or close(); chunks pushed while no coroutine is waiting are queued.
+	 * @see findMatches
+	 */
+	class ChunkChannel {
+
+		//! @brief The chunks pushed but not read yet.
+		std::deque<std::string> m_Chunks{};
+		//! @brief The chunk last read, which the view returned by read() refers to.
+		std::string m_Current{};
+		//! @brief The coroutine waiting for a chunk, if any.
+		std::coroutine_handle<> m_Reader{};
+		//! @brief Whether the producer has closed the channel.
+		bool m_Closed = false;
+
+		//! @brief Resumes the coroutine waiting for a chunk, if any.
+		void _wake() {
+			if (m_Reader)
+				std::exchange(m_Reader, {}).resume();
+		}
+
+	public:
+
+		//! @brief Default constructor. The constructed channel is open and empty.
+		ChunkChannel() = default;
+
+		ChunkChannel(const ChunkChannel&) = delete;
+		ChunkChannel& operator=(const ChunkChannel&) = delete;
+
+		/**
+		 * @brief Reads the next chunk, to be awaited by a coroutine.
+		 * @return An awaitable whose result is a view of the next chunk, valid until the next read, or an empty view once the channel is closed and drained.
+		 */
+		auto read() noexcept {
+			struct Awaiter {
+				ChunkChannel& channel;
+
+				bool await_ready() const noexcept { return channel.m_Chunks.size() || channel.m_Closed; }
+				void await_suspend(const std::coroutine_handle<> reader) const noexcept { channel.m_Reader = reader; }
+
+				std::string_view await_resume() const {
+					if (channel.m_Chunks.empty())
+						return {};
+
+					channel.m_Current = std::move(channel.m_Chunks.front());
+					channel.m_Chunks.pop_front();
+
+					return channel.m_Current;
+				}
+			};
+
+			return Awaiter{ *this };
+		}
+
+		/**
+		 * @brief Pushes a chunk, resuming the coroutine waiting for one, if any. Empty chunks are ignored.
+		 * @throw InvalidStateMachineArgumentsException Thrown if the channel is closed.
+		 */
+		void push(std::string chunk) {
+			if (m_Closed) {
+				const std::string message = "ChunkChannel: Cannot push into a closed channel.";
+				Logger{}.log(LoggerInfo::LL_ERROR, message);
+				throw InvalidStateMachineArgumentsException{ message };
+			}
+
+			if (chunk.empty())
+				return;
+
+			m_Chunks.push_back(std::move(chunk));
+			this->_wake();
+		}
+
+		//! @brief Closes the channel, ending the stream, and resumes the coroutine waiting for a chunk, if any.
+		void close() {
+			m_Closed = true;
+			this->_wake();
+		}
+
+		//! @brief Checks whether a coroutine is waiting for a chunk.
+		bool isWaiting() const { return bool(m_Reader); };
+
+		//! @brief Gets the number of chunks pushed but not read yet.
+		size_t getPendingCount() const { return m_Chunks.size(); };
+
+	};
+
+	template <typename MachineT, typename SourceT>
+	MatchGenerator findMatches(const MachineT&, SourceT&);
+
+}
+
+// IMPLEMENTATIONS
+namespace m0st4fa::fsm {
+
+	/**
+	 * @brief Finds the matches of a DFA or an NFA within a stream of chunks produced asynchronously, yielding each one as soon as it is complete.
+	 * @details The matches are those counted by MM_COUNT: non-empty and non-overlapping, the longest at the leftmost position each time. A match is complete once the machine dies past its end (or the stream ends), so it is yielded as soon as the chunk that completes it has been read, however the matches and chunks are split.
+	 * The state of the machine is carried across chunks, and only the bytes from the beginning of the match being tried onwards are kept, so the memory of a stream is bounded by the longest prefix the machine is still alive on, not by the size of the stream.
+	 * @param[in] machine The machine whose matches are looked for. It must outlive the generator.
+	 * @param source The source of the chunks, which must outlive the generator. `co_await source.read()` must give a view of the next chunk (valid until the next read), or an empty view at the end of the stream (e.g. ChunkChannel).
+	 * @return The generator of the matches, whose indicies are relative to the beginning of the stream.
+	 */
+	template <typename MachineT, typename SourceT>
+	MatchGenerator findMatches(const MachineT& machine, SourceT& source)
+	{
+		constexpr FSMStateType startState = MachineT::getStartState();
+		constexpr FSMStateType deadState = MachineT::getDeadState();
+
+		const auto& tranFn = machine.getTransitionFunction();
+		const bool isDeterministic = machine.getMachineType() == FSM_TYPE::MT_DFA;
+		const bool calcClosure = machine.getMachineType() == FSM_TYPE::MT_EPSILON_NFA;
+
+		// the bytes from the beginning of the match being tried (at `head`) onwards
+		std::string buffer{};
+		size_t head = 0;
+		// the offset within the stream of the first byte of the buffer
+		IndexType bufferOffset = 0;
+
+		// the run of the machine from `head`: the states it is in, the bytes it has consumed and the end of its longest match (relative to `head`)
+		std::vector<FSMStateType> states{ startState }, next{};
+		size_t scanned = 0;
+		std::optional<size_t> end{};
+		bool isEndOfStream = false;
+
+		auto step = [&](const char c) {
+			next.clear();
+
+			if (isDeterministic) {
+				if (const FSMStateType state = tranFn.nextState(states.front(), c); state != deadState)
+					next.push_back(state);
+			}
+			else {
+				for (const FSMStateType state : states)
+					tranFn.forEachTarget(state, c, [&next](const FSMStateType target) { next.push_back(target); });
+
+				// extend the set to its epsilon closure
+				for (size_t i = 0; calcClosure && i < next.size(); i++)
+					tranFn.forEachTarget(next[i], '\0', [&next](const FSMStateType target) {
+					if (std::find(next.begin(), next.end(), target) == next.end())
+						next.push_back(target);
+						});
+
+				std::sort(next.begin(), next.end());
+				next.erase(std::unique(next.begin(), next.end()), next.end());
+			}
+
+			states.swap(next);
+		};
+
+		for (;;) {
+			while (head + scanned < buffer.size() || (isEndOfStream && head < buffer.size())) {
+				if (head + scanned < buffer.size()) {
+					step(buffer[head + scanned++]);
+
+					if (std::any_of(states.begin(), states.end(), [&machine](const FSMStateType state) { return machine.getFinalStates().contains(state); }))
+						end = scanned;
+
+					if (states.size())
+						continue;
+				}
+
+				// the machine has died (or the stream has ended): the match is complete, or none begins at `head`
+				const size_t consumed = end ? *end : 1;
+
+				if (end)
+					co_yield Indicies{ bufferOffset + head, bufferOffset + head + *end };
+
+				head += consumed;
+				states.assign(1, startState);
+				scanned = 0;
+				end.reset();
+			}
+
+			if (isEndOfStream)
+				co_return;
+
+			const std::string_view chunk = co_await source.read();
+
+			if (chunk.empty()) {
+				isEndOfStream = true;
+				continue;
+			}
+
+			// drop the bytes that no match can begin at any more, once they make up most of the buffer
+			if (head > buffer.size() / 2) {
+				buffer.erase(0, head);
+				bufferOffset += head;
+				head = 0;
+			}
+
+			buffer.append(chunk);
+		}
+	}
+
+}
@@ -0,0 +1,349 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <ranges>
+#include <string_view>
+
+#include "DFA.h"
+
+// DECLARATIONS
+namespace m0st4fa::fsm {
+
+	/**
+	 * @brief Runs many DFAs over bytes in lock-step over the same input, in a single pass.
+	 * @details The states reachable by each DFA are compiled into a dense table over byte classes that are shared by all the DFAs (two bytes share a class if no state of any DFA tells them apart). Each byte of the input is thus loaded and classified once, after which every DFA that is still alive takes a single table lookup; a DFA is dropped from the pass as soon as it reaches its dead state.
+	 * The results are the same as those of simulating each DFA on its own (including the states reported), which is useful when their product would be too large to build.
+	 * @see buildProductDFA
+	 */
+	class MultiDFARunner {
+
+		//! @brief The class of each byte.
+		std::array<std::uint8_t, 256> m_Classes{};
+		//! @brief The number of byte classes.
+		size_t m_ClassCount = 1;
+
+		//! @brief The index of the first (dead) state of each machine within the per-state arrays below; the last entry is their size.
+		std::vector<size_t> m_StateOffsets{ 0 };
+		//! @brief The next (local) state of each (state, class) pair, indexed by `(m_StateOffsets[machine] + state) * m_ClassCount + class`.
+		std::vector<FSMStateType> m_Transitions{};
+		//! @brief Whether each state is final, indexed by `m_StateOffsets[machine] + state`.
+		std::vector<bool> m_IsFinal{};
+		//! @brief The state of the original machine that each state corresponds to, indexed by `m_StateOffsets[machine] + state`.
+		std::vector<FSMStateType> m_OriginalStates{};
+
+		//! @brief The local state of every machine, and the machines that are still alive, reused across calls.
+		struct Run {
+			std::vector<FSMStateType> states;
+			std::vector<size_t> alive;
+		};
+
+		void _start(Run&) const;
+		std::vector<FSMResult> _simulate_whole_string(std::string_view) const;
+		std::vector<FSMResult> _simulate_longest_prefix(std::string_view) const;
+		std::vector<FSMResult> _simulate_longest_substring(std::string_view) const;
+		void _longest_prefixes(std::string_view, const IndexType, Run&, std::vector<std::optional<IndexType>>&, std::vector<FSMStateType>&) const;
+
+		//! @brief Gets the next local state of `machine` from its local `state` on a byte of class `byteClass`.
+		FSMStateType _next(const size_t machine, const FSMStateType state, const std::uint8_t byteClass) const {
+			return m_Transitions[(m_StateOffsets[machine] + state) * m_ClassCount + byteClass];
+		}
+
+		//! @brief Checks whether the local `state` of `machine` is final.
+		bool _is_final(const size_t machine, const FSMStateType state) const {
+			return m_IsFinal[m_StateOffsets[machine] + state];
+		}
+
+		//! @brief Gets the state of the original `machine` that its local `state` corresponds to.
+		FSMStateType _original(const size_t machine, const FSMStateType state) const {
+			return m_OriginalStates[m_StateOffsets[machine] + state];
+		}
+
+	public:
+
+		/**
+		 * @brief Default constructor. The constructed runner runs no machines.
+		 */
+		MultiDFARunner() = default;
+
+		template <std::ranges::forward_range RangeT>
+		explicit MultiDFARunner(const RangeT&);
+
+		std::vector<FSMResult> simulate(std::string_view, const FSM_MODE) const;
+
+		//! @brief Gets the number of machines run.
+		size_t getMachineCount() const { return m_StateOffsets.size() - 1; };
+
+		//! @brief Gets the number of byte classes shared by the machines.
+		size_t getClassCount() const { return m_ClassCount; };
+
+	};
+
+}
+
+// IMPLEMENTATIONS
+namespace m0st4fa::fsm {
+
+	/**
+	 * @brief Compiles the states reachable by each of `machines` into tables over shared byte classes.
+	 * @param[in] machines The DFAs to run, e.g. a `std::vector<DeterFiniteAutomaton<...>>`. Their results are reported in the same order.
+	 */
+	template <std::ranges::forward_range RangeT>
+	MultiDFARunner::MultiDFARunner(const RangeT& machines)
+	{
+		using DFAType = std::ranges::range_value_t<RangeT>;
+		constexpr FSMStateType deadState = DFAType::getDeadState();
+		constexpr FSMStateType startState = DFAType::getStartState();
+		constexpr size_t alphabetSize = 256;
+
+		// the next local state of each local state on each byte, of all machines, indexed by `(m_StateOffsets[machine] + state) * alphabetSize + byte`
+		std::vector<FSMStateType> wide{};
+
+		for (const DFAType& machine : machines) {
+			const auto& tranFn = machine.getTransitionFunction();
+			const size_t offset = m_StateOffsets.back();
+
+			// discover the reachable states breadth first, numbering them locally (the dead state is 0 and the start state 1)
+			std::vector<FSMStateType> states{ deadState, startState };
+			std::map<FSMStateType, FSMStateType> localOf{ {deadState, 0}, {startState, 1} };
+			wide.resize((offset + 1) * alphabetSize);
+
+			for (size_t i = 1; i < states.size(); i++) {
+				wide.resize((offset + i + 1) * alphabetSize);
+
+				for (size_t symbol = 0; symbol < alphabetSize; symbol++) {
+					const FSMStateType next = tranFn.nextState(states[i], static_cast<unsigned char>(symbol));
+					const auto [it, inserted] = localOf.try_emplace(next, static_cast<FSMStateType>(states.size()));
+
+					if (inserted)
+						states.push_back(next);
+
+					wide[(offset + i) * alphabetSize + symbol] = it->second;
+				}
+			}
+
+			for (const FSMStateType state : states) {
+				m_IsFinal.push_back(state != deadState && machine.getFinalStates().contains(state));
+				m_OriginalStates.push_back(state);
+			}
+
+			m_StateOffsets.push_back(offset + states.size());
+		}
+
+		// group the bytes that no state of any machine tells apart into classes
+		const size_t stateCount = m_StateOffsets.back();
+		std::map<std::vector<FSMStateType>, std::uint8_t> classOf{};
+		std::vector<std::vector<FSMStateType>> columns{};
+
+		for (size_t symbol = 0; symbol < alphabetSize; symbol++) {
+			std::vector<FSMStateType> column(stateCount);
+
+			for (size_t state = 0; state < stateCount; state++)
+				column[state] = wide[state * alphabetSize + symbol];
+
+			const auto [it, inserted] = classOf.emplace(column, static_cast<std::uint8_t>(columns.size()));
+			if (inserted)
+				columns.push_back(std::move(column));
+
+			m_Classes[symbol] = it->second;
+		}
+
+		m_ClassCount = columns.size();
+		m_Transitions.resize(stateCount * m_ClassCount);
+
+		for (size_t c = 0; c < m_ClassCount; c++)
+			for (size_t state = 0; state < stateCount; state++)
+				m_Transitions[state * m_ClassCount + c] = columns[c][state];
+	}
+
+	/**
+	 * @brief Puts every machine in its start state, and marks them all as alive.
+	 */
+	inline void MultiDFARunner::_start(Run& run) const
+	{
+		run.states.assign(this->getMachineCount(), 1);
+		run.alive.resize(this->getMachineCount());
+
+		for (size_t machine = 0; machine < run.alive.size(); machine++)
+			run.alive[machine] = machine;
+	}
+
+	/**
+	 * @brief Simulates every machine against the whole of `input`.
+	 * @see DeterFiniteAutomaton<TransFuncT, InputT>::simulate(const InputT& input, const FSM_MODE mode) const
+	 */
+	inline std::vector<FSMResult> MultiDFARunner::_simulate_whole_string(std::string_view input) const
+	{
+		Run run{};
+		this->_start(run);
+
+		for (IndexType charIndex = 0; charIndex < input.size() && run.alive.size(); charIndex++) {
+			const std::uint8_t byteClass = m_Classes[static_cast<unsigned char>(input[charIndex])];
+
+			// advance every machine that is alive, dropping those that die
+			for (size_t i = 0; i < run.alive.size(); ) {
+				const size_t machine = run.alive[i];
+				const FSMStateType next = this->_next(machine, run.states[machine], byteClass);
+				run.states[machine] = next;
+
+				if (next)
+					i++;
+				else {
+					run.alive[i] = run.alive.back();
+					run.alive.pop_back();
+				}
+			}
+		}
+
+		std::vector<FSMResult> results{};
+		results.reserve(this->getMachineCount());
+
+		for (size_t machine = 0; machine < this->getMachineCount(); machine++) {
+			const FSMStateType state = run.states[machine];
+			const bool accepted = this->_is_final(machine, state);
+
+			results.push_back(FSMResult(accepted, accepted ? FSMStateSetType{ this->_original(machine, state) } : FSMStateSetType{ this->_original(machine, 1) }, { 0, accepted ? input.size() : 0 }, input));
+		}
+
+		return results;
+	}
+
+	/**
+	 * @brief Finds the longest prefix of `input[startIndex:]` that each machine accepts, in a single pass.
+	 * @param[out] ends The index after the last character of the prefix accepted by each machine, if any.
+	 * @param[out] finalStates The final (local) state reached by each machine at the end of its prefix.
+	 */
+	inline void MultiDFARunner::_longest_prefixes(std::string_view input, const IndexType startIndex, Run& run, std::vector<std::optional<IndexType>>& ends, std::vector<FSMStateType>& finalStates) const
+	{
+		this->_start(run);
+		ends.assign(this->getMachineCount(), std::nullopt);
+		finalStates.assign(this->getMachineCount(), 1);
+
+		for (size_t machine = 0; machine < this->getMachineCount(); machine++)
+			if (this->_is_final(machine, 1))
+				ends[machine] = startIndex;
+
+		for (IndexType charIndex = startIndex; charIndex < input.size() && run.alive.size(); charIndex++) {
+			const std::uint8_t byteClass = m_Classes[static_cast<unsigned char>(input[charIndex])];
+
+			for (size_t i = 0; i < run.alive.size(); ) {
+				const size_t machine = run.alive[i];
+				const FSMStateType next = this->_next(machine, run.states[machine], byteClass);
+				run.states[machine] = next;
+
+				if (!next) {
+					run.alive[i] = run.alive.back();
+					run.alive.pop_back();
+					continue;
+				}
+
+				if (this->_is_final(machine, next)) {
+					ends[machine] = charIndex + 1;
+					finalStates[machine] = next;
+				}
+
+				i++;
+			}
+		}
+	}
+
+	/**
+	 * @brief Simulates every machine against `input` looking for the longest prefix only.
+	 * @see DeterFiniteAutomaton<TransFuncT, InputT>::simulate(const InputT& input, const FSM_MODE mode) const
+	 */
+	inline std::vector<FSMResult> MultiDFARunner::_simulate_longest_prefix(std::string_view input) const
+	{
+		Run run{};
+		std::vector<std::optional<IndexType>> ends{};
+		std::vector<FSMStateType> finalStates{};
+
+		this->_longest_prefixes(input, 0, run, ends, finalStates);
+
+		std::vector<FSMResult> results{};
+		results.reserve(this->getMachineCount());
+
+		for (size_t machine = 0; machine < this->getMachineCount(); machine++) {
+			if (ends[machine])
+				results.push_back(FSMResult(true, this->_original(machine, finalStates[machine]), { 0, *ends[machine] }, input));
+			else
+				results.push_back(FSMResult(false, {}, { 0, 0 }, input));
+		}
+
+		return results;
+	}
+
+	/**
+	 * @brief Simulates every machine against `input` looking for the longest substring, which might be the entire string.
+	 * @details The machines are run in lock-step from every position of the input, until every machine has found a substring that no later position can beat.
+	 * @see DeterFiniteAutomaton<TransFuncT, InputT>::simulate(const InputT& input, const FSM_MODE mode) const
+	 */
+	inline std::vector<FSMResult> MultiDFARunner::_simulate_longest_substring(std::string_view input) const
+	{
+		const size_t machineCount = this->getMachineCount();
+
+		Run run{};
+		std::vector<std::optional<IndexType>> ends{};
+		std::vector<FSMStateType> finalStates{};
+
+		std::vector<std::optional<Indicies>> longest(machineCount);
+		std::vector<FSMStateType> longestFinalStates(machineCount, 1);
+
+		for (IndexType startIndex = 0; startIndex < input.size(); startIndex++) {
+			// stop once the rest of the input is not longer than the longest substring of any machine
+			const bool done = std::all_of(longest.begin(), longest.end(), [&input, startIndex](const std::optional<Indicies>& l) {
+				return l && input.size() - startIndex <= l->end - l->start;
+				});
+
+			if (done)
+				break;
+
+			this->_longest_prefixes(input, startIndex, run, ends, finalStates);
+
+			for (size_t machine = 0; machine < machineCount; machine++) {
+				std::optional<Indicies>& l = longest[machine];
+
+				if (ends[machine] && (!l || *ends[machine] - startIndex > l->end - l->start)) {
+					l = Indicies{ startIndex, *ends[machine] };
+					longestFinalStates[machine] = finalStates[machine];
+				}
+			}
+		}
+
+		std::vector<FSMResult> results{};
+		results.reserve(machineCount);
+
+		for (size_t machine = 0; machine < machineCount; machine++) {
+			if (longest[machine])
+				results.push_back(FSMResult(true, this->_original(machine, longestFinalStates[machine]), *longest[machine], input));
+			else
+				results.push_back(FSMResult(false, { this->_original(machine, 1) }, { 0, 0 }, input));
+		}
+
+		return results;
+	}
+
+	/**
+	* @brief Simulates every machine against the given input string using the given simulation method.
+	* @param[in] input The input string to be simulated.
+	* @param[in] mode The simulation mode.
+	* @throw UnrecognizedSimModeException Thrown in case an incorrect simulation mode is entered.
+	* @return The result of each machine, in the order the machines were given in.
+	*/
+	inline std::vector<FSMResult> MultiDFARunner::simulate(std::string_view input, const FSM_MODE mode) const
+	{
+		switch (mode) {
+		case FSM_MODE::MM_WHOLE_STRING:
+			return this->_simulate_whole_string(input);
+		case FSM_MODE::MM_LONGEST_PREFIX:
+			return this->_simulate_longest_prefix(input);
+		case FSM_MODE::MM_LONGEST_SUBSTRING:
+			return this->_simulate_longest_substring(input);
+		default:
+			Logger{}.log(LoggerInfo::LL_ERROR, "Unreachable: simulate() cannot reach this point. The provided mode is probably erroneous.");
+			throw UnrecognizedSimModeException();
+		}
+	}
+
+}
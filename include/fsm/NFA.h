@@ -1,11 +1,16 @@
 #pragma once
 
-#include <stack>
 #include <ranges>
 #include <functional>
-#include <assert.h>
+#include <optional>
+#include <memory>
+#include <memory_resource>
+#include <cstdint>
 
 #include "FiniteStateMachine.h"
+#include "BitParallelNFA.h"
+#include "Prefilter.h"
+#include "ScratchArena.h"
 
 // DECLARATIONS
 namespace m0st4fa::fsm {
@@ -17,23 +22,55 @@ namespace m0st4fa::fsm {
 	template <typename TransFuncT, typename InputT = std::string_view>
 	class NonDeterFiniteAutomaton : public FiniteStateMachine<TransFuncT, InputT> {
 		using Base = FiniteStateMachine<TransFuncT, InputT>;
-		using SubstringType = Substring<FSMStateSetType>;
+
+		/**
+		 * @brief The scratch memory used by a simulation, all of which is allocated from a single memory resource.
+		 * @details Sets of states are kept as unsorted vectors; a state is added to a set only if its mark is not the current generation, which makes each step linear in the number of states reached, with no per-state allocation.
+		 */
+		struct Scratch {
+			//! @brief The set of states that the machine is in.
+			std::pmr::vector<FSMStateType> current;
+			//! @brief The set of states that the machine moves to, being built.
+			std::pmr::vector<FSMStateType> next;
+			//! @brief The stack of the epsilon-closure algorithm.
+			std::pmr::vector<FSMStateType> stack;
+			//! @brief The final states within the set that ends the current match.
+			std::pmr::vector<FSMStateType> finals;
+			//! @brief The generation in which each state was last added to `next`.
+			std::pmr::vector<std::uint32_t> marks;
+			//! @brief The current generation (one per step).
+			std::uint32_t generation = 0;
+
+			explicit Scratch(std::pmr::memory_resource* resource) :
+				current{ resource }, next{ resource }, stack{ resource }, finals{ resource }, marks{ resource } {};
+		};
 
 		// PRIVATE METHODS
 
 		// MAIN
-		FSMResult _simulate_whole_string(const InputT&) const;
-		FSMResult _simulate_longest_prefix(const InputT&) const;
-		FSMResult _simulate_longest_substring(const InputT&) const;
+		FSMResult _simulate_whole_string(const InputT&, Scratch&) const;
+		FSMResult _simulate_longest_prefix(const InputT&, Scratch&) const;
+		FSMResult _simulate_longest_substring(const InputT&, Scratch&) const;
+		FSMResult _simulate_count(const InputT&, Scratch&) const;
+		FSMResult _simulate_count_ends(const InputT&, Scratch&) const;
+		FSMResult _simulate_any_match(const InputT&, Scratch&) const;
 
 		// HELPERS
-		bool _check_accepted_longest_prefix(const std::vector<FSMStateSetType>&, size_t&) const;
-
-		bool _check_accepted_substring(const InputT&, std::vector<FSMStateSetType>&, const size_t, size_t&) const;
-		inline std::vector<SubstringType> _extract_matching_substrings(const InputT) const;
-		FSMResult _get_longest_substring_from_matched_sets(const InputT, const std::vector<SubstringType>&) const;
-
-		FSMStateSetType _epsilon_closure(const FSMStateSetType&) const;
+		void _start(Scratch&) const;
+		template <typename SymbolT>
+		void _step(Scratch&, const SymbolT) const;
+		bool _contains_final_state(const std::pmr::vector<FSMStateType>&) const;
+		bool _collect_final_states(const std::pmr::vector<FSMStateType>&, std::pmr::vector<FSMStateType>&) const;
+		static FSMStateSetType _to_state_set(const std::pmr::vector<FSMStateType>&);
+		std::optional<IndexType> _longest_prefix(const InputT&, const IndexType, Scratch&) const;
+		template <typename CallbackT>
+		void _run_unanchored(const InputT&, Scratch&, CallbackT) const;
+
+		//! @brief The bit-parallel engine used to simulate the machine, if it is small enough to have one. It is never modified once compiled, so copies of the machine share it.
+		std::shared_ptr<const BitParallelNFAVariant> m_BitParallel = std::make_shared<const BitParallelNFAVariant>();
+
+		//! @brief Used to skip the positions at which no match can begin when searching for substrings.
+		Prefilter m_Prefilter{};
 
 	public:
 		/**
@@ -48,8 +85,8 @@ namespace m0st4fa::fsm {
 		 * @param[in] flags The flags given to the new NFA object.
 		 * @see See m0st4fa::fsm::FSM_TYPE for setting the type of the machine and m0st4fa::fsm::FlagsType for determining flags.
 		 */
-		NonDeterFiniteAutomaton(const FSMStateSetType& fStates, const TransFuncT& tranFn, FSM_TYPE machineType = FSM_TYPE::MT_EPSILON_NFA, FlagsType flags = FSM_FLAG::FF_FLAG_NONE) :
-			FiniteStateMachine<TransFuncT, InputT>{ fStates, tranFn, machineType, flags }
+		NonDeterFiniteAutomaton(const FSMStateSetType& fStates, TransFuncT tranFn, FSM_TYPE machineType = FSM_TYPE::MT_EPSILON_NFA, FlagsType flags = FSM_FLAG::FF_FLAG_NONE) :
+			FiniteStateMachine<TransFuncT, InputT>{ fStates, std::move(tranFn), machineType, flags }
 		{
 
 
@@ -60,10 +97,53 @@ namespace m0st4fa::fsm {
 				throw InvalidStateMachineArgumentsException(message);
 			};
 
+			m_Prefilter = Prefilter{ this->m_TransitionFunc, fStates, machineType == FSM_TYPE::MT_EPSILON_NFA };
+
+			// compile small machines over byte-sized input into a bit-parallel engine
+			if constexpr (sizeof(std::ranges::range_value_t<InputT>) == 1)
+				m_BitParallel = std::make_shared<const BitParallelNFAVariant>(compileBitParallelNFA(this->m_TransitionFunc, fStates, machineType == FSM_TYPE::MT_EPSILON_NFA));
+
 		};
+		/**
+		 * @brief Copy constructor for NFA objects. The bit-parallel engine is shared with `rhs`.
+		 */
+		NonDeterFiniteAutomaton(const NonDeterFiniteAutomaton&) = default;
+		/**
+		 * @brief Move constructor for NFA objects.
+		 * @details The bit-parallel engine is shared with `rhs` rather than taken from it, so that `rhs` remains usable.
+		 */
+		NonDeterFiniteAutomaton(NonDeterFiniteAutomaton&& rhs) noexcept(std::is_nothrow_move_constructible_v<Base>) :
+			Base{ std::move(rhs) },
+			m_BitParallel{ rhs.m_BitParallel },
+			m_Prefilter{ std::move(rhs.m_Prefilter) }
+		{};
+		/**
+		 * @brief Copy assignment operator for NFA objects.
+		 */
+		NonDeterFiniteAutomaton& operator=(const NonDeterFiniteAutomaton&) = default;
+		/**
+		 * @brief Move assignment operator for NFA objects.
+		 * @details The bit-parallel engine is shared with `rhs` rather than taken from it, so that `rhs` remains usable.
+		 */
+		NonDeterFiniteAutomaton& operator=(NonDeterFiniteAutomaton&& rhs) noexcept(std::is_nothrow_move_assignable_v<Base>) {
+			this->Base::operator=(std::move(rhs));
+			this->m_BitParallel = rhs.m_BitParallel;
+			this->m_Prefilter = std::move(rhs.m_Prefilter);
+			return *this;
+		}
+
+		/**
+		 * @brief Checks whether the machine is simulated by a bit-parallel engine.
+		 * @details This is the case for machines over byte-sized input that have at most 256 states reachable from the start state.
+		 * @see BitParallelNFA
+		 */
+		bool isBitParallel() const {
+			return not std::holds_alternative<std::monostate>(*m_BitParallel);
+		}
 
 
 		FSMResult simulate(const InputT&, const FSM_MODE) const;
+		FSMResult simulate(const InputT&, const FSM_MODE, std::pmr::memory_resource*) const;
 
 	};
 
@@ -80,319 +160,313 @@ namespace m0st4fa::fsm {
 	/**
 	 * @brief Simulate against whole string. The simulation returns true if and only if the whole string accepts.
 	 * @param[in] input The input string against which the simulation will run.
+	 * @param scratch The scratch memory of the simulation.
 	 * @return FSMResult object that indicates the result of the simulation.
 	 */
 	template<typename TransFuncT, typename InputT>
-	FSMResult NonDeterFiniteAutomaton<TransFuncT, InputT>::_simulate_whole_string(const InputT& input) const
+	FSMResult NonDeterFiniteAutomaton<TransFuncT, InputT>::_simulate_whole_string(const InputT& input, Scratch& scratch) const
 	{
-		constexpr FSMStateType startState = FiniteStateMachine<TransFuncT, InputT>::START_STATE;
-		FSMStateSetType currState = { startState };
+		this->_start(scratch);
+
+		// follow a path through the machine using the characters of the string; no state can be reached again once the set is empty
+		for (IndexType charIndex = 0; charIndex < input.size() && !scratch.current.empty(); charIndex++)
+			this->_step(scratch, input[charIndex]);
 
-		/**
-		 * Follow a path through the machine using the characters of the string.
-		 * Break if you hit a dead state since it is dead.
-		*/
-		if (this->getMachineType() == FSM_TYPE::MT_NON_EPSILON_NFA) // If the machine is a non-epsilon NFA
-			for (auto c : input)
-				currState = this->m_TransitionFunc(currState, c);
-		else // If the machine is an epsilon NFA
-			for (auto c : input)
-				currState = _epsilon_closure(this->m_TransitionFunc(currState, c));
-		
 		// assert whether we've reached a final state
-		FSMStateSetType finalStates = this->_get_final_states_from_state_set(currState);
-		bool accepted = !finalStates.empty();
-				
+		const bool accepted = this->_collect_final_states(scratch.current, scratch.finals);
 
-		return FSMResult(accepted, finalStates, { 0, accepted ? input.size() : 0 }, input);
+		return FSMResult(accepted, _to_state_set(scratch.finals), { 0, accepted ? input.size() : 0 }, input);
 	}
 
 	/**
 	 * @brief Simulates the NFA against `input` looking for the longest prefix only.
 	 * @param[in] input The input string against which the simulation will run.
-	 * @return FSMResult object that indicates the result of the simulation.
+	 * @param scratch The scratch memory of the simulation.
+	 * @return FSMResult object that indicates the result of the simulation. The final states are those reached at the end of the prefix.
 	 */
 	template<typename TransFuncT, typename InputT>
-	FSMResult NonDeterFiniteAutomaton<TransFuncT, InputT>::_simulate_longest_prefix(const InputT& input) const
+	FSMResult NonDeterFiniteAutomaton<TransFuncT, InputT>::_simulate_longest_prefix(const InputT& input, Scratch& scratch) const
 	{
-		constexpr FSMStateType startState = FiniteStateMachine<TransFuncT, InputT>::START_STATE;
-		std::vector<FSMStateSetType> matchedStates = { {startState} };
-		size_t charIndex = 0;
-
-		/**
-		* keeps track of the path taken through the machine.
-		* Will be used to figure out the longest matched prefix, if any.
-		*/
-
-		/**
-		 * Follow a path through the machine using the characters of the string.
-		 * Keep track of that path in order to be able to find the longest prefix if the whole string is not accepted.
-		*/
-		if (this->getMachineType() == FSM_TYPE::MT_NON_EPSILON_NFA)
-			for (; charIndex < input.size(); charIndex++) {
-				const auto c = input.at(charIndex);
-				// get next set of states and update our path through the machine
-				matchedStates.push_back(this->m_TransitionFunc(matchedStates.back(), c));
-			}
-		else 
-			for (; charIndex < input.size(); charIndex++) {
-				const auto c = input.at(charIndex);
-				// get next set of states and update our path through the machine
-				matchedStates.push_back(this->_epsilon_closure(this->m_TransitionFunc(matchedStates.back(), c)));
-			}
-
-		// make sure `charIndex` < input.size()
-		if (charIndex == input.size())
-			charIndex = input.size() - 1;
+		const std::optional<IndexType> end = this->_longest_prefix(input, 0, scratch);
 
-		// set the index of the current character; figure out whether there is an accepted longest prefix; set the end index
-		bool accepted = _check_accepted_longest_prefix(matchedStates, charIndex);
-		size_t end = accepted ? charIndex + 1 : 0;
-		
-		// get the final states we've reached
-		const FSMStateSetType& finalStates = this->_get_final_states_from_state_set(matchedStates.back());
+		if (!end)
+			return FSMResult(false, {}, { 0, 0 }, input);
 
-		return FSMResult(accepted, finalStates, { 0, end }, input);
+		return FSMResult(true, _to_state_set(scratch.finals), { 0, *end }, input);
 	}
 
 	/**
 	 * @brief Simulates the NFA against `input` looking for the longest substring, which might be the entire string.
+	 * @details The longest substring is chosen, or the first of many having the same length.
 	 * @param[in] input The input string against which the simulation will run.
-	 * @return FSMResult object that indicates the result of the simulation.
+	 * @param scratch The scratch memory of the simulation.
+	 * @return FSMResult object that indicates the result of the simulation. The final states are those reached at the end of the substring.
 	 */
 	template<typename TransFuncT, typename InputT>
-	FSMResult NonDeterFiniteAutomaton<TransFuncT, InputT>::_simulate_longest_substring(const InputT& input) const
+	FSMResult NonDeterFiniteAutomaton<TransFuncT, InputT>::_simulate_longest_substring(const InputT& input, Scratch& scratch) const
 	{
+		std::optional<Indicies> longest{};
+		// the final states reached at the end of the longest substring
+		std::pmr::vector<FSMStateType> longestFinals{ scratch.finals.get_allocator() };
+
+		// skip the positions at which no match can begin; stop once no later substring can be longer
+		for (IndexType start = m_Prefilter.next(input, 0); start < input.size(); start = m_Prefilter.next(input, start + 1)) {
+			if (longest && input.size() - start <= longest->end - longest->start)
+				break;
 
-		// The substrings that are matching within `input`.
-		std::vector<SubstringType> substrings = _extract_matching_substrings(input);
+			const std::optional<IndexType> end = this->_longest_prefix(input, start, scratch);
 
-		// If there's at least one accepted substring
-		if (substrings.size())
-			return _get_longest_substring_from_matched_sets(input, substrings);
+			if (end && (!longest || *end - start > longest->end - longest->start)) {
+				longest = Indicies{ start, *end };
+				longestFinals.assign(scratch.finals.begin(), scratch.finals.end());
+			}
+		}
 
 		// If there was no accepted substring.
-		return FSMResult(false, {}, {0, 0}, input);
+		if (!longest)
+			return FSMResult(false, {}, { 0, 0 }, input);
+
+		return FSMResult(true, _to_state_set(longestFinals), *longest, input);
 	}
 
 	/**
-	* @brief Simulates the DFA against `input` looking for the longest prefix. It also updates `charIndex` to the index of the last character of that prefix.
-	* @param[in] matchedStates A set of states that constitute a path through the NFA, following `input` character by character starting from the start state of the NFA.
-	* @param[out] charIndex The index of the last character of the matched prefix, if found; otherwise, 0.
-	* @return `true` if a prefix matches, `false` otherwise.
-	**/
+	 * @brief Simulates the NFA against `input` counting the non-empty, non-overlapping leftmost-longest matches.
+	 * @details Each match is the longest prefix accepted from the first position, after the end of the previous match, at which a non-empty prefix is accepted. Nothing is allocated per match.
+	 * @param[in] input The input string against which the simulation will run.
+	 * @param scratch The scratch memory of the simulation.
+	 * @return FSMResult object whose `count` is the number of matches; it is accepted if there is at least one.
+	 */
 	template<typename TransFuncT, typename InputT>
-	bool NonDeterFiniteAutomaton<TransFuncT, InputT>::_check_accepted_longest_prefix(const std::vector<FSMStateSetType>& matchedStates, size_t& charIndex) const
+	FSMResult NonDeterFiniteAutomaton<TransFuncT, InputT>::_simulate_count(const InputT& input, Scratch& scratch) const
 	{
-		constexpr FSMStateType startState = FiniteStateMachine<TransFuncT, InputT>::START_STATE;
+		size_t count = 0;
 
-		/**
-		* Loop through the path from the end seeking the closes final state.
-		* Update the character index as you do so.
-		*/
-		std::ranges::reverse_view rv{matchedStates};
-		for(const FSMStateSetType& state : rv)
-		{
-			if (this->_is_state_final(state))
-				return true;
-			
-			charIndex--;
+		for (IndexType start = m_Prefilter.next(input, 0); start < input.size();) {
+			const std::optional<IndexType> end = this->_longest_prefix(input, start, scratch);
+
+			// continue after the match, if there is one
+			if (end && *end > start) {
+				count++;
+				start = m_Prefilter.next(input, *end);
+			}
+			else
+				start = m_Prefilter.next(input, start + 1);
 		}
-		
-		// make sure `charIndex` does not get below 0
-		if (charIndex < 0)
-			charIndex = 0;
 
-		return false;
+		return FSMResult(count > 0, {}, { 0, 0 }, input, count);
 	}
 
 	/**
-	* @brief Checks whether the substring starting from `startIndex` accepts. It also updates `charIndex` to the index of the last character of that substring.
-	* @param[in] matchedStates The set of states that form the path taken through the machine after simulating the machine against `input`.
-	* @param[in] startIndex The index, within `input`, at which the substring starts.
-	* @param[out] charIndex The index of the last checked character (the last that didn't result in a dead state).
-	* @return `true` if a substring starting from startIndex has accepted; `false` otherwise.
-	**/
+	 * @brief Simulates the NFA against `input` counting the positions at which at least one non-empty match ends.
+	 * @param[in] input The input string against which the simulation will run.
+	 * @param scratch The scratch memory of the simulation.
+	 * @return FSMResult object whose `count` is the number of positions; it is accepted if there is at least one.
+	 */
 	template<typename TransFuncT, typename InputT>
-	bool NonDeterFiniteAutomaton<TransFuncT, InputT>::_check_accepted_substring(const InputT& input, std::vector<FSMStateSetType>& matchedStates, const size_t startIndex, size_t& charIndex) const	
+	FSMResult NonDeterFiniteAutomaton<TransFuncT, InputT>::_simulate_count_ends(const InputT& input, Scratch& scratch) const
 	{
+		size_t count = 0;
 
-		assert(charIndex == startIndex);
+		this->_run_unanchored(input, scratch, [&count](const IndexType) {
+			count++;
+			return false;
+			});
 
-		/**
-		* Follow a path through the machine using the characters of the string.
-		* Keep track of that path in order to be able to find the longest prefix if the whole string is not accepted.
-		*/
-		auto matchInput = [input, &charIndex, &matchedStates, this](bool calcClosure = false) {
-			for (; charIndex < input.size(); charIndex++) {
-
-				auto c = input[charIndex];
-
-				FSMStateSetType currStateSet{};
-
-				if (calcClosure) {
-					currStateSet = _epsilon_closure(
-						this->m_TransitionFunc(matchedStates.back(), c)
-					);
-				}
-				else {
-					currStateSet = this->m_TransitionFunc(matchedStates.back(), c);
-				}
-
-				// if the current state is empty
-				if (!currStateSet.size()) {
-					charIndex--;
-					return; // break out of the loop and the function
-				}
-
-				// get next set of states
-				// update our path through the machine
-				matchedStates.push_back(currStateSet);
-			}
-
-			// make sure charIndex is less that input.size() even if the entire string accepts
-			if (charIndex == input.size())
-				charIndex--;
-		};
-		
-		if (this->getMachineType() == FSM_TYPE::MT_NON_EPSILON_NFA)
-			matchInput();
-		else
-			matchInput(true);
-
-		// figure out whether there is an accepted longest prefix
-		return _check_accepted_longest_prefix(matchedStates, charIndex);
+		return FSMResult(count > 0, {}, { 0, 0 }, input, count);
 	}
 
 	/**
-	* @brief Extracts all matched substrings in `input`, if any, and returns them.
-	* @param[in] input The input out of which the substrings will be extracted.
-	* @return The set of substrings extracted out of `input`.
-	**/
+	 * @brief Simulates the NFA against `input` checking whether any substring of it is accepted, stopping at the end of the first match found.
+	 * @param[in] input The input string against which the simulation will run.
+	 * @param scratch The scratch memory of the simulation.
+	 * @return FSMResult object that is accepted if there is a match; its indicies span the input up to the end of the first match to end, and its final states are those reached there.
+	 */
 	template<typename TransFuncT, typename InputT>
-	inline std::vector<Substring<FSMStateSetType>> NonDeterFiniteAutomaton<TransFuncT, InputT>::_extract_matching_substrings(const InputT input) const
+	FSMResult NonDeterFiniteAutomaton<TransFuncT, InputT>::_simulate_any_match(const InputT& input, Scratch& scratch) const
 	{
-		size_t start = 0;
-		size_t charIndex = 0;
+		// the empty string is a substring of every input
+		this->_start(scratch);
+		if (this->_collect_final_states(scratch.current, scratch.finals))
+			return FSMResult(true, _to_state_set(scratch.finals), { 0, 0 }, input);
 
-		constexpr FSMStateType startState = FiniteStateMachine<TransFuncT, InputT>::START_STATE;
-		/*
-		* @brief Keeps track of the path taken through the machine.
-		* Will be used to figure out the longest matched prefix, if any.
-		*/
-		std::vector<FSMStateSetType> matchedStates = { {startState} };
+		std::optional<IndexType> end{};
 
-		// @note Note that it is necessary to find all substrings first and then find which one is the longest. You cannot simply find the longest substring before finding all substrings first.
+		this->_run_unanchored(input, scratch, [&end](const IndexType matchEnd) {
+			end = matchEnd;
+			return true;
+			});
 
-		// The substrings that match within `input`.
-		std::vector<SubstringType> substrings{};
+		if (!end)
+			return FSMResult(false, {}, { 0, 0 }, input);
 
-		// Get all the substrings that match within `input` and store them in `substrings`.
-		for (; charIndex < input.size(); charIndex = ++start) {
+		this->_collect_final_states(scratch.current, scratch.finals);
 
-			// check whether the substring is accepted (and populate everything given by reference)
-			bool accepted = _check_accepted_substring(input, matchedStates, start, charIndex);
+		return FSMResult(true, _to_state_set(scratch.finals), { 0, *end }, input);
+	}
 
-			// if the substring was accepted
-			if (accepted) {
-				substrings.push_back({ matchedStates, start, charIndex + 1 });
+	/**
+	 * @brief Runs the NFA unanchored over `input`, in a single pass, reporting each position at which at least one non-empty match ends.
+	 * @details The start state is added to the set of states before each character, so that the set holds the states of the matches beginning at every earlier position. Positions at which the set is empty are skipped by the prefilter.
+	 * @param[in] input The input string against which the simulation will run.
+	 * @param scratch The scratch memory of the simulation. When `onMatchEnd` is called, `scratch.current` is the set of states reached.
+	 * @param[in] onMatchEnd Called with the index after the last character of the matches; returns whether to stop.
+	 */
+	template<typename TransFuncT, typename InputT>
+	template<typename CallbackT>
+	void NonDeterFiniteAutomaton<TransFuncT, InputT>::_run_unanchored(const InputT& input, Scratch& scratch, CallbackT onMatchEnd) const
+	{
+		scratch.current.clear();
 
-				// if the rest of the input is less than the current substring in length, leave
-				if ((input.size() - start) < matchedStates.size())
+		for (IndexType charIndex = 0; charIndex < input.size(); charIndex++) {
+			if (scratch.current.empty()) {
+				charIndex = m_Prefilter.next(input, charIndex);
+
+				if (charIndex == input.size())
 					break;
 			}
 
-			matchedStates.resize(1);
-		}
+			// a match might begin here; the step drops the duplicate if the start state is already in the set
+			scratch.current.push_back(Base::START_STATE);
+			this->_step(scratch, input[charIndex]);
 
-		return substrings;
+			if (this->_contains_final_state(scratch.current) && onMatchEnd(charIndex + 1))
+				return;
+		}
 	}
 
 	/**
-	* @brief Gets the longest substring from a set of matching substrings.
-	* @param[in] input The input string to the simulation method (the matching substrings are substrings of this input string).
-	* @param[in] substrings The set of matching substrings.
-	* @return FSMResult object representing the longest matching substring from the set of matching substrings given to it.
-	**/
+	 * @brief Finds the longest prefix of `input[start:]` that the machine accepts.
+	 * @param[in] input The input string.
+	 * @param[in] start The index at which the prefix begins.
+	 * @param scratch The scratch memory of the simulation. On success, `scratch.finals` holds the final states reached at the end of the prefix.
+	 * @return The index after the last character of the prefix, or nothing if no prefix (not even the empty one) is accepted.
+	 */
 	template<typename TransFuncT, typename InputT>
-	inline FSMResult NonDeterFiniteAutomaton<TransFuncT, InputT>::_get_longest_substring_from_matched_sets(const InputT input, const std::vector<SubstringType>& substrings) const {
-
-		// longest-matching substring
-		const SubstringType* longest = nullptr;
-		// size of longest-matching substring.
-		size_t size = 0;
-
-		// choose the longest substring or the first of many having the same length
-		for (const auto& substring : substrings) {
-			// if the length of this substring is longer than that of the previously caught
-			if (substring.size() > size) {
-				longest = &substring;
-				size = longest->size();
+	std::optional<IndexType> NonDeterFiniteAutomaton<TransFuncT, InputT>::_longest_prefix(const InputT& input, const IndexType start, Scratch& scratch) const
+	{
+		std::optional<IndexType> end{};
+
+		this->_start(scratch);
+
+		if (this->_collect_final_states(scratch.current, scratch.finals))
+			end = start;
+
+		// stop as soon as the set is empty, since no state can be reached again
+		for (IndexType charIndex = start; charIndex < input.size() && !scratch.current.empty(); charIndex++) {
+			this->_step(scratch, input[charIndex]);
+
+			if (this->_contains_final_state(scratch.current)) {
+				this->_collect_final_states(scratch.current, scratch.finals);
+				end = charIndex + 1;
 			}
 		}
 
-		size_t start = 0;
-		size_t end = 0;
+		return end;
+	}
+
+	/**
+	 * @brief Puts the machine in its start state.
+	 */
+	template<typename TransFuncT, typename InputT>
+	void NonDeterFiniteAutomaton<TransFuncT, InputT>::_start(Scratch& scratch) const
+	{
+		scratch.current.assign(1, Base::START_STATE);
+	}
 
-		if (longest) {
-			start = longest->indicies.start;
-			end = longest->indicies.end;
+	/**
+	 * @brief Moves the machine from the set of states it is in to the set of states reached on `symbol` (followed by their epsilon closure, for epsilon NFAs).
+	 * @param scratch The scratch memory of the simulation, whose `current` set is updated.
+	 * @param[in] symbol The input symbol consumed.
+	 */
+	template<typename TransFuncT, typename InputT>
+	template<typename SymbolT>
+	void NonDeterFiniteAutomaton<TransFuncT, InputT>::_step(Scratch& scratch, const SymbolT symbol) const
+	{
+		std::pmr::vector<std::uint32_t>& marks = scratch.marks;
+		std::pmr::vector<FSMStateType>& next = scratch.next;
+		std::pmr::vector<FSMStateType>& stack = scratch.stack;
+		const bool calcClosure = this->getMachineType() == FSM_TYPE::MT_EPSILON_NFA;
+
+		// start a new generation, clearing the marks once the generations wrap around
+		if (++scratch.generation == 0) {
+			std::fill(marks.begin(), marks.end(), 0);
+			scratch.generation = 1;
 		}
 
-		// the final states we've reached
-		const FSMStateSetType currState = longest->matchedStates.back();
-		const FSMStateSetType finalStateSet = this->_get_final_states_from_state_set(currState);
-		//assert("This set must contain at least a single final state" && finalStateSet.size());
+		const std::uint32_t generation = scratch.generation;
+		auto add = [&marks, &next, &stack, generation, calcClosure](const FSMStateType state) {
+			if (marks.size() <= state)
+				marks.resize(state + 1);
 
-		return FSMResult(true, finalStateSet, { start, end }, input);
-	};
+			if (marks[state] == generation)
+				return;
+
+			marks[state] = generation;
+			next.push_back(state);
+
+			if (calcClosure)
+				stack.push_back(state);
+		};
+
+		next.clear();
+		stack.clear();
+
+		for (const FSMStateType state : scratch.current)
+			this->m_TransitionFunc.forEachTarget(state, symbol, add);
+
+		// extend the set to its epsilon closure; every state is pushed onto the stack at most once
+		while (stack.size()) {
+			const FSMStateType state = stack.back();
+			stack.pop_back();
+
+			this->m_TransitionFunc.forEachTarget(state, '\0', add);
+		}
+
+		scratch.current.swap(next);
+	}
 
 	/**
-	 * @brief Calculate the epsilon closure of a set of states.
-	 * @param[in] set The set for which epsilon closure will be calculated.
-	 * @return The set that represents the epsilon closure of `set`.
+	 * @brief Checks whether `states` contains at least one final state.
 	 */
 	template<typename TransFuncT, typename InputT>
-	FSMStateSetType NonDeterFiniteAutomaton<TransFuncT, InputT>::_epsilon_closure(const FSMStateSetType& set) const
+	bool NonDeterFiniteAutomaton<TransFuncT, InputT>::_contains_final_state(const std::pmr::vector<FSMStateType>& states) const
 	{
-		FSMStateSetType res{set};
+		return std::any_of(states.begin(), states.end(), [this](const FSMStateType state) { return this->_is_state_final(state); });
+	}
+
+	/**
+	 * @brief Writes the final states within `states` into `finals`.
+	 * @return `true` if there is at least one final state within `states`; `false` otherwise (in which case `finals` is left untouched).
+	 */
+	template<typename TransFuncT, typename InputT>
+	bool NonDeterFiniteAutomaton<TransFuncT, InputT>::_collect_final_states(const std::pmr::vector<FSMStateType>& states, std::pmr::vector<FSMStateType>& finals) const
+	{
+		if (!this->_contains_final_state(states))
+			return false;
+
+		finals.clear();
+		for (const FSMStateType state : states)
+			if (this->_is_state_final(state))
+				finals.push_back(state);
+
+		return true;
+	}
+
+	/**
+	 * @brief Copies a set of states out of the scratch memory, to be returned as part of a result.
+	 */
+	template<typename TransFuncT, typename InputT>
+	FSMStateSetType NonDeterFiniteAutomaton<TransFuncT, InputT>::_to_state_set(const std::pmr::vector<FSMStateType>& states)
+	{
+		FSMStateSetType res;
+		res.insert(states.begin(), states.end());
 
-		std::stack<FSMStateType> stack{};
-		// initialize the stack
-		for (auto s : set)
-			stack.push(s);
-		
-		while (stack.size()) {
-			// get the last state and pop it; we will get its closure now, so we will not need it in the future
-			FSMStateType s = stack.top();
-			stack.pop();
-
-			// check if the state has at least one transition on epsilon
-			FSMStateSetType epsilonTransitions = this->m_TransitionFunc(s, '\0');
-
-			// if the set has at least a single epsilon-transition
-			if (!epsilonTransitions.empty()) {
-				/*
-				* Push all the states in the epsilon transitions onto the stack.
-				* We do this to consider whether the state itself has any epsilon transitions.
-				* This applies the recursiveness of the algorithm.
-				* Before we push a state, we check to see if it is already in the set so that we don't consider the state again.
-				* If we don't do that, we might end up with an infinite loop.
-				*/ 
-				for (const FSMStateType state : epsilonTransitions)
-					if (!res.contains(state))
-						stack.push(state);
-
-				res.insert(epsilonTransitions.begin(), epsilonTransitions.end());
-			};
-			
-		};
-		
 		return res;
 	}
-	
+
 	/**
 	* @brief Simulate the given input string using the given simulation method.
+	* @details The scratch memory of the simulation is taken from the arena of the calling thread (see ScratchArena::forThisThread()), which is reset first.
 	* @param[in] input The input string to be simulated.
 	* @param[in] mode The simulation mode.
 	* @throw UnrecognizedSimModeException Thrown in case an incorrect simulation mode is entered, which is in fact unreachable. Thus, this exception is almost impossible to throw under normal conditions.
@@ -401,13 +475,51 @@ namespace m0st4fa::fsm {
 	template<typename TransFuncT, typename InputT>
 	inline FSMResult NonDeterFiniteAutomaton<TransFuncT, InputT>::simulate(const InputT& input, FSM_MODE mode) const
 	{
+		// small machines are simulated by their bit-parallel engine, which needs no scratch memory
+		if (this->isBitParallel())
+			return this->simulate(input, mode, std::pmr::null_memory_resource());
+
+		ScratchArena& arena = ScratchArena::forThisThread();
+		arena.reset();
+
+		return this->simulate(input, mode, arena.getResource());
+	}
+
+	/**
+	* @brief Simulate the given input string using the given simulation method, allocating all scratch memory from `resource`.
+	* @param[in] input The input string to be simulated.
+	* @param[in] mode The simulation mode.
+	* @param[in] resource The memory resource that the scratch memory of the simulation is allocated from (e.g. a `std::pmr::monotonic_buffer_resource` reused across calls). The result itself is allocated normally.
+	* @throw UnrecognizedSimModeException Thrown in case an incorrect simulation mode is entered, which is in fact unreachable. Thus, this exception is almost impossible to throw under normal conditions.
+	* @return FSMResult object indicating the result of the simulation.
+	*/
+	template<typename TransFuncT, typename InputT>
+	FSMResult NonDeterFiniteAutomaton<TransFuncT, InputT>::simulate(const InputT& input, FSM_MODE mode, std::pmr::memory_resource* resource) const
+	{
+		// small machines are simulated by their bit-parallel engine
+		if (this->isBitParallel() && mode < FSM_MODE::MM_NONE)
+			return std::visit([this, &input, mode](const auto& engine) -> FSMResult {
+				if constexpr (std::is_same_v<std::decay_t<decltype(engine)>, std::monostate>)
+					throw UnrecognizedSimModeException();
+				else
+					return engine.simulate(input, mode, m_Prefilter);
+				}, *m_BitParallel);
+
+		Scratch scratch{ resource };
+
 		switch (mode) {
 		case FSM_MODE::MM_WHOLE_STRING:
-			return this->_simulate_whole_string(input);
+			return this->_simulate_whole_string(input, scratch);
 		case FSM_MODE::MM_LONGEST_PREFIX:
-			return this->_simulate_longest_prefix(input);
+			return this->_simulate_longest_prefix(input, scratch);
 		case FSM_MODE::MM_LONGEST_SUBSTRING:
-			return this->_simulate_longest_substring(input);
+			return this->_simulate_longest_substring(input, scratch);
+		case FSM_MODE::MM_COUNT:
+			return this->_simulate_count(input, scratch);
+		case FSM_MODE::MM_COUNT_ENDS:
+			return this->_simulate_count_ends(input, scratch);
+		case FSM_MODE::MM_ANY_MATCH:
+			return this->_simulate_any_match(input, scratch);
 		default:
 			this->m_Logger.log(LoggerInfo::LL_ERROR, "Unreachable: simulate() cannot reach this point. The provided mode is probably erroneous.");
 			throw UnrecognizedSimModeException();
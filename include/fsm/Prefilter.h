@@ -0,0 +1,187 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+
+#include "FiniteStateMachine.h"
+#include "ByteSearch.h"
+
+// DECLARATIONS
+namespace m0st4fa::fsm {
+
+	/**
+	 * @brief Finds the positions of an input string at which a match of some state machine can begin.
+	 * @details The prefilter is built by analyzing the transitions out of the start state of a machine: it collects the bytes that can begin a match and, if all matches begin with the same sequence of bytes, that literal sequence. Substring searches then jump from one candidate position to the next using `memchr`-like (or substring) search, instead of starting the machine at every position of the input.
+	 * @note A default-constructed prefilter is disabled: every position is a candidate.
+	 */
+	class Prefilter {
+
+		//! @brief The sequence of bytes that every match begins with (possibly empty).
+		std::string m_Literal{};
+		//! @brief The bytes that a match can begin with.
+		ByteSet m_FirstBytes{};
+		//! @brief Whether the prefilter skips any position at all.
+		bool m_Enabled = false;
+
+		IndexType _next(std::string_view, const IndexType) const noexcept;
+
+	public:
+
+		//! @brief The maximum length of the literal prefix collected by the analysis.
+		static constexpr size_t MAX_LITERAL_LENGTH = 64;
+
+		/**
+		 * @brief Default constructor. The constructed prefilter is disabled.
+		 */
+		Prefilter() = default;
+
+		template <typename TransFuncT>
+		Prefilter(const TransFuncT&, const FSMStateSetType&, const bool);
+
+		//! @brief Checks whether the prefilter skips any position at all.
+		bool isEnabled() const { return m_Enabled; };
+
+		//! @brief Gets the sequence of bytes that every match begins with (possibly empty).
+		const std::string& getLiteral() const { return m_Literal; };
+
+		//! @brief Gets the set of bytes that a match can begin with.
+		const ByteSet& getFirstBytes() const { return m_FirstBytes; };
+
+		/**
+		 * @brief Finds the first position, at or after `from`, at which a match can begin.
+		 * @param[in] input The input string being searched.
+		 * @param[in] from The index at which the search starts.
+		 * @return The index of the first candidate position, or `input.size()` if there is none. If the prefilter is disabled, or `input` is not a string of bytes, this is `from`.
+		 */
+		template <typename InputT>
+		IndexType next(const InputT& input, const IndexType from) const noexcept {
+			if constexpr (std::is_convertible_v<const InputT&, std::string_view>)
+				return m_Enabled ? this->_next(std::string_view{ input }, from) : from;
+			else
+				return from;
+		}
+
+	};
+
+}
+
+// IMPLEMENTATIONS
+namespace m0st4fa::fsm {
+
+	/**
+	 * @brief Analyzes a state machine and builds a prefilter for it.
+	 * @details If the start state is final, every position begins a (possibly empty) match, so the prefilter is disabled.
+	 * @param[in] tranFn The transition function of the machine.
+	 * @param[in] fStates The final states of the machine.
+	 * @param[in] epsilonClosure Whether transitions on `'\0'` are epsilon-transitions (as they are in epsilon NFAs).
+	 */
+	template <typename TransFuncT>
+	Prefilter::Prefilter(const TransFuncT& tranFn, const FSMStateSetType& fStates, const bool epsilonClosure)
+	{
+		constexpr FSMStateType startState = FiniteStateMachine<TransFuncT>::getStartState();
+		constexpr FSMStateType deadState = FiniteStateMachine<TransFuncT>::getDeadState();
+
+		auto isFinal = [&fStates](const FSMStateSetType& set) {
+			for (const FSMStateType state : set)
+				if (fStates.contains(state))
+					return true;
+
+			return false;
+		};
+
+		// the set of states that `set` leads to on `symbol`, ignoring the dead state
+		std::vector<FSMStateType> stack{};
+		auto step = [&](const FSMStateSetType& set, const unsigned char symbol) {
+			FSMStateSetType res;
+
+			for (const FSMStateType state : set)
+				tranFn.forEachTarget(state, symbol, [&res, &fStates](const FSMStateType target) {
+					if (target != deadState || fStates.contains(target))
+						res.insert(target);
+				});
+
+			if (epsilonClosure) {
+				stack.assign(res.begin(), res.end());
+
+				while (stack.size()) {
+					const FSMStateType s = stack.back();
+					stack.pop_back();
+
+					tranFn.forEachTarget(s, '\0', [&res, &stack](const FSMStateType target) {
+						if (!res.contains(target)) {
+							res.insert(target);
+							stack.push_back(target);
+						}
+					});
+				}
+			}
+
+			return res;
+		};
+
+		FSMStateSetType currState{ startState };
+
+		// every position begins an empty match
+		if (isFinal(currState))
+			return;
+
+		for (size_t symbol = 0; symbol < 256; symbol++)
+			if (!step(currState, static_cast<unsigned char>(symbol)).empty())
+				m_FirstBytes.insert(static_cast<unsigned char>(symbol));
+
+		// no position can be skipped
+		if (m_FirstBytes.size() == 256)
+			return;
+
+		m_Enabled = true;
+
+		// follow the path out of the start state for as long as there is only one way to go
+		while (m_Literal.size() < MAX_LITERAL_LENGTH) {
+			FSMStateSetType nextState{};
+			size_t symbolCount = 0;
+			unsigned char onlySymbol = 0;
+
+			for (size_t symbol = 0; symbol < 256 && symbolCount < 2; symbol++) {
+				FSMStateSetType tmp = step(currState, static_cast<unsigned char>(symbol));
+
+				if (tmp.empty())
+					continue;
+
+				symbolCount++;
+				onlySymbol = static_cast<unsigned char>(symbol);
+				nextState = std::move(tmp);
+			}
+
+			if (symbolCount != 1)
+				break;
+
+			m_Literal.push_back(static_cast<char>(onlySymbol));
+			currState = std::move(nextState);
+
+			// the match might end here, so it need not continue the literal
+			if (isFinal(currState))
+				break;
+		}
+	}
+
+	/**
+	 * @brief Finds the first position, at or after `from`, at which a match can begin.
+	 * @details If every match begins with a literal of at least two bytes, the literal is searched for; otherwise, the first byte that can begin a match is.
+	 */
+	inline IndexType Prefilter::_next(std::string_view input, const IndexType from) const noexcept
+	{
+		if (from >= input.size())
+			return input.size();
+
+		if (m_Literal.size() > 1) {
+			const size_t pos = input.find(m_Literal, from);
+			return pos == std::string_view::npos ? input.size() : pos;
+		}
+
+		const char* const first = input.data();
+		const char* const last = first + input.size();
+
+		return findAnyOf(first + from, last, m_FirstBytes) - first;
+	}
+
+}
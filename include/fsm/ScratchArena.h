@@ -0,0 +1,140 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <optional>
+#include <utility>
+
+// DECLARATIONS
+namespace m0st4fa::fsm {
+
+	/**
+	 * @brief A reusable arena for the scratch memory of simulations.
+	 * @details The arena hands out memory from a single buffer, bumping a pointer (`std::pmr::monotonic_buffer_resource`); deallocation is a no-op, and reset() makes the whole buffer available again. Whenever the buffer turns out to be too small, the missing memory is taken from the heap, and the buffer is grown on the next reset (up to MAX_CAPACITY), so that an arena that is reused for similar inputs soon stops allocating altogether. Conversely, a buffer that was grown is shrunk on the next reset if most of it went unused, so that a single large input does not leave its memory held for as long as the arena lives (i.e. as long as its thread, for the arenas of forThisThread()).
+	 * @note An arena must only be used by one thread at a time; forThisThread() gives every thread its own.
+	 */
+	class ScratchArena {
+
+		/**
+		 * @brief Forwards allocations to another resource, keeping count of the bytes taken.
+		 */
+		class CountingResource : public std::pmr::memory_resource {
+			std::pmr::memory_resource* m_Target = nullptr;
+			size_t m_Allocated = 0;
+
+			void* do_allocate(size_t bytes, size_t alignment) override {
+				m_Allocated += bytes;
+				return m_Target->allocate(bytes, alignment);
+			}
+
+			void do_deallocate(void* p, size_t bytes, size_t alignment) override {
+				m_Target->deallocate(p, bytes, alignment);
+			}
+
+			bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+				return this == &other;
+			}
+
+		public:
+			explicit CountingResource(std::pmr::memory_resource* target) : m_Target{ target } {};
+
+			size_t getAllocated() const { return m_Allocated; };
+			void resetAllocated() { m_Allocated = 0; };
+		};
+
+		//! @brief The buffer that memory is handed out from.
+		std::unique_ptr<std::byte[]> m_Buffer{};
+		//! @brief The size of `m_Buffer`.
+		size_t m_Capacity = 0;
+		//! @brief The size of the buffer of the new arena, which the buffer is never shrunk below.
+		size_t m_InitialCapacity = 0;
+		//! @brief Provides the memory that does not fit in `m_Buffer`.
+		CountingResource m_Upstream{ std::pmr::new_delete_resource() };
+		//! @brief Hands out the memory of `m_Buffer`.
+		std::optional<std::pmr::monotonic_buffer_resource> m_Resource{};
+		//! @brief Hands out the memory of `m_Resource`, keeping count of the bytes used since the last reset. The resource is re-created in place by every reset, so the pointer to it stays valid.
+		CountingResource m_Used{ &*m_Resource };
+
+	public:
+
+		//! @brief The size of the buffer of a new arena, in bytes.
+		static constexpr size_t DEFAULT_CAPACITY = 16 * 1024;
+
+		//! @brief The size that the buffer of an arena is grown to at most, in bytes (unless it was made larger to begin with). Simulations that need more take the rest from the heap.
+		static constexpr size_t MAX_CAPACITY = 1024 * 1024;
+
+		/**
+		 * @brief Initialize a new arena.
+		 * @param[in] capacity The initial size of its buffer, in bytes.
+		 */
+		explicit ScratchArena(const size_t capacity = DEFAULT_CAPACITY) :
+			m_Buffer{ std::make_unique<std::byte[]>(capacity) }, m_Capacity{ capacity }, m_InitialCapacity{ capacity },
+			m_Resource{ std::in_place, m_Buffer.get(), capacity, &m_Upstream }
+		{}
+
+		ScratchArena(const ScratchArena&) = delete;
+		ScratchArena& operator=(const ScratchArena&) = delete;
+
+		//! @brief Gets the memory resource that hands out the memory of the arena.
+		std::pmr::memory_resource* getResource() {
+			return &m_Used;
+		}
+
+		//! @brief Gets the size of the buffer of the arena, in bytes.
+		size_t getCapacity() const {
+			return m_Capacity;
+		}
+
+		void reset();
+
+		static ScratchArena& forThisThread();
+
+	};
+
+}
+
+// IMPLEMENTATIONS
+namespace m0st4fa::fsm {
+
+	/**
+	 * @brief Releases every allocation made from the arena at once.
+	 * @details If the buffer did not suffice since the last reset, it is regrown to fit all the memory used, though not beyond MAX_CAPACITY. If less than a quarter of it was used instead, it is shrunk to twice the memory used, though not below its initial size.
+	 * @note Any memory handed out by the arena must not be used after this is called.
+	 */
+	inline void ScratchArena::reset()
+	{
+		const size_t overflow = m_Upstream.getAllocated();
+		const size_t used = m_Used.getAllocated();
+
+		m_Resource.reset();
+		m_Upstream.resetAllocated();
+		m_Used.resetAllocated();
+
+		size_t capacity = m_Capacity;
+
+		if (overflow)
+			capacity = std::min(m_Capacity + overflow, std::max(MAX_CAPACITY, m_InitialCapacity));
+		else if (used < m_Capacity / 4)
+			capacity = std::max(used * 2, m_InitialCapacity);
+
+		if (capacity != m_Capacity) {
+			m_Capacity = capacity;
+			m_Buffer = std::make_unique<std::byte[]>(m_Capacity);
+		}
+
+		m_Resource.emplace(m_Buffer.get(), m_Capacity, &m_Upstream);
+	}
+
+	/**
+	 * @brief Gets the arena of the calling thread.
+	 * @details The arena is created on first use and lives as long as the thread.
+	 */
+	inline ScratchArena& ScratchArena::forThisThread()
+	{
+		thread_local ScratchArena arena{};
+		return arena;
+	}
+
+}
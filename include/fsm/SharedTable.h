@@ -0,0 +1,114 @@
+#pragma once
+
+#include <memory>
+#include <span>
+
+#include "FiniteStateMachine.h"
+
+// DECLARATIONS
+namespace m0st4fa::fsm {
+
+	/**
+	 * @brief A handle to an immutable transition table, shared by every copy of the handle.
+	 * @details Copying a handle copies a pointer, so machines that hold their table through one (e.g. `DeterFiniteAutomaton<TransFn<SharedTable<DFATable>>>`) are copied in constant time, and any number of them built from the same handle keep a single copy of the table. The table is laid out for simulation once, when the handle is made, and is never modified afterwards, so the machines sharing it may run on different threads.
+	 * It can be used in place of FSMTable by TransitionFunction, and forwards lookups to the table it holds.
+	 * @note The table cannot be modified through the handle; in particular, machines holding it cannot be constructed with FSM_FLAG::FF_CASE_INSENSITIVE. Fold the case of the table before sharing it instead.
+	 */
+	template <typename TableT = FSMTable>
+	class SharedTable {
+
+		//! @brief The table shared by the copies of the handle.
+		std::shared_ptr<const TableT> m_Table = std::make_shared<const TableT>();
+
+	public:
+
+		//! @brief Default constructor. The constructed handle holds an empty table.
+		SharedTable() = default;
+		//! @brief Copy constructor. The table is shared with `rhs`.
+		SharedTable(const SharedTable&) = default;
+		/**
+		 * @brief Move constructor.
+		 * @details The table is shared with `rhs` rather than taken from it, so that `rhs` (and any machine holding it) remains usable; this only costs a reference count.
+		 */
+		SharedTable(SharedTable&& rhs) noexcept : m_Table{ rhs.m_Table } {};
+		//! @brief Copy assignment operator. The table is shared with `rhs`.
+		SharedTable& operator=(const SharedTable&) = default;
+		/**
+		 * @brief Move assignment operator.
+		 * @details The table is shared with `rhs` rather than taken from it, so that `rhs` remains usable.
+		 */
+		SharedTable& operator=(SharedTable&& rhs) noexcept {
+			m_Table = rhs.m_Table;
+			return *this;
+		}
+
+		/**
+		 * @brief Initialize a new handle, which takes ownership of `table`.
+		 * @param[in] table The table to share; it is laid out for simulation right away.
+		 */
+		explicit SharedTable(TableT table) {
+			table.freeze();
+			m_Table = std::make_shared<const TableT>(std::move(table));
+		}
+
+		/**
+		 * @brief Initialize a new handle out of a table that is already shared.
+		 * @param[in] table The table to share, which must be laid out for simulation (see FSMTable::freeze() const) and must not be modified while it is shared.
+		 * @throw InvalidStateMachineArgumentsException Thrown if `table` is null.
+		 */
+		explicit SharedTable(std::shared_ptr<const TableT> table) : m_Table{ std::move(table) } {
+			if (!m_Table) {
+				const std::string message = "SharedTable: The shared table cannot be null.";
+				Logger{}.log(LoggerInfo::LL_ERROR, message);
+				throw InvalidStateMachineArgumentsException{ message };
+			}
+		}
+
+		/**
+		 * @brief Gets the states that `state` is mapped to on `input`, as a view.
+		 * @see FSMTable::targets(const FSMStateType state, const InputT input) const
+		 */
+		template<typename InputT = char>
+		std::span<const FSMStateType> targets(const FSMStateType state, const InputT input) const noexcept(true) {
+			return m_Table->targets(state, input);
+		}
+
+		/**
+		 * @brief Gets the state that `state` is mapped to on `input`, for tables that store it directly.
+		 * @see DFATable::nextState
+		 */
+		template<typename InputT = char>
+		FSMStateType nextState(const FSMStateType state, const InputT input) const noexcept(true) requires requires(const TableT& table) { { table.nextState(state, input) } -> std::same_as<FSMStateType>; } {
+			return m_Table->nextState(state, input);
+		}
+
+		/**
+		 * @brief Accesses the table entry indexed by `state` and `input`.
+		 * @return A copy of the table entry indexed by `state` and `input`.
+		 */
+		template<typename InputT = char>
+		FSMStateSetType operator()(const FSMStateType state, const InputT input) const noexcept(true) {
+			return (*m_Table)(state, input);
+		}
+
+		//! @brief Does nothing; the table was laid out for simulation when the handle was made. @see FSMTable::freeze() const
+		void freeze() const {};
+
+		//! @brief Gets the number of rows (states) of the table.
+		size_t size() const {
+			return m_Table->size();
+		}
+
+		//! @brief Gets the shared table.
+		const TableT& get() const {
+			return *m_Table;
+		}
+
+		//! @brief Gets the number of handles (hence of machines) sharing the table.
+		long getUseCount() const {
+			return m_Table.use_count();
+		}
+
+	};
+
+}
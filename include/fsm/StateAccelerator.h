@@ -0,0 +1,128 @@
+#pragma once
+
+#include <string_view>
+#include <cstdint>
+
+#include "FiniteStateMachine.h"
+#include "ByteSearch.h"
+
+// DECLARATIONS
+namespace m0st4fa::fsm {
+
+	/**
+	 * @brief Skips over runs of input on which a DFA state loops to itself.
+	 * @details The accelerator is built by analyzing every state reachable from the start state of a DFA. A state that maps all but at most `MAX_ESCAPE_BYTES` bytes to itself (e.g. "inside a comment" or "inside a string literal") is marked as accelerated, and the bytes on which it leaves itself (its escape bytes) are recorded. Once the DFA loops in such a state, the next escape byte is found using `memchr`-like search instead of following one transition at a time.
+	 * @note A default-constructed accelerator has no accelerated states.
+	 */
+	class StateAccelerator {
+
+		/**
+		 * @brief The (one-based) index into `m_EscapeBytes` of the escape bytes of each state, or 0 if the state is not accelerated.
+		 */
+		std::vector<std::uint32_t> m_Index{};
+		//! @brief The escape bytes of each accelerated state.
+		std::vector<ByteSet> m_EscapeBytes{};
+
+	public:
+
+		//! @brief The maximum number of escape bytes that an accelerated state may have.
+		static constexpr size_t MAX_ESCAPE_BYTES = 3;
+
+		/**
+		 * @brief Default constructor. The constructed accelerator has no accelerated states.
+		 */
+		StateAccelerator() = default;
+
+		template <typename TransFuncT>
+		explicit StateAccelerator(const TransFuncT&);
+
+		//! @brief Checks whether `state` is accelerated.
+		bool isAccelerated(const FSMStateType state) const {
+			return state < m_Index.size() && m_Index[state];
+		}
+
+		//! @brief Gets the number of accelerated states.
+		size_t getAcceleratedStateCount() const {
+			return m_EscapeBytes.size();
+		}
+
+		/**
+		 * @brief Finds the first position, at or after `from`, at which the DFA leaves `state`, assuming it is in `state` at `from`.
+		 * @param[in] input The input string being simulated.
+		 * @param[in] from The index of the next character to be consumed.
+		 * @param[in] state The state that the DFA is in.
+		 * @return The index of the first escape byte of `state` at or after `from`, or `input.size()` if there is none. If `state` is not accelerated, or `input` is not a string of bytes, this is `from`.
+		 */
+		template <typename InputT>
+		IndexType skip(const InputT& input, const IndexType from, const FSMStateType state) const noexcept {
+			if constexpr (std::is_convertible_v<const InputT&, std::string_view>) {
+				if (!this->isAccelerated(state))
+					return from;
+
+				const std::string_view str{ input };
+				const char* const first = str.data();
+
+				return findAnyOf(first + from, first + str.size(), m_EscapeBytes[m_Index[state] - 1]) - first;
+			}
+			else
+				return from;
+		}
+
+	};
+
+}
+
+// IMPLEMENTATIONS
+namespace m0st4fa::fsm {
+
+	/**
+	 * @brief Analyzes the states of a DFA and builds an accelerator for them.
+	 * @param[in] tranFn The transition function of the DFA.
+	 */
+	template <typename TransFuncT>
+	StateAccelerator::StateAccelerator(const TransFuncT& tranFn)
+	{
+		constexpr FSMStateType startState = FiniteStateMachine<TransFuncT>::getStartState();
+		constexpr FSMStateType deadState = FiniteStateMachine<TransFuncT>::getDeadState();
+
+		std::vector<FSMStateType> states{ startState };
+		std::vector<bool> discovered(startState + 1);
+		discovered[startState] = true;
+
+		// visit every state reachable from the start state
+		for (size_t i = 0; i < states.size(); i++) {
+			const FSMStateType state = states[i];
+			ByteSet escapeBytes{};
+
+			for (size_t symbol = 0; symbol < 256; symbol++) {
+				const FSMStateType next = tranFn.nextState(state, static_cast<unsigned char>(symbol));
+
+				if (next == state)
+					continue;
+
+				escapeBytes.insert(static_cast<unsigned char>(symbol));
+
+				if (next == deadState)
+					continue;
+
+				if (discovered.size() <= next)
+					discovered.resize(next + 1);
+
+				if (!discovered[next]) {
+					discovered[next] = true;
+					states.push_back(next);
+				}
+			}
+
+			if (escapeBytes.size() > MAX_ESCAPE_BYTES)
+				continue;
+
+			if (m_Index.size() <= state)
+				m_Index.resize(state + 1);
+
+			m_EscapeBytes.push_back(escapeBytes);
+			m_Index[state] = static_cast<std::uint32_t>(m_EscapeBytes.size());
+		}
+	}
+
+}
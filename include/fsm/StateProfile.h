@@ -0,0 +1,199 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+#include <ranges>
+#include <vector>
+
+#include "DFA.h"
+#include "DFATable.h"
+
+// DECLARATIONS
+namespace m0st4fa::fsm {
+
+	/**
+	 * @brief Counts how often each state of a DFA is visited while simulating a sample corpus.
+	 * @details A profile tells which states are hot, for renumberStates() to pack them together.
+	 */
+	class StateProfile {
+
+		//! @brief The number of visits of each state.
+		std::vector<std::uint64_t> m_Visits{};
+		//! @brief The number of inputs recorded.
+		size_t m_InputCount = 0;
+		//! @brief The number of bytes consumed while recording.
+		size_t m_ByteCount = 0;
+
+		template <typename DFAT, typename InputT>
+		void _run(const DFAT&, const InputT&, const IndexType);
+
+	public:
+
+		template <typename DFAT, typename InputT>
+		void record(const DFAT&, const InputT&, const FSM_MODE = FSM_MODE::MM_WHOLE_STRING);
+
+		/**
+		 * @brief Records the visits of simulating every input of `corpus`.
+		 * @see record
+		 */
+		template <typename DFAT, std::ranges::input_range RangeT>
+		void recordCorpus(const DFAT& dfa, const RangeT& corpus, const FSM_MODE mode = FSM_MODE::MM_WHOLE_STRING) {
+			for (const auto& input : corpus)
+				this->record(dfa, input, mode);
+		}
+
+		//! @brief Gets the number of visits of `state`.
+		std::uint64_t getVisitCount(const FSMStateType state) const {
+			return state < m_Visits.size() ? m_Visits[state] : 0;
+		}
+
+		//! @brief Gets the number of visits of each state, indexed by the state.
+		const std::vector<std::uint64_t>& getVisitCounts() const { return m_Visits; };
+
+		//! @brief Gets the number of inputs recorded.
+		size_t getInputCount() const { return m_InputCount; };
+
+		//! @brief Gets the number of bytes consumed while recording.
+		size_t getByteCount() const { return m_ByteCount; };
+
+		//! @brief Forgets every visit recorded.
+		void clear() {
+			m_Visits.clear();
+			m_InputCount = m_ByteCount = 0;
+		}
+
+	};
+
+	/**
+	 * @brief The type of the DFAs built by renumberStates().
+	 */
+	using RenumberedDFA = DeterFiniteAutomaton<TransFn<DFATable>>;
+
+	template <typename DFAT>
+	RenumberedDFA renumberStates(const DFAT&, const StateProfile&, std::vector<FSMStateType>* = nullptr);
+
+}
+
+// IMPLEMENTATIONS
+namespace m0st4fa::fsm {
+
+	/**
+	 * @brief Follows `dfa` over `input` from `start` until the end of the input or the death of the machine, counting the states it visits.
+	 */
+	template <typename DFAT, typename InputT>
+	void StateProfile::_run(const DFAT& dfa, const InputT& input, const IndexType start)
+	{
+		constexpr FSMStateType deadState = DFAT::getDeadState();
+		const auto& tranFn = dfa.getTransitionFunction();
+
+		FSMStateType state = DFAT::getStartState();
+
+		for (IndexType charIndex = start; ; charIndex++) {
+			if (m_Visits.size() <= state)
+				m_Visits.resize(size_t{ state } + 1);
+
+			m_Visits[state]++;
+
+			if (charIndex == input.size())
+				break;
+
+			m_ByteCount++;
+			state = tranFn.nextState(state, input[charIndex]);
+
+			if (state == deadState)
+				break;
+		}
+	}
+
+	/**
+	 * @brief Records the visits of simulating `input`.
+	 * @details For the modes that run the machine from the start of the input only (MM_WHOLE_STRING and MM_LONGEST_PREFIX), the machine is followed from there until it dies; for the others, it is followed from every position of the input, as a search for matches does. Unlike simulate(), no run of bytes is skipped, so every visit is counted.
+	 * @param[in] dfa The machine to profile.
+	 * @param[in] input A sample input.
+	 * @param[in] mode The simulation mode that the machine is to be run in.
+	 */
+	template <typename DFAT, typename InputT>
+	void StateProfile::record(const DFAT& dfa, const InputT& input, const FSM_MODE mode)
+	{
+		m_InputCount++;
+
+		if (mode == FSM_MODE::MM_WHOLE_STRING || mode == FSM_MODE::MM_LONGEST_PREFIX) {
+			this->_run(dfa, input, 0);
+			return;
+		}
+
+		for (IndexType start = 0; start < input.size(); start++)
+			this->_run(dfa, input, start);
+	}
+
+	/**
+	 * @brief Builds a copy of a DFA over bytes whose states are renumbered in order of decreasing visit count, so that the hot states are packed together.
+	 * @details The dead state and the start state keep their numbers (0 and 1); the other states reachable from the start state follow, the most visited first, and those visited equally often in the order of a breadth-first search, which keeps the cold states near their neighbours. Unreachable states are dropped. The result is stored as a DFATable, whose rows are laid out in the order of the states.
+	 * @param[in] dfa The DFA to renumber.
+	 * @param[in] profile The visit counts of the states of `dfa`, recorded over a sample corpus.
+	 * @param[out] originalStates If not `nullptr`, receives the original number of each new state, indexed by the new state (e.g. to tell which kind of token a final state stands for).
+	 * @return The renumbered DFA, which accepts the same language as `dfa`.
+	 */
+	template <typename DFAT>
+	RenumberedDFA renumberStates(const DFAT& dfa, const StateProfile& profile, std::vector<FSMStateType>* originalStates)
+	{
+		constexpr size_t alphabetSize = DFATable::ALPHABET_SIZE;
+		constexpr FSMStateType deadState = DFAT::getDeadState();
+		constexpr FSMStateType startState = DFAT::getStartState();
+
+		const auto& tranFn = dfa.getTransitionFunction();
+
+		// find the reachable states breadth first
+		std::vector<FSMStateType> states{ startState };
+		std::vector<bool> isReached(size_t{ startState } + 1);
+		isReached[startState] = true;
+
+		for (size_t i = 0; i < states.size(); i++)
+			for (size_t symbol = 0; symbol < alphabetSize; symbol++) {
+				const FSMStateType next = tranFn.nextState(states[i], static_cast<unsigned char>(symbol));
+
+				if (next == deadState)
+					continue;
+
+				if (isReached.size() <= next)
+					isReached.resize(size_t{ next } + 1);
+
+				if (!isReached[next]) {
+					isReached[next] = true;
+					states.push_back(next);
+				}
+			}
+
+		// the start state stays first; the rest are sorted by decreasing visit count
+		std::stable_sort(states.begin() + 1, states.end(), [&profile](const FSMStateType lhs, const FSMStateType rhs) {
+			return profile.getVisitCount(lhs) > profile.getVisitCount(rhs);
+			});
+
+		std::vector<FSMStateType> renumbered(isReached.size(), deadState);
+		for (size_t i = 0; i < states.size(); i++)
+			renumbered[states[i]] = static_cast<FSMStateType>(i + 1);
+
+		// lay the transitions out in the new order
+		std::vector<FSMStateType> transitions((states.size() + 1) * alphabetSize);
+		FSMStateSetType finalStates{};
+
+		for (size_t i = 0; i < states.size(); i++) {
+			const FSMStateType newState = static_cast<FSMStateType>(i + 1);
+
+			for (size_t symbol = 0; symbol < alphabetSize; symbol++)
+				transitions[newState * alphabetSize + symbol] = renumbered[tranFn.nextState(states[i], static_cast<unsigned char>(symbol))];
+
+			if (dfa.getFinalStates().contains(states[i]))
+				finalStates.insert(newState);
+		}
+
+		if (originalStates) {
+			originalStates->assign(1, deadState);
+			originalStates->insert(originalStates->end(), states.begin(), states.end());
+		}
+
+		return RenumberedDFA{ finalStates, TransFn<DFATable>{ DFATable::fromTransitions(transitions) } };
+	}
+
+}
@@ -0,0 +1,155 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <map>
+#include <vector>
+
+#include "FiniteStateMachine.h"
+
+// DECLARATIONS
+namespace m0st4fa::fsm {
+
+	/**
+	 * @brief A transition table of a DFA over bytes that consumes two bytes per lookup.
+	 * @details Bytes on which every state behaves identically are grouped into classes, and the table has one entry per (state, class, class) triple: the state that the DFA reaches after both bytes. The classes of the two bytes do not depend on the state, so a step of the DFA costs a single load that depends on the previous one, and the chain of dependent loads over the input is half as long.
+	 * Each entry also records whether the state after the first byte is final (MID_FINAL) and whether the state after both bytes is final (END_FINAL), so that the accepts that occur within a step are not missed, and the set of final states is not looked up at every step.
+	 * The table has `stateCount * classCount * classCount` entries, so it is only built for DFAs for which it is at most DEFAULT_MAX_SIZE bytes; otherwise it is left empty, and the DFA falls back to consuming one byte at a time.
+	 * @see FSM_FLAG::FF_STRIDE_2
+	 */
+	class StrideTable {
+	public:
+		//! @brief The number of input symbols (bytes) that the table recognizes.
+		static constexpr size_t ALPHABET_SIZE = 256;
+
+		//! @brief The default maximum size of a table, in bytes (256 KiB, about the size of an L2 cache). A table that no longer fits in the cache makes each step slower than two steps over the (much smaller) table of the DFA.
+		static constexpr size_t DEFAULT_MAX_SIZE = size_t{ 1 } << 18;
+
+		//! @brief Set in an entry if the state after the first byte is final.
+		static constexpr std::uint32_t MID_FINAL = std::uint32_t{ 1 } << 31;
+		//! @brief Set in an entry if the state after both bytes is final.
+		static constexpr std::uint32_t END_FINAL = std::uint32_t{ 1 } << 30;
+		//! @brief The bits of an entry that hold the state after both bytes.
+		static constexpr std::uint32_t STATE_MASK = END_FINAL - 1;
+
+	private:
+		//! @brief The class of each byte.
+		std::array<std::uint8_t, ALPHABET_SIZE> m_Classes{};
+		//! @brief The number of byte classes.
+		size_t m_ClassCount = 0;
+		//! @brief The number of entries of each state (`m_ClassCount * m_ClassCount`).
+		size_t m_RowSize = 0;
+		//! @brief The entry of each (state, class, class) triple, indexed by `state * m_RowSize + class * m_ClassCount + class`.
+		std::vector<std::uint32_t> m_Entries{};
+
+	public:
+
+		//! @brief Default constructor. The constructed table is empty.
+		StrideTable() = default;
+
+		template <typename TransFuncT>
+		StrideTable(const TransFuncT&, const FSMStateSetType&, const size_t = DEFAULT_MAX_SIZE);
+
+		/**
+		 * @brief Gets the entry of `state` on the bytes `first` and `second`.
+		 * @return The state after both bytes, along with the MID_FINAL and END_FINAL bits.
+		 */
+		template <typename SymbolT>
+		std::uint32_t step(const FSMStateType state, const SymbolT first, const SymbolT second) const noexcept {
+			// only the row depends on the previous step; the column is computed alongside it
+			return m_Entries[state * m_RowSize + (m_Classes[toSymbolIndex(first)] * m_ClassCount + m_Classes[toSymbolIndex(second)])];
+		}
+
+		//! @brief Checks whether the table was left empty (the DFA is too large for it).
+		bool empty() const { return m_Entries.empty(); };
+
+		//! @brief Gets the number of byte classes.
+		size_t getClassCount() const { return m_ClassCount; };
+
+		//! @brief Gets the size of the table, in bytes.
+		size_t getSizeInBytes() const { return m_Entries.size() * sizeof(std::uint32_t); };
+
+	};
+
+}
+
+// IMPLEMENTATIONS
+namespace m0st4fa::fsm {
+
+	/**
+	 * @brief Builds the table of the states of a DFA reachable from its start state, unless it would be larger than `maxSize` bytes.
+	 * @param[in] tranFn The transition function of the DFA.
+	 * @param[in] fStates The set of final states of the DFA.
+	 * @param[in] maxSize The maximum size of the table, in bytes.
+	 */
+	template <typename TransFuncT>
+	StrideTable::StrideTable(const TransFuncT& tranFn, const FSMStateSetType& fStates, const size_t maxSize)
+	{
+		constexpr FSMStateType startState = FiniteStateMachine<TransFuncT>::getStartState();
+		constexpr FSMStateType deadState = FiniteStateMachine<TransFuncT>::getDeadState();
+
+		// visit every state reachable from the start state, stopping early once there are too many of them for the table to fit even with a single class
+		std::vector<FSMStateType> states{ startState };
+		std::vector<bool> discovered(startState + 1);
+		discovered[startState] = true;
+
+		for (size_t i = 0; i < states.size() && discovered.size() * sizeof(std::uint32_t) <= maxSize; i++)
+			for (size_t symbol = 0; symbol < ALPHABET_SIZE; symbol++) {
+				const FSMStateType next = tranFn.nextState(states[i], static_cast<unsigned char>(symbol));
+
+				if (discovered.size() <= next)
+					discovered.resize(next + 1);
+
+				if (next != deadState && !discovered[next]) {
+					discovered[next] = true;
+					states.push_back(next);
+				}
+			}
+
+		const size_t stateCount = discovered.size();
+
+		// the classes need not be computed for a table that is too large anyway
+		if (stateCount > STATE_MASK || stateCount * sizeof(std::uint32_t) > maxSize)
+			return;
+
+		// group the bytes on which every reachable state behaves identically into classes
+		std::map<std::vector<FSMStateType>, std::uint8_t> classOf{};
+		std::vector<unsigned char> representatives{};
+
+		for (size_t symbol = 0; symbol < ALPHABET_SIZE; symbol++) {
+			std::vector<FSMStateType> column(states.size());
+
+			for (size_t i = 0; i < states.size(); i++)
+				column[i] = tranFn.nextState(states[i], static_cast<unsigned char>(symbol));
+
+			const auto [it, inserted] = classOf.emplace(std::move(column), static_cast<std::uint8_t>(classOf.size()));
+			if (inserted)
+				representatives.push_back(static_cast<unsigned char>(symbol));
+
+			m_Classes[symbol] = it->second;
+		}
+
+		const size_t classCount = representatives.size();
+
+		if (stateCount * classCount * classCount * sizeof(std::uint32_t) > maxSize)
+			return;
+
+		// the rows of the dead state and of unreachable states lead to the dead state
+		m_ClassCount = classCount;
+		m_RowSize = classCount * classCount;
+		m_Entries.assign(stateCount * classCount * classCount, deadState);
+
+		for (const FSMStateType state : states)
+			for (size_t first = 0; first < classCount; first++) {
+				const FSMStateType mid = tranFn.nextState(state, representatives[first]);
+				const std::uint32_t midFinal = fStates.contains(mid) ? MID_FINAL : 0;
+
+				for (size_t second = 0; second < classCount; second++) {
+					const FSMStateType end = mid == deadState ? deadState : tranFn.nextState(mid, representatives[second]);
+
+					m_Entries[state * m_RowSize + first * classCount + second] = end | midFinal | (fStates.contains(end) ? END_FINAL : 0);
+				}
+			}
+	}
+
+}
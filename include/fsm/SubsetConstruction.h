@@ -0,0 +1,384 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <barrier>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <system_error>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "DFA.h"
+#include "DFATable.h"
+
+// DECLARATIONS
+namespace m0st4fa::fsm {
+
+	/**
+	 * @brief The type of the DFAs built by subset construction.
+	 */
+	using SubsetDFA = DeterFiniteAutomaton<TransFn<DFATable>>;
+
+	//! @brief The default maximum number of states of a DFA built by subset construction.
+	constexpr size_t DEFAULT_MAX_SUBSET_STATES = size_t{ 1 } << 16;
+
+	/**
+	 * @brief A table of sets of NFA states, giving each set a unique ID, that many threads can add to at once.
+	 * @details The sets are spread over shards by their hash, each shard guarded by its own mutex, so threads only contend when they add sets of the same shard at the same time. IDs are handed out in the order the sets are added, so they depend on how the threads were scheduled.
+	 * @see determinize
+	 */
+	class StateSetInterner {
+	public:
+		//! @brief The type of a set of states: sorted, and free of duplicates.
+		using SetType = std::vector<FSMStateType>;
+
+		//! @brief The number of shards.
+		static constexpr size_t SHARD_COUNT = 64;
+
+	private:
+		//! @brief Hashes a set of states.
+		struct SetHash {
+			size_t operator()(const SetType& set) const noexcept {
+				size_t hash = set.size();
+
+				for (const FSMStateType state : set)
+					hash ^= std::hash<FSMStateType>{}(state) + 0x9e3779b97f4a7c15 + (hash << 6) + (hash >> 2);
+
+				return hash;
+			}
+		};
+
+		/**
+		 * @brief The sets whose hash falls into a shard, and their IDs.
+		 * @note Shards are aligned to cache lines, so that threads adding to different shards do not contend.
+		 */
+		struct alignas(64) Shard {
+			std::mutex mutex;
+			std::unordered_map<SetType, FSMStateType, SetHash> ids;
+		};
+
+		std::unique_ptr<Shard[]> m_Shards = std::make_unique<Shard[]>(SHARD_COUNT);
+		//! @brief The ID of the next set added.
+		std::atomic<size_t> m_Count = 0;
+
+	public:
+
+		/**
+		 * @brief Gets the ID of `set`, adding the set if it has none.
+		 * @param[in] set The set of states.
+		 * @return The ID of the set, and whether it was added by this call.
+		 */
+		std::pair<FSMStateType, bool> intern(const SetType& set) {
+			Shard& shard = m_Shards[SetHash{}(set) % SHARD_COUNT];
+			std::lock_guard lock{ shard.mutex };
+
+			if (const auto it = shard.ids.find(set); it != shard.ids.end())
+				return { it->second, false };
+
+			const FSMStateType id = static_cast<FSMStateType>(m_Count.fetch_add(1, std::memory_order_relaxed));
+			shard.ids.emplace(set, id);
+
+			return { id, true };
+		}
+
+		//! @brief Gets the number of sets added.
+		size_t size() const { return m_Count.load(std::memory_order_relaxed); };
+	};
+
+	template <typename NFAT>
+	SubsetDFA determinize(const NFAT&, size_t = std::thread::hardware_concurrency(), const size_t = DEFAULT_MAX_SUBSET_STATES);
+
+}
+
+// IMPLEMENTATIONS
+namespace m0st4fa::fsm {
+
+	/**
+	 * @brief Builds a DFA over bytes that accepts the same strings as an NFA, by subset construction, on many threads.
+	 * @details The transitions of the NFA states reachable from the start state are gathered once, up front. The sets of NFA states reachable from the start state are then explored breadth first, one level at a time. The sets of a level are shared out among the workers, which walk the transitions of each set once, bucketing their targets by byte, and intern the (epsilon-closed) set of each non-empty bucket (see StateSetInterner); the sets that are new make up the next level. The workers wait for each other at the end of every level.
+	 * The IDs handed out by the interner depend on the scheduling of the threads, so the states of the DFA are renumbered, once all of them are built, in the order a sequential breadth-first walk of its transitions (from the start state, by increasing bytes) discovers them. The DFA is thus the same, state for state, whatever the number of workers.
+	 * As in the simulation of NFAs, the start state of the DFA is the set holding the start state of the NFA alone, and the epsilon-transitions of epsilon NFAs are followed after each byte consumed. The empty set is the dead state.
+	 * @param[in] nfa The NFA, over bytes. Its transition function must not be modified while the DFA is built.
+	 * @param[in] workerCount The number of workers, including the calling thread. If it is 0 (e.g. the number of hardware threads is unknown), a single worker is used, and no thread is started. If a thread cannot be started, the DFA is built by the workers that were.
+	 * @param[in] maxStates The maximum number of states that the DFA may have, including the dead state.
+	 * @return The DFA.
+	 * @throw StateLimitExceededException Thrown if the DFA has more than `maxStates` states.
+	 * @throw InvalidStateMachineArgumentsException Thrown if the NFA accepts no string at all (a DFA must have final states).
+	 * @throw Any exception thrown by a worker (the first one thrown is rethrown once the workers stop).
+	 */
+	template <typename NFAT>
+	SubsetDFA determinize(const NFAT& nfa, size_t workerCount, const size_t maxStates)
+	{
+		using SetType = StateSetInterner::SetType;
+		using RowType = std::array<FSMStateType, DFATable::ALPHABET_SIZE>;
+
+		constexpr size_t alphabetSize = DFATable::ALPHABET_SIZE;
+		constexpr FSMStateType deadState = SubsetDFA::getDeadState();
+		constexpr FSMStateType startState = SubsetDFA::getStartState();
+		// the number of sets a worker takes off the level at once
+		constexpr size_t chunkSize = 16;
+
+		const auto& tranFn = nfa.getTransitionFunction();
+		const bool calcClosure = nfa.getMachineType() == FSM_TYPE::MT_EPSILON_NFA;
+		workerCount = std::max<size_t>(workerCount, 1);
+
+		// the set of each ID is only needed while its level is processed, so the levels hold the sets themselves
+		struct Discovered {
+			FSMStateType id;
+			SetType set;
+		};
+
+		// a transition of an NFA state
+		struct Transition {
+			unsigned char symbol;
+			FSMStateType target;
+		};
+
+		// the state of each worker, which no other worker touches during a level
+		struct alignas(64) Worker {
+			std::vector<Discovered> next{};
+			std::vector<std::pair<FSMStateType, RowType>> rows{};
+			std::vector<FSMStateType> finals{};
+			std::vector<std::uint32_t> marks{};
+			std::uint32_t generation = 0;
+			// the targets of the set being processed on each byte, before they are deduplicated and epsilon-closed
+			std::array<SetType, alphabetSize> buckets{};
+			SetType set{}, stack{};
+		};
+
+		// gather the transitions of the NFA states reachable from the start state, so that a set is walked once rather than once per byte
+		std::vector<std::vector<Transition>> nfaTransitions(startState + 1);
+		std::vector<std::vector<FSMStateType>> epsilonTargets(startState + 1);
+
+		{
+			std::vector<FSMStateType> states{ startState };
+			std::vector<bool> discovered(startState + 1);
+			discovered[startState] = true;
+
+			for (size_t i = 0; i < states.size(); i++) {
+				const FSMStateType state = states[i];
+
+				for (size_t symbol = 0; symbol < alphabetSize; symbol++)
+					tranFn.forEachTarget(state, static_cast<unsigned char>(symbol), [&, symbol](const FSMStateType target) {
+						if (target == deadState)
+							return;
+
+						if (discovered.size() <= target) {
+							discovered.resize(target + 1);
+							nfaTransitions.resize(target + 1);
+							epsilonTargets.resize(target + 1);
+						}
+
+						nfaTransitions[state].push_back({ static_cast<unsigned char>(symbol), target });
+						if (calcClosure && symbol == '\0')
+							epsilonTargets[state].push_back(target);
+
+						if (!discovered[target]) {
+							discovered[target] = true;
+							states.push_back(target);
+						}
+					});
+			}
+		}
+
+		StateSetInterner interner{};
+		interner.intern({});
+		interner.intern({ startState });
+
+		std::vector<Discovered> level{ {startState, {startState}} };
+		std::vector<Worker> workers(workerCount);
+		std::atomic<size_t> nextIndex = 0;
+		std::atomic<bool> cancelled = false;
+		std::exception_ptr error{};
+		std::mutex errorMutex{};
+
+		// computes the (epsilon-closed) set of the states of `bucket` into `worker.set`
+		auto close = [&epsilonTargets, calcClosure](Worker& worker, const SetType& bucket) {
+			SetType& set = worker.set;
+			SetType& stack = worker.stack;
+
+			// start a new generation, clearing the marks once the generations wrap around
+			if (++worker.generation == 0) {
+				std::fill(worker.marks.begin(), worker.marks.end(), 0);
+				worker.generation = 1;
+			}
+
+			auto add = [&worker, &set, &stack, calcClosure](const FSMStateType state) {
+				if (worker.marks.size() <= state)
+					worker.marks.resize(state + 1);
+
+				if (worker.marks[state] == worker.generation)
+					return;
+
+				worker.marks[state] = worker.generation;
+				set.push_back(state);
+
+				if (calcClosure)
+					stack.push_back(state);
+			};
+
+			set.clear();
+			stack.clear();
+
+			for (const FSMStateType state : bucket)
+				add(state);
+
+			while (stack.size()) {
+				const FSMStateType state = stack.back();
+				stack.pop_back();
+
+				for (const FSMStateType target : epsilonTargets[state])
+					add(target);
+			}
+
+			std::sort(set.begin(), set.end());
+		};
+
+		// processes chunks of the current level until none is left
+		auto work = [&](Worker& worker) {
+			try {
+				for (size_t first = nextIndex.fetch_add(chunkSize); first < level.size() && !cancelled.load(std::memory_order_relaxed); first = nextIndex.fetch_add(chunkSize))
+					for (size_t i = first; i < std::min(first + chunkSize, level.size()); i++) {
+						RowType& row = worker.rows.emplace_back(level[i].id, RowType{}).second;
+
+						for (const FSMStateType state : level[i].set)
+							for (const auto [symbol, target] : nfaTransitions[state])
+								worker.buckets[symbol].push_back(target);
+
+						for (size_t symbol = 0; symbol < alphabetSize; symbol++) {
+							SetType& bucket = worker.buckets[symbol];
+
+							// most bytes typically lead nowhere; the empty set is the dead state, interned up front
+							if (bucket.empty()) {
+								row[symbol] = deadState;
+								continue;
+							}
+
+							close(worker, bucket);
+							bucket.clear();
+
+							const auto [id, inserted] = interner.intern(worker.set);
+							row[symbol] = id;
+
+							if (inserted) {
+								if (id >= maxStates) {
+									const std::string message = std::format("determinize: The DFA has more than {} states.", maxStates);
+									Logger{}.log(LoggerInfo::LL_ERROR, message);
+									throw StateLimitExceededException{ message };
+								}
+
+								if (std::any_of(worker.set.begin(), worker.set.end(), [&nfa](const FSMStateType state) { return nfa.getFinalStates().contains(state); }))
+									worker.finals.push_back(id);
+
+								worker.next.push_back({ id, worker.set });
+							}
+						}
+					}
+			}
+			catch (...) {
+				std::lock_guard lock{ errorMutex };
+
+				if (!error)
+					error = std::current_exception();
+
+				cancelled = true;
+			}
+		};
+
+		// gathers the next level once every worker is done with the current one; runs on a single thread while the others wait
+		auto nextLevel = [&]() noexcept {
+			level.clear();
+
+			if (!cancelled)
+				for (Worker& worker : workers) {
+					std::move(worker.next.begin(), worker.next.end(), std::back_inserter(level));
+					worker.next.clear();
+				}
+
+			nextIndex = 0;
+		};
+
+		std::barrier sync{ static_cast<std::ptrdiff_t>(workerCount), nextLevel };
+
+		auto run = [&](Worker& worker) {
+			while (level.size()) {
+				work(worker);
+				sync.arrive_and_wait();
+			}
+		};
+
+		{
+			// the calling thread is the first worker
+			std::vector<std::jthread> threads{};
+			threads.reserve(workerCount - 1);
+
+			for (size_t i = 1; i < workerCount; i++)
+				try {
+					threads.emplace_back(run, std::ref(workers[i]));
+				}
+				catch (const std::system_error&) {
+					// the workers that cannot be started leave the barrier for good, and those that were started do their share
+					for (; i < workerCount; i++)
+						sync.arrive_and_drop();
+				}
+
+			run(workers[0]);
+		}
+
+		if (error)
+			std::rethrow_exception(error);
+
+		// gather the rows by ID; the dead state leads to itself
+		const size_t stateCount = interner.size();
+		std::vector<FSMStateType> transitions(stateCount * alphabetSize, deadState);
+		std::vector<bool> isFinal(stateCount);
+		isFinal[startState] = nfa.getFinalStates().contains(startState);
+
+		for (Worker& worker : workers) {
+			for (const auto& [id, row] : worker.rows)
+				std::copy(row.begin(), row.end(), transitions.begin() + size_t{ id } * alphabetSize);
+
+			for (const FSMStateType id : worker.finals)
+				isFinal[id] = true;
+		}
+
+		// renumber the states in the order a breadth-first walk discovers them, so that the numbering does not depend on the scheduling
+		std::vector<FSMStateType> renumbered(stateCount, deadState), order{ deadState, startState };
+		renumbered[startState] = startState;
+
+		for (size_t i = startState; i < order.size(); i++)
+			for (size_t symbol = 0; symbol < alphabetSize; symbol++) {
+				const FSMStateType target = transitions[size_t{ order[i] } * alphabetSize + symbol];
+
+				if (target != deadState && renumbered[target] == deadState) {
+					renumbered[target] = static_cast<FSMStateType>(order.size());
+					order.push_back(target);
+				}
+			}
+
+		std::vector<FSMStateType> res(stateCount * alphabetSize, deadState);
+		FSMStateSetType finalStates{};
+
+		for (size_t i = startState; i < order.size(); i++) {
+			for (size_t symbol = 0; symbol < alphabetSize; symbol++)
+				res[i * alphabetSize + symbol] = renumbered[transitions[size_t{ order[i] } * alphabetSize + symbol]];
+
+			if (isFinal[order[i]])
+				finalStates.insert(static_cast<FSMStateType>(i));
+		}
+
+		if (finalStates.empty()) {
+			const std::string message = "determinize: The DFA accepts no string.";
+			Logger{}.log(LoggerInfo::LL_ERROR, message);
+			throw InvalidStateMachineArgumentsException{ message };
+		}
+
+		return SubsetDFA{ finalStates, TransFn<DFATable>{ DFATable::fromTransitions(res) } };
+	}
+
+}
@@ -0,0 +1,193 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <map>
+#include <vector>
+
+#include "FiniteStateMachine.h"
+
+// DECLARATIONS
+namespace m0st4fa::fsm {
+
+	/**
+	 * @brief The transition table of a DFA over bytes run unanchored, i.e. with a match allowed to begin at every position.
+	 * @details Running a DFA unanchored keeps it in a set of states at once, one for each position at which a match might have begun. Each state of the table stands for one such set: on a byte, it leads to the set of the states that the start state and the states of the set lead to (the dead state left out), so an unanchored run costs a single lookup per byte, however many matches are in progress.
+	 * Bytes on which every state of the DFA behaves identically are grouped into classes, and the table has one entry per (state, class) pair, flagged with FINAL if its set holds a final state of the DFA. State EMPTY_STATE stands for the empty set (no match in progress), which is the state the run starts in.
+	 * The sets are built once, by subset construction, so the table is only built if it has at most a given number of states; otherwise it is left empty, and the DFA keeps the set of states itself.
+	 * @see DeterFiniteAutomaton::getUnanchoredTable
+	 */
+	class UnanchoredTable {
+	public:
+		//! @brief The number of input symbols (bytes) that the table recognizes.
+		static constexpr size_t ALPHABET_SIZE = 256;
+
+		//! @brief The default maximum number of states of a table (each set of states of the DFA being one), which also bounds the number of states of the DFAs that a table is built for.
+		static constexpr size_t DEFAULT_MAX_STATES = 4096;
+
+		//! @brief Set in an entry if its set holds a final state of the DFA.
+		static constexpr std::uint32_t FINAL = std::uint32_t{ 1 } << 31;
+		//! @brief The bits of an entry that hold its state.
+		static constexpr std::uint32_t STATE_MASK = FINAL - 1;
+		//! @brief The state that stands for the empty set.
+		static constexpr std::uint32_t EMPTY_STATE = 0;
+
+	private:
+		//! @brief The class of each byte.
+		std::array<std::uint8_t, ALPHABET_SIZE> m_Classes{};
+		//! @brief The number of byte classes.
+		size_t m_ClassCount = 0;
+		//! @brief The entry of each (state, class) pair, indexed by `state * m_ClassCount + class`.
+		std::vector<std::uint32_t> m_Entries{};
+		//! @brief The smallest final state of the DFA in the set of each state, or the dead state if there is none.
+		std::vector<FSMStateType> m_FinalStates{};
+
+	public:
+
+		//! @brief Default constructor. The constructed table is empty.
+		UnanchoredTable() = default;
+
+		template <typename TransFuncT>
+		UnanchoredTable(const TransFuncT&, const FSMStateSetType&, const size_t = DEFAULT_MAX_STATES);
+
+		/**
+		 * @brief Gets the entry of `state` on `symbol`.
+		 * @param[in] state A state of the table, without the FINAL bit.
+		 * @return The next state, along with the FINAL bit.
+		 */
+		template <typename SymbolT>
+		std::uint32_t step(const std::uint32_t state, const SymbolT symbol) const noexcept {
+			return m_Entries[state * m_ClassCount + m_Classes[toSymbolIndex(symbol)]];
+		}
+
+		//! @brief Gets the smallest final state of the DFA in the set of `state`, or the dead state if there is none.
+		FSMStateType getFinalState(const std::uint32_t state) const { return m_FinalStates[state & STATE_MASK]; };
+
+		//! @brief Checks whether the table was left empty (the DFA has too many sets of states for it).
+		bool empty() const { return m_Entries.empty(); };
+
+		//! @brief Gets the number of states of the table.
+		size_t size() const { return m_FinalStates.size(); };
+
+		//! @brief Gets the number of byte classes.
+		size_t getClassCount() const { return m_ClassCount; };
+
+		//! @brief Gets the size of the table, in bytes.
+		size_t getSizeInBytes() const { return m_Entries.size() * sizeof(std::uint32_t) + m_FinalStates.size() * sizeof(FSMStateType); };
+
+	};
+
+}
+
+// IMPLEMENTATIONS
+namespace m0st4fa::fsm {
+
+	/**
+	 * @brief Builds the table of a DFA, unless the DFA or the table would have more than `maxStates` states.
+	 * @param[in] tranFn The transition function of the DFA.
+	 * @param[in] fStates The set of final states of the DFA.
+	 * @param[in] maxStates The maximum number of states of the DFA (reachable from its start state) and of the table.
+	 */
+	template <typename TransFuncT>
+	UnanchoredTable::UnanchoredTable(const TransFuncT& tranFn, const FSMStateSetType& fStates, const size_t maxStates)
+	{
+		constexpr FSMStateType startState = FiniteStateMachine<TransFuncT>::getStartState();
+		constexpr FSMStateType deadState = FiniteStateMachine<TransFuncT>::getDeadState();
+
+		// visit every state reachable from the start state, giving up once there are too many of them
+		std::vector<FSMStateType> states{ startState };
+		std::vector<bool> discovered(startState + 1);
+		discovered[startState] = true;
+
+		for (size_t i = 0; i < states.size(); i++)
+			for (size_t symbol = 0; symbol < ALPHABET_SIZE; symbol++) {
+				const FSMStateType next = tranFn.nextState(states[i], static_cast<unsigned char>(symbol));
+
+				if (next == deadState)
+					continue;
+
+				if (discovered.size() <= next)
+					discovered.resize(next + 1);
+
+				if (!discovered[next]) {
+					if (states.size() >= maxStates)
+						return;
+
+					discovered[next] = true;
+					states.push_back(next);
+				}
+			}
+
+		// group the bytes on which every reachable state behaves identically into classes
+		std::map<std::vector<FSMStateType>, std::uint8_t> classOf{};
+		std::vector<unsigned char> representatives{};
+
+		for (size_t symbol = 0; symbol < ALPHABET_SIZE; symbol++) {
+			std::vector<FSMStateType> column(states.size());
+
+			for (size_t i = 0; i < states.size(); i++)
+				column[i] = tranFn.nextState(states[i], static_cast<unsigned char>(symbol));
+
+			const auto [it, inserted] = classOf.emplace(std::move(column), static_cast<std::uint8_t>(classOf.size()));
+			if (inserted)
+				representatives.push_back(static_cast<unsigned char>(symbol));
+
+			m_Classes[symbol] = it->second;
+		}
+
+		const size_t classCount = representatives.size();
+
+		// build the sets of states breadth first, the empty set first
+		std::map<std::vector<FSMStateType>, std::uint32_t> ids{ {{}, EMPTY_STATE} };
+		std::vector<std::vector<FSMStateType>> sets{ {} };
+		std::vector<std::uint32_t> entries{};
+		std::vector<FSMStateType> finalStates{};
+		// the last set each state was added to, to add it once
+		std::vector<size_t> marks(discovered.size());
+		size_t generation = 0;
+		std::vector<FSMStateType> next{};
+
+		for (size_t i = 0; i < sets.size(); i++) {
+			const auto finalState = std::find_if(sets[i].begin(), sets[i].end(), [&fStates](const FSMStateType state) { return fStates.contains(state); });
+			finalStates.push_back(finalState == sets[i].end() ? deadState : *finalState);
+
+			for (size_t c = 0; c < classCount; c++) {
+				next.clear();
+				generation++;
+
+				auto add = [&](const FSMStateType state) {
+					const FSMStateType target = tranFn.nextState(state, representatives[c]);
+
+					if (target != deadState && marks[target] != generation) {
+						marks[target] = generation;
+						next.push_back(target);
+					}
+				};
+
+				// a match might begin at every position
+				add(startState);
+				for (const FSMStateType state : sets[i])
+					add(state);
+
+				std::sort(next.begin(), next.end());
+
+				const auto [it, inserted] = ids.try_emplace(next, static_cast<std::uint32_t>(sets.size()));
+				if (inserted) {
+					if (sets.size() >= maxStates)
+						return;
+
+					sets.push_back(next);
+				}
+
+				const bool isFinal = std::any_of(next.begin(), next.end(), [&fStates](const FSMStateType state) { return fStates.contains(state); });
+				entries.push_back(it->second | (isFinal ? FINAL : 0));
+			}
+		}
+
+		m_ClassCount = classCount;
+		m_Entries = std::move(entries);
+		m_FinalStates = std::move(finalStates);
+	}
+
+}
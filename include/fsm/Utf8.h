@@ -0,0 +1,327 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <format>
+#include <map>
+#include <span>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "FiniteStateMachine.h"
+
+// DECLARATIONS
+namespace m0st4fa::fsm {
+
+	/**
+	 * @brief An inclusive range of Unicode code points.
+	 */
+	struct CodePointRange {
+		//! @brief The first code point of the range.
+		char32_t first = 0;
+		//! @brief The last code point of the range.
+		char32_t last = 0;
+
+		bool operator==(const CodePointRange&) const = default;
+	};
+
+	/**
+	 * @brief An inclusive range of bytes.
+	 */
+	struct ByteRange {
+		//! @brief The first byte of the range.
+		std::uint8_t first = 0;
+		//! @brief The last byte of the range.
+		std::uint8_t last = 0;
+
+		bool operator==(const ByteRange&) const = default;
+	};
+
+	/**
+	 * @brief A sequence of byte ranges that matches the UTF-8 encodings of a range of code points: those whose `i`-th byte is within the `i`-th range, for every `i`.
+	 * @see toUtf8Sequences
+	 */
+	struct Utf8Sequence {
+		//! @brief The range of each byte of the encodings; only the first `length` ranges are used.
+		std::array<ByteRange, 4> ranges{};
+		//! @brief The number of bytes of the encodings.
+		size_t length = 0;
+
+		//! @brief Gets the byte ranges of the sequence.
+		std::span<const ByteRange> getRanges() const { return { ranges.data(), length }; };
+	};
+
+	//! @brief The largest Unicode code point.
+	constexpr char32_t MAX_CODE_POINT = 0x10FFFF;
+
+	void appendUtf8(std::string&, const char32_t);
+
+	std::vector<Utf8Sequence> toUtf8Sequences(std::vector<CodePointRange>);
+
+	FSMStateType addUtf8Ranges(FSMTable&, const FSMStateType, const FSMStateType, const std::vector<CodePointRange>&, FSMStateType);
+
+	IndexType toCodePointOffset(std::string_view, const IndexType);
+
+	IndexType toByteOffset(std::string_view, const IndexType);
+
+	Indicies toCodePointIndicies(std::string_view, const Indicies&);
+
+}
+
+// IMPLEMENTATIONS
+namespace m0st4fa::fsm {
+
+	/**
+	 * @brief Appends the UTF-8 encoding of `codePoint` to `str`.
+	 * @throw InvalidStateMachineArgumentsException Thrown if `codePoint` is a surrogate or beyond MAX_CODE_POINT.
+	 */
+	inline void appendUtf8(std::string& str, const char32_t codePoint)
+	{
+		if (codePoint > MAX_CODE_POINT || (codePoint >= 0xD800 && codePoint <= 0xDFFF)) {
+			const std::string message = "appendUtf8: The code point cannot be encoded in UTF-8.";
+			Logger{}.log(LoggerInfo::LL_ERROR, message);
+			throw InvalidStateMachineArgumentsException{ message };
+		}
+
+		if (codePoint < 0x80)
+			str += static_cast<char>(codePoint);
+		else if (codePoint < 0x800) {
+			str += static_cast<char>(0xC0 | (codePoint >> 6));
+			str += static_cast<char>(0x80 | (codePoint & 0x3F));
+		}
+		else if (codePoint < 0x10000) {
+			str += static_cast<char>(0xE0 | (codePoint >> 12));
+			str += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+			str += static_cast<char>(0x80 | (codePoint & 0x3F));
+		}
+		else {
+			str += static_cast<char>(0xF0 | (codePoint >> 18));
+			str += static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F));
+			str += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+			str += static_cast<char>(0x80 | (codePoint & 0x3F));
+		}
+	}
+
+	/**
+	 * @brief Splits ranges of code points into sequences of byte ranges that match exactly their UTF-8 encodings.
+	 * @details The ranges are merged, and surrogates (which have no UTF-8 encoding) are left out. Each range is then split where the length of the encodings changes, and further until the encodings of each part differ only in a suffix of bytes that each span all continuation bytes, so that each byte of the part ranges independently. This is the algorithm of RE2 and Rust's `regex` (`utf8-ranges`).
+	 * The sequences are in increasing order of code points; the byte ranges of any two of them at the same position, after the same prefix, are either equal or disjoint, so they can be added to a DFA as a trie.
+	 * @param[in] ranges The ranges of code points, in any order; they may overlap.
+	 * @return The sequences of byte ranges.
+	 * @throw InvalidStateMachineArgumentsException Thrown if a range is empty or goes beyond MAX_CODE_POINT.
+	 */
+	inline std::vector<Utf8Sequence> toUtf8Sequences(std::vector<CodePointRange> ranges)
+	{
+		if (std::any_of(ranges.begin(), ranges.end(), [](const CodePointRange& range) { return range.first > range.last || range.last > MAX_CODE_POINT; })) {
+			const std::string message = "toUtf8Sequences: Every range must be non-empty and made of valid code points.";
+			Logger{}.log(LoggerInfo::LL_ERROR, message);
+			throw InvalidStateMachineArgumentsException{ message };
+		}
+
+		// merge the ranges that overlap or touch
+		std::sort(ranges.begin(), ranges.end(), [](const CodePointRange& lhs, const CodePointRange& rhs) { return lhs.first < rhs.first; });
+
+		std::vector<CodePointRange> merged{};
+		for (const CodePointRange& range : ranges) {
+			if (merged.size() && range.first <= merged.back().last + 1)
+				merged.back().last = std::max(merged.back().last, range.last);
+			else
+				merged.push_back(range);
+		}
+
+		// the ranges left to split, the next one at the back
+		std::vector<CodePointRange> stack{};
+		for (auto it = merged.rbegin(); it != merged.rend(); it++) {
+			// leave out the surrogates
+			if (it->first < 0xD800 && it->last > 0xDFFF) {
+				stack.push_back({ 0xE000, it->last });
+				stack.push_back({ it->first, 0xD7FF });
+			}
+			else if (it->first >= 0xD800 && it->last <= 0xDFFF)
+				continue;
+			else if (it->first >= 0xD800 && it->first <= 0xDFFF)
+				stack.push_back({ 0xE000, it->last });
+			else if (it->last >= 0xD800 && it->last <= 0xDFFF)
+				stack.push_back({ it->first, 0xD7FF });
+			else
+				stack.push_back(*it);
+		}
+
+		constexpr std::array<char32_t, 3> lengthLimits{ 0x7F, 0x7FF, 0xFFFF };
+		std::vector<Utf8Sequence> res{};
+
+		while (stack.size()) {
+			const CodePointRange range = stack.back();
+			stack.pop_back();
+
+			// split where the length of the encodings changes
+			const auto limit = std::find_if(lengthLimits.begin(), lengthLimits.end(), [&range](const char32_t l) { return range.first <= l && l < range.last; });
+			if (limit != lengthLimits.end()) {
+				stack.push_back({ *limit + 1, range.last });
+				stack.push_back({ range.first, *limit });
+				continue;
+			}
+
+			std::string first{}, last{};
+			appendUtf8(first, range.first);
+			appendUtf8(last, range.last);
+
+			// split until every byte after the first one that differs spans all continuation bytes
+			bool isSplit = false;
+
+			for (size_t i = 1; i < first.size() && !isSplit; i++) {
+				const char32_t mask = (char32_t{ 1 } << (6 * i)) - 1;
+
+				if ((range.first & ~mask) == (range.last & ~mask))
+					continue;
+
+				if (range.first & mask) {
+					stack.push_back({ (range.first | mask) + 1, range.last });
+					stack.push_back({ range.first, range.first | mask });
+					isSplit = true;
+				}
+				else if ((range.last & mask) != mask) {
+					stack.push_back({ range.last & ~mask, range.last });
+					stack.push_back({ range.first, (range.last & ~mask) - 1 });
+					isSplit = true;
+				}
+			}
+
+			if (isSplit)
+				continue;
+
+			Utf8Sequence& sequence = res.emplace_back();
+			sequence.length = first.size();
+
+			for (size_t i = 0; i < first.size(); i++)
+				sequence.ranges[i] = ByteRange{ static_cast<std::uint8_t>(first[i]), static_cast<std::uint8_t>(last[i]) };
+		}
+
+		return res;
+	}
+
+	/**
+	 * @brief Adds transitions to a table so that `from` leads to `to` on the UTF-8 encoding of any code point within `ranges`.
+	 * @details The ranges are compiled into sequences of byte ranges (see toUtf8Sequences()), which are added as a trie of intermediate states, so the table stays on bytes: its rows never grow beyond 256 entries, however large the code points are. The sequences share their common prefixes, and so do sequences added by earlier calls: if a state already leads to a single state on every byte of a range (e.g. on a lead byte shared with ranges added before), that state is reused rather than replaced, and new intermediate states are only taken for the ranges on which there are no transitions yet. The transitions therefore stay deterministic, and the encodings added before keep leading where they did.
+	 * @param table The table to add the transitions to.
+	 * @param[in] from The state that the encodings begin at.
+	 * @param[in] to The state that the encodings end at.
+	 * @param[in] ranges The ranges of code points.
+	 * @param[in] firstFree The first of the states, unused by `table`, that may be taken by the intermediate states; the ones after it are taken in order.
+	 * @return The first state after the intermediate states taken.
+	 * @throw InvalidStateMachineArgumentsException Thrown if a range is invalid, or if a range of bytes conflicts with the transitions already in the table: its bytes lead to different states (or to several states at once), or its last byte leads to a state other than `to`.
+	 */
+	inline FSMStateType addUtf8Ranges(FSMTable& table, const FSMStateType from, const FSMStateType to, const std::vector<CodePointRange>& ranges, FSMStateType firstFree)
+	{
+		constexpr FSMStateType deadState = FiniteStateMachine<FSMTable>::getDeadState();
+
+		auto conflict = [](const FSMStateType state, const ByteRange range) {
+			const std::string message = std::format("addUtf8Ranges: The transitions of state {} on the bytes [{:#x}, {:#x}] conflict with the transitions already in the table.", state, range.first, range.last);
+			Logger{}.log(LoggerInfo::LL_ERROR, message);
+			throw InvalidStateMachineArgumentsException{ message };
+		};
+
+		// gets the state that `state` already leads to on every byte of `range`, or the dead state if there are no such transitions
+		auto existingTarget = [&table, &conflict, deadState](const FSMStateType state, const ByteRange range) {
+			FSMStateType target = deadState;
+
+			for (size_t byte = range.first; byte <= range.last; byte++) {
+				const FSMStateSetType& entry = std::as_const(table)(state, static_cast<unsigned char>(byte));
+
+				if (entry.size() > 1)
+					conflict(state, range);
+
+				const FSMStateType next = static_cast<FSMStateType>(entry);
+
+				if (byte == range.first)
+					target = next;
+				else if (next != target)
+					conflict(state, range);
+			}
+
+			return target;
+		};
+
+		// the intermediate state reached from each state on each range of bytes
+		std::map<std::tuple<FSMStateType, std::uint8_t, std::uint8_t>, FSMStateType> nextOf{};
+
+		for (const Utf8Sequence& sequence : toUtf8Sequences(ranges)) {
+			FSMStateType state = from;
+
+			for (size_t i = 0; i < sequence.length; i++) {
+				const ByteRange range = sequence.ranges[i];
+				FSMStateType next = to;
+
+				if (i + 1 < sequence.length) {
+					const auto [it, inserted] = nextOf.try_emplace({ state, range.first, range.last }, firstFree);
+
+					if (inserted) {
+						// reuse the intermediate state of the ranges already in the table
+						if (const FSMStateType target = existingTarget(state, range); target != deadState)
+							it->second = target;
+						else
+							firstFree++;
+					}
+
+					next = it->second;
+				}
+				else if (const FSMStateType target = existingTarget(state, range); target != deadState && target != to)
+					conflict(state, range);
+
+				for (size_t byte = range.first; byte <= range.last; byte++)
+					table(state, static_cast<unsigned char>(byte)) = next;
+
+				state = next;
+			}
+		}
+
+		return firstFree;
+	}
+
+	/**
+	 * @brief Converts an offset in bytes within a UTF-8 string into an offset in code points.
+	 * @details The code points are counted by their leading bytes, so an offset within the encoding of a code point counts it. Invalid bytes count as code points of their own.
+	 * @param[in] str The UTF-8 string.
+	 * @param[in] byteOffset The offset in bytes, at most `str.size()`.
+	 * @return The number of code points that begin before `byteOffset`.
+	 */
+	inline IndexType toCodePointOffset(std::string_view str, const IndexType byteOffset)
+	{
+		const std::string_view prefix = str.substr(0, byteOffset);
+
+		return std::count_if(prefix.begin(), prefix.end(), [](const char c) { return (static_cast<unsigned char>(c) & 0xC0) != 0x80; });
+	}
+
+	/**
+	 * @brief Converts an offset in code points within a UTF-8 string into an offset in bytes.
+	 * @param[in] str The UTF-8 string.
+	 * @param[in] codePointOffset The offset in code points.
+	 * @return The offset of the leading byte of the code point at `codePointOffset`, or `str.size()` if the string has no more code points.
+	 */
+	inline IndexType toByteOffset(std::string_view str, const IndexType codePointOffset)
+	{
+		IndexType count = 0;
+
+		for (IndexType i = 0; i < str.size(); i++)
+			if ((static_cast<unsigned char>(str[i]) & 0xC0) != 0x80 && count++ == codePointOffset)
+				return i;
+
+		return str.size();
+	}
+
+	/**
+	 * @brief Converts indicies in bytes within a UTF-8 string (as reported by simulations over bytes) into indicies in code points.
+	 * @see toCodePointOffset
+	 */
+	inline Indicies toCodePointIndicies(std::string_view str, const Indicies& indicies)
+	{
+		const IndexType start = toCodePointOffset(str, indicies.start);
+
+		return Indicies{ start, start + toCodePointOffset(str.substr(indicies.start), indicies.end - indicies.start) };
+	}
+
+}
@@ -1,10 +1,1122 @@
 #include "fsm.h"
+#include "fsm/AhoCorasick.h"
+#include "fsm/BatchMatcher.h"
+#include "fsm/CombTable.h"
+#include "fsm/DFAProduct.h"
+#include "fsm/MultiDFARunner.h"
+#include "fsm/NFA.h"
+#include "fsm/SharedTable.h"
+#include "fsm/IncrementalTokenizer.h"
+#include "fsm/IntervalTable.h"
+#include "fsm/LineSearch.h"
+#include "fsm/MatchStream.h"
+#include "fsm/StateProfile.h"
+#include "fsm/StrideTable.h"
+#include "fsm/SubsetConstruction.h"
+#include "fsm/Utf8.h"
 #include "gtest/gtest.h"
 
+#include <random>
+
 using FSMStateSetType = m0st4fa::fsm::FSMStateSetType;
 using TableType = m0st4fa::fsm::FSMTable;
 using TranFn = m0st4fa::fsm::TransFn<TableType>;
 using DFAType = m0st4fa::fsm::DeterFiniteAutomaton<TranFn>;
 using Result = m0st4fa::fsm::FSMResult;
 
-INSTANTIATE_TYPED_TEST_SUITE_P(DFATests, FSMTests, DFAType);
\ No newline at end of file
+INSTANTIATE_TYPED_TEST_SUITE_P(DFATests, FSMTests, DFAType);
+
+TEST(DFATests, stateAcceleration) {
+
+	using enum m0st4fa::fsm::FSM_MODE;
+	using m0st4fa::fsm::Indicies;
+
+	// a C-style comment: /\/\*([^*]|\*+[^*\/])*\*+\//
+	TableType table{};
+	table(1, '/') = 2;
+	table(2, '*') = 3;
+	for (int c = 0; c < 256; c++) {
+		table(3, (unsigned char)c) = c == '*' ? 4 : 3;
+		table(4, (unsigned char)c) = c == '*' ? 4 : c == '/' ? 5 : 3;
+	}
+
+	DFAType testDFA{ {5}, TranFn{ table } };
+
+	// only the "inside the comment" state is accelerated
+	EXPECT_TRUE(testDFA.getAccelerator().isAccelerated(3));
+	EXPECT_FALSE(testDFA.getAccelerator().isAccelerated(4));
+	EXPECT_EQ(testDFA.getAccelerator().getAcceleratedStateCount(), 1);
+
+	const std::string body = std::string(1000, 'x') + "*" + std::string(1000, '\xFF') + "**" + std::string(100, 'y');
+	const std::string comment = "/*" + body + "*/";
+	const std::string str = "int /**/ x; " + comment + " y; /* unterminated";
+
+	EXPECT_TRUE(testDFA.simulate(comment, MM_WHOLE_STRING).accepted);
+	EXPECT_FALSE(testDFA.simulate(comment + " ", MM_WHOLE_STRING).accepted);
+	EXPECT_EQ(testDFA.simulate(comment + comment, MM_LONGEST_PREFIX).indicies, (Indicies{ 0, comment.size() }));
+	EXPECT_EQ(testDFA.simulate(str, MM_LONGEST_SUBSTRING).indicies, (Indicies{ 12, 12 + comment.size() }));
+	EXPECT_FALSE(testDFA.simulate("/*" + body, MM_LONGEST_SUBSTRING).accepted);
+}
+
+TEST(DFATests, ahoCorasick) {
+
+	using enum m0st4fa::fsm::FSM_MODE;
+	using m0st4fa::fsm::Indicies;
+	using m0st4fa::fsm::LiteralMatch;
+
+	const m0st4fa::fsm::AhoCorasick dict{ { "he", "she", "his", "hers", "he" } };
+	const std::string str = "ushers and his sheep";
+
+	const std::vector<LiteralMatch> expected{
+		{1, {1, 4}}, {0, {2, 4}}, {4, {2, 4}}, {3, {2, 6}},
+		{2, {11, 14}}, {1, {15, 18}}, {0, {16, 18}}, {4, {16, 18}}
+	};
+
+	EXPECT_EQ(dict.getLiteralCount(), 5);
+	EXPECT_EQ(dict.findAll(str), expected);
+	EXPECT_TRUE(dict.findAll("no hits").empty());
+
+	// the automaton is a DFA whose final states end some literal
+	EXPECT_EQ(dict.getAutomaton().simulate(str, MM_LONGEST_PREFIX).indicies, (Indicies{ 0, 18 }));
+	EXPECT_TRUE(dict.getAutomaton().simulate("ushe", MM_WHOLE_STRING).accepted);
+	EXPECT_FALSE(dict.getAutomaton().simulate("hi", MM_WHOLE_STRING).accepted);
+
+	EXPECT_THROW(m0st4fa::fsm::AhoCorasick({ "a", "" }), m0st4fa::fsm::InvalidStateMachineArgumentsException);
+
+	// compiling an FSMTable into a dense table keeps its transitions
+	TableType table{};
+	table.set(1, std::string{ "abc" });
+	const m0st4fa::fsm::DFATable dense{ table };
+	using DenseDFAType = m0st4fa::fsm::DeterFiniteAutomaton<m0st4fa::fsm::TransFn<m0st4fa::fsm::DFATable>>;
+	const DenseDFAType denseDFA{ {4}, m0st4fa::fsm::TransFn<m0st4fa::fsm::DFATable>{ dense } };
+
+	EXPECT_EQ(dense.getClassCount(), 4);
+	EXPECT_EQ(denseDFA.simulate("xxabcx", MM_LONGEST_SUBSTRING).indicies, (Indicies{ 2, 5 }));
+	EXPECT_FALSE(denseDFA.simulate("ab", MM_WHOLE_STRING).accepted);
+}
+
+TEST(DFATests, batchMatcher) {
+
+	using enum m0st4fa::fsm::FSM_MODE;
+
+	// /[0-9]+/
+	TableType table{};
+	for (char c = '0'; c <= '9'; c++)
+		table(1, c) = table(2, c) = 2;
+
+	const DFAType testDFA{ {2}, TranFn{ table } };
+
+	// records of very different sizes, so that workers have to steal
+	std::vector<std::string> inputs{};
+	for (size_t i = 0; i < 2000; i++)
+		inputs.push_back(std::string(i % 97 == 0 ? 20000 : i % 13, 'x') + (i % 3 ? std::to_string(i) : ""));
+
+	m0st4fa::fsm::BatchMatcher<DFAType> matcher{ testDFA, 4 };
+	const std::vector<Result> results = matcher.simulate(std::span<const std::string>{ inputs }, MM_LONGEST_SUBSTRING);
+
+	ASSERT_EQ(results.size(), inputs.size());
+	for (size_t i = 0; i < inputs.size(); i++) {
+		const Result expected = testDFA.simulate(inputs[i], MM_LONGEST_SUBSTRING);
+		EXPECT_EQ(results[i].accepted, expected.accepted);
+		EXPECT_EQ(results[i].indicies, expected.indicies);
+	}
+
+	size_t inputCount = 0;
+	for (const m0st4fa::fsm::WorkerStats& stats : matcher.getStats())
+		inputCount += stats.inputCount;
+
+	EXPECT_EQ(matcher.getWorkerCount(), 4);
+	EXPECT_EQ(inputCount, inputs.size());
+
+	// a failing simulation is reported to the caller
+	EXPECT_THROW(matcher.simulate(std::span<const std::string>{ inputs }, MM_NONE), m0st4fa::fsm::UnrecognizedSimModeException);
+}
+
+TEST(DFATests, productConstruction) {
+
+	using enum m0st4fa::fsm::FSM_MODE;
+	using enum m0st4fa::fsm::PRODUCT_OPERATION;
+	using m0st4fa::fsm::Indicies;
+
+	// identifiers: /[a-z]+/
+	TableType identTable{};
+	for (char c = 'a'; c <= 'z'; c++)
+		identTable(1, c) = identTable(2, c) = 2;
+
+	// reserved words: /if|in/
+	TableType keywordTable{};
+	keywordTable(1, 'i') = 2;
+	keywordTable(2, 'f') = 3;
+	keywordTable(2, 'n') = 3;
+
+	const DFAType ident{ {2}, TranFn{ identTable } };
+	const DFAType keyword{ {3}, TranFn{ keywordTable } };
+
+	const auto nonReserved = m0st4fa::fsm::makeProductDFA(ident, keyword, PO_DIFFERENCE);
+	const auto both = m0st4fa::fsm::makeProductDFA(ident, keyword, PO_INTERSECTION);
+	const auto either = m0st4fa::fsm::makeProductDFA(keyword, ident, PO_UNION);
+	const auto complement = m0st4fa::fsm::makeComplementDFA(keyword);
+
+	for (const std::string_view str : { "if", "in", "i", "ifs", "x", "", "if1", "1" }) {
+		const bool isIdent = ident.simulate(str, MM_WHOLE_STRING).accepted;
+		const bool isKeyword = keyword.simulate(str, MM_WHOLE_STRING).accepted;
+
+		EXPECT_EQ(nonReserved.simulate(str, MM_WHOLE_STRING).accepted, isIdent && !isKeyword) << str;
+		EXPECT_EQ(both.simulate(str, MM_WHOLE_STRING).accepted, isIdent && isKeyword) << str;
+		EXPECT_EQ(either.simulate(str, MM_WHOLE_STRING).accepted, isIdent || isKeyword) << str;
+		EXPECT_EQ(complement.simulate(str, MM_WHOLE_STRING).accepted, !isKeyword) << str;
+	}
+
+	// pairs from which no final state can be reached are trimmed: only "i" and "if"/"in" remain
+	EXPECT_EQ(both.getFinalStates().size(), 1);
+	EXPECT_EQ(both.simulate("xx in yy", MM_LONGEST_SUBSTRING).indicies, (Indicies{ 3, 5 }));
+
+	// the reachable pairs are (1, 1), (2, 2), (2, 3), (2, 0) and (0, 0)
+	EXPECT_THROW(m0st4fa::fsm::makeProductDFA(ident, keyword, PO_UNION, 4), m0st4fa::fsm::StateLimitExceededException);
+	EXPECT_NO_THROW(m0st4fa::fsm::makeProductDFA(ident, keyword, PO_UNION, 5));
+	EXPECT_THROW(m0st4fa::fsm::makeProductDFA(keyword, ident, PO_DIFFERENCE), m0st4fa::fsm::InvalidStateMachineArgumentsException);
+}
+
+TEST(DFATests, multiDFARunner) {
+
+	using enum m0st4fa::fsm::FSM_MODE;
+
+	// /[0-9]+/, /[a-z]+/, /ab*/ and /if/
+	std::vector<TableType> tables(4);
+	for (char c = '0'; c <= '9'; c++)
+		tables[0](1, c) = tables[0](2, c) = 2;
+	for (char c = 'a'; c <= 'z'; c++)
+		tables[1](1, c) = tables[1](2, c) = 2;
+	tables[2](1, 'a') = 2;
+	tables[2](2, 'b') = 2;
+	tables[3].set(1, std::string{ "if" });
+
+	std::vector<DFAType> machines{};
+	machines.emplace_back(FSMStateSetType{ 2 }, TranFn{ tables[0] });
+	machines.emplace_back(FSMStateSetType{ 2 }, TranFn{ tables[1] });
+	machines.emplace_back(FSMStateSetType{ 2 }, TranFn{ tables[2] });
+	machines.emplace_back(FSMStateSetType{ 3 }, TranFn{ tables[3] });
+
+	const m0st4fa::fsm::MultiDFARunner runner{ machines };
+	EXPECT_EQ(runner.getMachineCount(), 4);
+
+	// the results are the same as those of running every machine on its own
+	for (const std::string_view str : { "abbb", "if", "123", "if 123 abbbbb", "", "x1", "abba" })
+		for (const auto mode : { MM_WHOLE_STRING, MM_LONGEST_PREFIX, MM_LONGEST_SUBSTRING }) {
+			const std::vector<Result> results = runner.simulate(str, mode);
+			ASSERT_EQ(results.size(), machines.size());
+
+			for (size_t i = 0; i < machines.size(); i++) {
+				const Result expected = machines[i].simulate(str, mode);
+				EXPECT_EQ(results[i].accepted, expected.accepted) << str << " " << i;
+				EXPECT_EQ(results[i].indicies, expected.indicies) << str << " " << i;
+				EXPECT_EQ(std::set<m0st4fa::fsm::FSMStateType>(results[i].finalState), std::set<m0st4fa::fsm::FSMStateType>(expected.finalState)) << str << " " << i;
+			}
+		}
+}
+
+TEST(DFATests, incrementalTokenizer) {
+
+	using m0st4fa::fsm::Token;
+	using Tokenizer = m0st4fa::fsm::IncrementalTokenizer<DFAType>;
+
+	// identifiers (2), numbers (3), runs of spaces (4) and the operators "-" (5) and "->" (6)
+	TableType table{};
+	for (char c = 'a'; c <= 'z'; c++)
+		table(1, c) = table(2, c) = 2;
+	for (char c = '0'; c <= '9'; c++)
+		table(1, c) = table(3, c) = 3;
+	table(1, ' ') = table(4, ' ') = 4;
+	table(1, '-') = 5;
+	table(5, '>') = 6;
+
+	const DFAType lexer{ {2, 3, 4, 5, 6}, TranFn{ table } };
+
+	Tokenizer tokenizer{ lexer, "abc 12 -> x" };
+	ASSERT_EQ(tokenizer.getTokens().size(), 7);
+	EXPECT_EQ(tokenizer.getLexeme(tokenizer.getTokens()[4]), "->");
+	EXPECT_EQ(tokenizer.getTokens()[4].state, 6);
+
+	// an edit of the last token re-lexes it, and the space before it, which was scanned up to it
+	m0st4fa::fsm::TokenEdit res = tokenizer.edit(10, 11, "yz");
+	EXPECT_EQ(res.first, 5);
+	EXPECT_EQ(res.removedCount, 2);
+	EXPECT_EQ(res.insertedCount, 2);
+
+	// splitting "->" re-lexes "-" and what follows only until the tokens resynchronize
+	res = tokenizer.edit(8, 8, "!");
+	EXPECT_EQ(tokenizer.getText(), "abc 12 -!> yz");
+	EXPECT_EQ(res.first, 4);
+	EXPECT_EQ(res.insertedCount, 3);
+	EXPECT_EQ(tokenizer.getTokens()[5].state, 0);
+
+	// the tokens after any sequence of edits are those of tokenizing the text from scratch
+	std::string text{};
+	for (int i = 0; i < 200; i++)
+		text += (i % 7 == 0) ? "-> " : (i % 3 == 0) ? "foo " : "42 ";
+
+	Tokenizer incremental{ lexer, text };
+	unsigned seed = 7;
+	auto random = [&seed](const size_t bound) { seed = seed * 1103515245 + 12345; return (seed >> 8) % bound; };
+
+	for (int i = 0; i < 100; i++) {
+		const size_t start = random(incremental.getText().size() + 1);
+		const size_t end = std::min(start + random(5), incremental.getText().size());
+		const std::string replacement = std::string{ "a1 ->" }.substr(random(5), random(3));
+
+		incremental.edit(start, end, replacement);
+
+		const Tokenizer fresh{ lexer, incremental.getText() };
+		ASSERT_EQ(incremental.getTokens(), fresh.getTokens()) << i;
+	}
+
+	EXPECT_THROW(incremental.edit(5, 4, ""), m0st4fa::fsm::InvalidStateMachineArgumentsException);
+}
+
+TEST(DFATests, checkpoints) {
+
+	using enum m0st4fa::fsm::FSM_MODE;
+	using m0st4fa::fsm::IndexType;
+
+	// /(a*b)+/ as long as no two /b/s are adjacent; the run dies at the byte after "bb"
+	TableType table{};
+	table(1, 'a') = 1;
+	table(1, 'b') = 2;
+	table(2, 'a') = 1;
+	table(2, 'b') = 3;
+	table(2, 'c') = 2;
+
+	const DFAType testDFA{ {2}, TranFn{ table } };
+
+	std::string input{};
+	for (int i = 0; i < 40; i++)
+		input += std::string(i % 9 + 1, 'a') + (i % 4 ? "b" : "bcc");
+	input += "abbaab";
+
+	constexpr IndexType interval = 16;
+	m0st4fa::fsm::CheckpointIndex index{ interval };
+
+	for (const auto mode : { MM_WHOLE_STRING, MM_LONGEST_PREFIX }) {
+		const Result expected = testDFA.simulate(std::string_view{ input }, mode);
+		const Result res = testDFA.simulate(std::string_view{ input }, mode, index);
+		EXPECT_EQ(res.accepted, expected.accepted);
+		EXPECT_EQ(res.indicies, expected.indicies);
+
+		// the checkpoints stop at the death of the machine
+		ASSERT_TRUE(index.getDeath());
+		EXPECT_EQ(index.getDeath()->offset, input.size() - 2);
+		EXPECT_EQ(index.size(), (input.size() - 3) / interval + 1);
+
+		// resuming over a window ending anywhere gives the result of simulating the input up to there, with absolute indicies
+		for (IndexType end = 0; end <= input.size(); end++) {
+			const IndexType start = std::min<IndexType>(end / interval, index.size() - 1) * interval;
+			const std::string_view window = std::string_view{ input }.substr(start, end - start);
+
+			const Result prefix = testDFA.simulate(std::string_view{ input }.substr(0, end), mode);
+			const Result resumed = testDFA.resume(window, mode, index, start);
+			EXPECT_EQ(resumed.accepted, prefix.accepted) << end;
+			EXPECT_EQ(resumed.indicies, prefix.indicies) << end;
+
+			// the match can only be sliced out of a window that holds its start
+			EXPECT_EQ(resumed.getMatch(), start ? std::string_view{} : prefix.getMatch()) << end;
+		}
+	}
+
+	// the window must contain a checkpoint
+	EXPECT_THROW(testDFA.resume(std::string_view{ input }.substr(1, 10), MM_WHOLE_STRING, index, 1), m0st4fa::fsm::InvalidStateMachineArgumentsException);
+	EXPECT_THROW(testDFA.simulate(std::string_view{ input }, MM_LONGEST_SUBSTRING, index), m0st4fa::fsm::UnrecognizedSimModeException);
+}
+
+TEST(DFATests, countModes) {
+
+	using enum m0st4fa::fsm::FSM_MODE;
+	using m0st4fa::fsm::IndexType;
+
+	// /ab*|ca/
+	TableType table{};
+	table(1, 'a') = 2;
+	table(2, 'b') = 2;
+	table(1, 'c') = 3;
+	table(3, 'a') = 4;
+
+	const DFAType testDFA{ {2, 4}, TranFn{ table } };
+
+	Result res = testDFA.simulate("xabbxaab", MM_COUNT);
+	EXPECT_TRUE(res.accepted);
+	EXPECT_EQ(res.count, 3);
+	EXPECT_EQ(testDFA.simulate("xabbxaab", MM_COUNT_ENDS).count, 6);
+	EXPECT_FALSE(testDFA.simulate("xyz", MM_COUNT).accepted);
+
+	// the counts agree with counting the matches one by one
+	std::string input{};
+	for (int i = 0; i < 300; i++)
+		input += "abcx"[(i * 7 + i / 5) % 4];
+
+	const std::string_view view{ input };
+	size_t count = 0, endCount = 0;
+
+	for (IndexType start = 0; start < input.size(); ) {
+		const Result prefix = testDFA.simulate(view.substr(start), MM_LONGEST_PREFIX);
+
+		if (prefix.accepted && prefix.size()) {
+			count++;
+			start += prefix.size();
+		}
+		else
+			start++;
+	}
+
+	for (IndexType end = 1; end <= input.size(); end++)
+		for (IndexType start = 0; start < end; start++)
+			if (testDFA.simulate(view.substr(start, end - start), MM_WHOLE_STRING).accepted) {
+				endCount++;
+				break;
+			}
+
+	EXPECT_EQ(testDFA.simulate(view, MM_COUNT).count, count);
+	EXPECT_EQ(testDFA.simulate(view, MM_COUNT_ENDS).count, endCount);
+}
+
+TEST(DFATests, anyMatch) {
+
+	using enum m0st4fa::fsm::FSM_MODE;
+	using m0st4fa::fsm::Indicies;
+
+	// /abc|b+d/
+	TableType table{};
+	table(1, 'a') = 2;
+	table(2, 'b') = 3;
+	table(3, 'c') = 4;
+	table(1, 'b') = 5;
+	table(5, 'b') = 5;
+	table(5, 'd') = 6;
+
+	const DFAType testDFA{ {4, 6}, TranFn{ table } };
+
+	// the simulation stops at the end of the first match to end, although a longer one begins earlier
+	const std::string input = "xxabbbbdabc" + std::string(1000, 'x');
+	Result res = testDFA.simulate(input, MM_ANY_MATCH);
+	EXPECT_TRUE(res.accepted);
+	EXPECT_EQ(res.indicies, (Indicies{ 0, 8 }));
+	EXPECT_TRUE(res.finalState.contains(6));
+
+	EXPECT_EQ(testDFA.simulate("zzabzabc", MM_ANY_MATCH).indicies, (Indicies{ 0, 8 }));
+	EXPECT_FALSE(testDFA.simulate("abbbbc", MM_ANY_MATCH).accepted);
+	EXPECT_FALSE(testDFA.simulate("", MM_ANY_MATCH).accepted);
+
+	// it agrees with the longest substring search on whether there is a match
+	for (const std::string_view str : { "ab", "abd", "bbbbbc", "xabcx", "bd" })
+		EXPECT_EQ(testDFA.simulate(str, MM_ANY_MATCH).accepted, testDFA.simulate(str, MM_LONGEST_SUBSTRING).accepted) << str;
+}
+
+TEST(DFATests, combTable) {
+
+	using enum m0st4fa::fsm::FSM_MODE;
+	using m0st4fa::fsm::CombTable;
+	using m0st4fa::fsm::FSMStateType;
+	using CombDFA = m0st4fa::fsm::DeterFiniteAutomaton<m0st4fa::fsm::TransFn<CombTable>>;
+
+	// keywords (every state of their trie is final, since their prefixes are identifiers) and identifiers (2), most rows of which are alike
+	TableType table{};
+	for (char c = 'a'; c <= 'z'; c++)
+		table(1, c) = table(2, c) = 2;
+
+	FSMStateSetType finalStates{ 2 };
+	FSMStateType nextFree = 3;
+
+	for (const std::string keyword : { "if", "else", "while", "return", "for", "break", "continue", "struct", "switch", "case" }) {
+		FSMStateType state = 1;
+
+		for (const char c : keyword) {
+			const std::span<const FSMStateType> targets = table.targets(state, c);
+			FSMStateType next = targets.empty() ? 2 : targets.front();
+
+			// branch off the identifiers
+			if (next == 2) {
+				next = nextFree++;
+				for (char other = 'a'; other <= 'z'; other++)
+					table(next, other) = 2;
+
+				table(state, c) = next;
+				finalStates.insert(next);
+			}
+
+			state = next;
+		}
+	}
+
+	const DFAType denseDFA{ finalStates, TranFn{ table } };
+	const CombDFA combDFA{ finalStates, m0st4fa::fsm::TransFn<CombTable>{ CombTable{ table } } };
+
+	for (const std::string_view str : { "while", "whilex", "swit", "switch case", "9return", "", "continue;break", "structs" })
+		for (const auto mode : { MM_WHOLE_STRING, MM_LONGEST_PREFIX, MM_LONGEST_SUBSTRING }) {
+			const Result expected = denseDFA.simulate(str, mode);
+			const Result res = combDFA.simulate(str, mode);
+
+			EXPECT_EQ(res.accepted, expected.accepted) << str;
+			EXPECT_EQ(res.indicies, expected.indicies) << str;
+		}
+
+	// the keyword states share the row of the identifier state, so most of their cells are not stored
+	const m0st4fa::fsm::CompressionReport& report = combDFA.getTransitionFunction().getTable().getCompressionReport();
+	EXPECT_EQ(report.stateCount, nextFree);
+	EXPECT_LT(report.storedCellCount, report.denseCellCount / 4);
+	EXPECT_LT(report.getRatio(), 1.0);
+}
+
+TEST(DFATests, stateRenumbering) {
+
+	using enum m0st4fa::fsm::FSM_MODE;
+	using m0st4fa::fsm::FSMStateType;
+
+	// /ab*c|d/, numbered so that the hot state of /b*/ is far from the start state
+	TableType table{};
+	table(1, 'a') = 900;
+	table(900, 'b') = 900;
+	table(900, 'c') = 37;
+	table(1, 'd') = 500;
+
+	const DFAType testDFA{ {37, 500}, TranFn{ table } };
+
+	m0st4fa::fsm::StateProfile profile{};
+	profile.recordCorpus(testDFA, std::vector<std::string>{ "abbbbbc", "abbc", "d", "xabbbbc" }, MM_LONGEST_SUBSTRING);
+	EXPECT_EQ(profile.getInputCount(), 4);
+	EXPECT_EQ(profile.getVisitCount(900), 14);
+
+	std::vector<FSMStateType> originalStates{};
+	const m0st4fa::fsm::RenumberedDFA renumbered = m0st4fa::fsm::renumberStates(testDFA, profile, &originalStates);
+
+	// the dead and start states keep their numbers, and the hottest state comes right after them
+	EXPECT_EQ(originalStates, (std::vector<FSMStateType>{ 0, 1, 900, 37, 500 }));
+
+	for (const std::string_view str : { "abbbc", "xxdabc", "ab", "", "abcabbbbbbc" })
+		for (const auto mode : { MM_WHOLE_STRING, MM_LONGEST_PREFIX, MM_LONGEST_SUBSTRING }) {
+			const Result expected = testDFA.simulate(str, mode);
+			const Result res = renumbered.simulate(str, mode);
+
+			EXPECT_EQ(res.accepted, expected.accepted) << str;
+			EXPECT_EQ(res.indicies, expected.indicies) << str;
+
+			if (res.accepted) {
+				EXPECT_TRUE(expected.finalState.contains(originalStates[*res.finalState.begin()])) << str;
+			}
+		}
+}
+
+TEST(DFATests, stateIdWidth) {
+
+	using enum m0st4fa::fsm::FSM_MODE;
+	using m0st4fa::fsm::DFATable;
+	using m0st4fa::fsm::Indicies;
+	using DenseDFAType = m0st4fa::fsm::DeterFiniteAutomaton<m0st4fa::fsm::TransFn<DFATable>>;
+
+	// /a{299}b?/, through states 1 to 300 (and 301), and the same machine cut down to /a{9}b?/
+	TableType large{}, small{};
+	large.set(1, std::string(299, 'a'));
+	large(300, 'b') = 301;
+	small.set(1, std::string(9, 'a'));
+	small(10, 'b') = 11;
+
+	const DFATable largeTable{ large }, smallTable{ small };
+	EXPECT_EQ(smallTable.getStateIdWidth(), 1);
+	EXPECT_EQ(largeTable.getStateIdWidth(), 2);
+	EXPECT_EQ(DFATable::getStateIdWidthFor(size_t{ 1 } << 17), sizeof(m0st4fa::fsm::FSMStateType));
+
+	// the cells are narrowed, but read back as they were
+	EXPECT_EQ(largeTable.nextState(300, 'b'), 301);
+	EXPECT_EQ(largeTable.targets(299, 'a').front(), 300);
+	EXPECT_EQ(largeTable.getTransitions(), DFATable{ large }.getTransitions());
+	EXPECT_LT(largeTable.getSizeInBytes(), largeTable.size() * largeTable.getClassCount() * sizeof(m0st4fa::fsm::FSMStateType));
+
+	const DenseDFAType largeDFA{ {300, 301}, m0st4fa::fsm::TransFn<DFATable>{ largeTable } };
+	const std::string str = "x" + std::string(299, 'a') + "bb";
+	EXPECT_EQ(largeDFA.simulate(str, MM_LONGEST_SUBSTRING).indicies, (Indicies{ 1, 301 }));
+	EXPECT_FALSE(largeDFA.simulate(str, MM_WHOLE_STRING).accepted);
+
+	const DenseDFAType smallDFA{ {10, 11}, m0st4fa::fsm::TransFn<DFATable>{ smallTable } };
+	EXPECT_EQ(smallDFA.simulate("aaaaaaaaab", MM_WHOLE_STRING).indicies, (Indicies{ 0, 10 }));
+}
+
+TEST(DFATests, utf8Ranges) {
+
+	using enum m0st4fa::fsm::FSM_MODE;
+	using m0st4fa::fsm::CodePointRange;
+	using m0st4fa::fsm::Indicies;
+
+	// ranges across every change in the length of the encodings, and across the surrogates
+	const std::vector<CodePointRange> ranges{ {0x41, 0x5A}, {0x3B1, 0x3C9}, {0x7F0, 0x810}, {0xD700, 0xE100}, {0xFFF0, 0x10010}, {0x1F600, 0x1F64F} };
+
+	TableType table{};
+	const m0st4fa::fsm::FSMStateType nextFree = m0st4fa::fsm::addUtf8Ranges(table, 1, 2, ranges, 3);
+	const DFAType testDFA{ {2}, TranFn{ table } };
+
+	// the rows stay within the bytes
+	for (m0st4fa::fsm::FSMStateType state = 0; state < table.size(); state++)
+		EXPECT_LE(table.at(state).size(), 256);
+	EXPECT_LT(nextFree, 40);
+
+	// the machine accepts exactly the encodings of the code points within the ranges
+	for (char32_t codePoint = 0; codePoint <= m0st4fa::fsm::MAX_CODE_POINT; codePoint += (codePoint < 0x11000 ? 1 : 97)) {
+		if (codePoint >= 0xD800 && codePoint <= 0xDFFF)
+			continue;
+
+		std::string encoding{};
+		m0st4fa::fsm::appendUtf8(encoding, codePoint);
+
+		const bool expected = std::any_of(ranges.begin(), ranges.end(), [codePoint](const CodePointRange& range) { return range.first <= codePoint && codePoint <= range.last; });
+		ASSERT_EQ(testDFA.simulate(encoding, MM_WHOLE_STRING).accepted, expected) << std::hex << static_cast<std::uint32_t>(codePoint);
+	}
+
+	// matches are reported in bytes, and can be converted into code points
+	TableType identifiers{};
+	const std::vector<CodePointRange> letters{ {'a', 'z'}, {0x3B1, 0x3C9}, {0x4E00, 0x9FFF}, {0x1F600, 0x1F64F} };
+	m0st4fa::fsm::addUtf8Ranges(identifiers, 2, 2, letters, m0st4fa::fsm::addUtf8Ranges(identifiers, 1, 2, letters, 3));
+
+	const DFAType identifierDFA{ {2}, TranFn{ identifiers } };
+	const std::string str = "12 \xce\xb1\xce\xb2x\xe4\xb8\x96\xf0\x9f\x98\x80! ab";
+	const Result res = identifierDFA.simulate(str, MM_LONGEST_SUBSTRING);
+
+	EXPECT_EQ(res.indicies, (Indicies{ 3, 15 }));
+	EXPECT_EQ(m0st4fa::fsm::toCodePointIndicies(str, res.indicies), (Indicies{ 3, 8 }));
+	EXPECT_EQ(m0st4fa::fsm::toByteOffset(str, 8), 15);
+
+	// ranges added by separate calls share the intermediate states of their common lead bytes, even when they lead to different states
+	TableType greek{};
+	const std::vector<CodePointRange> lower{ {0x3B1, 0x3C9} }, upper{ {0x391, 0x3A9} };
+	const m0st4fa::fsm::FSMStateType greekFree = m0st4fa::fsm::addUtf8Ranges(greek, 1, 2, lower, 4);
+	EXPECT_EQ(m0st4fa::fsm::addUtf8Ranges(greek, 1, 3, upper, greekFree), greekFree);
+
+	const DFAType lowerDFA{ {2}, TranFn{ greek } }, upperDFA{ {3}, TranFn{ greek } };
+	EXPECT_TRUE(lowerDFA.simulate("\xce\xb1", MM_WHOLE_STRING).accepted);
+	EXPECT_TRUE(lowerDFA.simulate("\xcf\x89", MM_WHOLE_STRING).accepted);
+	EXPECT_FALSE(lowerDFA.simulate("\xce\x91", MM_WHOLE_STRING).accepted);
+	EXPECT_TRUE(upperDFA.simulate("\xce\x91", MM_WHOLE_STRING).accepted);
+	EXPECT_TRUE(upperDFA.simulate("\xce\xa9", MM_WHOLE_STRING).accepted);
+	EXPECT_FALSE(upperDFA.simulate("\xce\xb1", MM_WHOLE_STRING).accepted);
+
+	// a range whose bytes already lead elsewhere is rejected
+	EXPECT_THROW(m0st4fa::fsm::addUtf8Ranges(greek, 1, 3, { {0x3B1, 0x3B1} }, greekFree), m0st4fa::fsm::InvalidStateMachineArgumentsException);
+}
+
+TEST(DFATests, intervalTable) {
+
+	using enum m0st4fa::fsm::FSM_MODE;
+	using m0st4fa::fsm::IntervalTable;
+	using m0st4fa::fsm::Indicies;
+	using TokenStream = std::span<const std::uint32_t>;
+
+	// token IDs: a keyword in [40000, 40999], any number of identifiers in [100000, 199999], the terminator 500000, then any number of the punctuation 7, 9 and [12, 20], closed by 21
+	const IntervalTable table{ {
+		{ 1, 40000, 40999, { 2 } },
+		{ 2, 100000, 199999, { 2 } },
+		{ 2, 500000, 500000, { 3 } },
+		{ 3, 7, 7, { 3 } },
+		{ 3, 9, 9, { 3 } },
+		{ 3, 12, 20, { 3 } },
+		{ 3, 21, 21, { 4 } },
+		} };
+
+	EXPECT_EQ(table.size(), 5);
+	EXPECT_EQ(table.getRangeCount(), 7);
+	EXPECT_TRUE(table.isDirectlyIndexed(3));
+	EXPECT_FALSE(table.isDirectlyIndexed(2));
+	EXPECT_EQ(table.nextState(2, 150000u), 2);
+	EXPECT_EQ(table.nextState(2, 200000u), 0);
+	EXPECT_EQ(table.nextState(3, 8u), 0);
+	EXPECT_EQ(table.nextState(3, 20u), 3);
+	EXPECT_EQ(table.nextState(3, 22u), 0);
+	EXPECT_TRUE(table.targets(3, 6u).empty());
+
+	// overlapping ranges of the same state are rejected
+	EXPECT_THROW((IntervalTable{ { { 1, 10, 20, { 2 } }, { 1, 20, 30, { 3 } } } }), m0st4fa::fsm::InvalidStateMachineArgumentsException);
+
+	const m0st4fa::fsm::DeterFiniteAutomaton<m0st4fa::fsm::TransFn<IntervalTable>, TokenStream> testDFA{ {3}, m0st4fa::fsm::TransFn<IntervalTable>{ table } };
+
+	const std::vector<std::uint32_t> tokens{ 3, 40123, 123456, 199999, 500000, 7, 15, 9, 8 };
+	EXPECT_TRUE(testDFA.simulate(TokenStream{ tokens }.subspan(1, 4), MM_WHOLE_STRING).accepted);
+	EXPECT_EQ(testDFA.simulate(TokenStream{ tokens }, MM_LONGEST_SUBSTRING).indicies, (Indicies{ 1, 8 }));
+	EXPECT_EQ(testDFA.simulate(TokenStream{ tokens }.subspan(1), MM_LONGEST_PREFIX).indicies, (Indicies{ 0, 7 }));
+
+	// a range may lead to many states: the keyword either starts the sequence above or stands alone
+	const IntervalTable nfaTable{ {
+		{ 1, 40000, 40999, { 2, 5 } },
+		{ 2, 100000, 199999, { 2 } },
+		{ 2, 500000, 500000, { 3 } },
+		} };
+
+	const m0st4fa::fsm::NonDeterFiniteAutomaton<m0st4fa::fsm::TransFn<IntervalTable>, TokenStream> testNFA{ {3, 5}, m0st4fa::fsm::TransFn<IntervalTable>{ nfaTable } };
+
+	EXPECT_EQ(testNFA.simulate(TokenStream{ tokens }, MM_LONGEST_SUBSTRING).indicies, (Indicies{ 1, 5 }));
+	EXPECT_TRUE(testNFA.simulate(TokenStream{ tokens }.subspan(1, 1), MM_WHOLE_STRING).accepted);
+	EXPECT_FALSE(testNFA.simulate(TokenStream{ tokens }.subspan(1, 2), MM_WHOLE_STRING).accepted);
+
+	// the table grows with the ranges, not with the alphabet
+	EXPECT_LT(table.getSizeInBytes(), 512);
+}
+
+TEST_F(ErrorCodeTests, caseInsensitive) {
+
+	using enum m0st4fa::fsm::FSM_MODE;
+	using m0st4fa::fsm::FSM_FLAG;
+	using m0st4fa::fsm::DFATable;
+	using m0st4fa::fsm::Indicies;
+
+	// the error code is on both digits and the letter 'x'
+	table(finalState, 'x') = finalState;
+
+	const DFAType sensitiveDFA{ {finalState}, TranFn{ table } };
+	const DFAType insensitiveDFA{ {finalState}, TranFn{ table }, FSM_FLAG::FF_CASE_INSENSITIVE };
+	const m0st4fa::fsm::DeterFiniteAutomaton<m0st4fa::fsm::TransFn<DFATable>> denseDFA{ {finalState}, m0st4fa::fsm::TransFn<DFATable>{ DFATable{ table } }, FSM_FLAG::FF_CASE_INSENSITIVE };
+	const m0st4fa::fsm::NonDeterFiniteAutomaton<TranFn> testNFA{ {finalState}, TranFn{ table }, m0st4fa::fsm::FSM_TYPE::MT_NON_EPSILON_NFA, FSM_FLAG::FF_CASE_INSENSITIVE };
+
+	const std::string str = "some eRR42X then ERR1 and 'err' !";
+
+	EXPECT_FALSE(sensitiveDFA.simulate(str, MM_LONGEST_SUBSTRING).accepted);
+	EXPECT_EQ(insensitiveDFA.simulate(str, MM_LONGEST_SUBSTRING).indicies, (Indicies{ 5, 11 }));
+	EXPECT_EQ(denseDFA.simulate(str, MM_LONGEST_SUBSTRING).indicies, (Indicies{ 5, 11 }));
+	EXPECT_EQ(testNFA.simulate(str, MM_LONGEST_SUBSTRING).indicies, (Indicies{ 5, 11 }));
+	EXPECT_EQ(insensitiveDFA.simulate(str, MM_COUNT).count, 2);
+	EXPECT_TRUE(insensitiveDFA.simulate("ERR7x", MM_WHOLE_STRING).accepted);
+	EXPECT_TRUE(sensitiveDFA.simulate("err7x", MM_WHOLE_STRING).accepted);
+
+	// the cases of the letters share a class of the dense table, which needs no more classes than before
+	EXPECT_EQ(denseDFA.getTransitionFunction().getTable().getClass('e'), denseDFA.getTransitionFunction().getTable().getClass('E'));
+	EXPECT_EQ(denseDFA.getTransitionFunction().getTable().getClassCount(), DFATable{ table }.getClassCount());
+
+	// a DFA that tells the cases of a letter apart cannot ignore them
+	TableType conflicting{};
+	conflicting(1, 'a') = 2;
+	conflicting(1, 'A') = 3;
+	EXPECT_THROW((DFAType{ {2, 3}, TranFn{ conflicting }, FSM_FLAG::FF_CASE_INSENSITIVE }), m0st4fa::fsm::InvalidStateMachineArgumentsException);
+	EXPECT_THROW((m0st4fa::fsm::DeterFiniteAutomaton<m0st4fa::fsm::TransFn<m0st4fa::fsm::CombTable>>{ {2}, m0st4fa::fsm::TransFn<m0st4fa::fsm::CombTable>{ m0st4fa::fsm::CombTable{ table } }, FSM_FLAG::FF_CASE_INSENSITIVE }), m0st4fa::fsm::InvalidStateMachineArgumentsException);
+
+	// an NFA may follow both
+	const m0st4fa::fsm::NonDeterFiniteAutomaton<TranFn> conflictingNFA{ {3}, TranFn{ conflicting }, m0st4fa::fsm::FSM_TYPE::MT_NON_EPSILON_NFA, FSM_FLAG::FF_CASE_INSENSITIVE };
+	EXPECT_TRUE(conflictingNFA.simulate("a", MM_WHOLE_STRING).accepted);
+}
+
+TEST_F(ErrorCodeTests, sharedTable) {
+
+	using enum m0st4fa::fsm::FSM_MODE;
+	using m0st4fa::fsm::DFATable;
+	using m0st4fa::fsm::Indicies;
+	using SharedDFATable = m0st4fa::fsm::SharedTable<DFATable>;
+	using SharedDFAType = m0st4fa::fsm::DeterFiniteAutomaton<m0st4fa::fsm::TransFn<SharedDFATable>>;
+	using SharedNFAType = m0st4fa::fsm::NonDeterFiniteAutomaton<m0st4fa::fsm::TransFn<m0st4fa::fsm::SharedTable<TableType>>>;
+
+	const SharedDFATable shared{ DFATable{ table } };
+	const std::string str = "an err42 and err7";
+
+	// the machines built from the same handle, and their copies, hold a single table
+	std::vector<SharedDFAType> machines(100, SharedDFAType{ {finalState}, m0st4fa::fsm::TransFn<SharedDFATable>{ shared } });
+	EXPECT_EQ(shared.getUseCount(), 101);
+
+	for (const SharedDFAType& machine : machines) {
+		EXPECT_EQ(&machine.getTransitionFunction().getTable().get(), &shared.get());
+		EXPECT_EQ(&machine.getAccelerator(), &machines.front().getAccelerator());
+	}
+
+	EXPECT_EQ(machines.back().simulate(str, MM_LONGEST_SUBSTRING).indicies, (Indicies{ 3, 8 }));
+	EXPECT_EQ(machines.back().simulate(str, MM_COUNT).count, 2);
+
+	// moving a machine shares its handle, so the moved-from machine can still be simulated (it has no final states left, so it accepts nothing)
+	{
+		SharedDFAType moved{ std::move(machines.back()) };
+		EXPECT_EQ(shared.getUseCount(), 102);
+		EXPECT_EQ(&machines.back().getAccelerator(), &moved.getAccelerator());
+		EXPECT_EQ(machines.back().getTransitionFunction().getTable().size(), shared.size());
+		EXPECT_FALSE(machines.back().isStrided());
+		EXPECT_TRUE(moved.simulate("err123", MM_WHOLE_STRING).accepted);
+		EXPECT_FALSE(machines.back().simulate(str, MM_LONGEST_SUBSTRING).accepted);
+		EXPECT_EQ(machines.back().simulate(str, MM_COUNT).count, 0);
+		machines.pop_back();
+		EXPECT_EQ(shared.getUseCount(), 101);
+
+		machines.front() = std::move(moved);
+		EXPECT_TRUE(machines.front().simulate("err123", MM_WHOLE_STRING).accepted);
+		EXPECT_NO_THROW(moved.simulate(str, MM_ANY_MATCH));
+	}
+
+	machines.clear();
+	EXPECT_EQ(shared.getUseCount(), 1);
+
+	// a moved-from machine keeps its accelerator and stride table, and can be assigned to again
+	{
+		SharedDFAType strided{ {finalState}, m0st4fa::fsm::TransFn<SharedDFATable>{ shared }, m0st4fa::fsm::FSM_FLAG::FF_STRIDE_2 };
+		SharedDFAType stridedMoved{};
+		stridedMoved = std::move(strided);
+		EXPECT_TRUE(strided.isStrided());
+		EXPECT_EQ(&strided.getStrideTable(), &stridedMoved.getStrideTable());
+		EXPECT_EQ(stridedMoved.simulate(str, MM_LONGEST_SUBSTRING).indicies, (Indicies{ 3, 8 }));
+		EXPECT_NO_THROW(strided.simulate(str, MM_LONGEST_SUBSTRING));
+		strided = stridedMoved;
+		EXPECT_EQ(strided.simulate(str, MM_LONGEST_SUBSTRING).indicies, (Indicies{ 3, 8 }));
+	}
+	EXPECT_EQ(shared.getUseCount(), 1);
+
+	// NFAs share their table, and their bit-parallel engine, the same way
+	const SharedNFAType nfa{ {finalState}, m0st4fa::fsm::TransFn<m0st4fa::fsm::SharedTable<TableType>>{ m0st4fa::fsm::SharedTable<TableType>{ table } } };
+	SharedNFAType nfaCopy = nfa;
+	EXPECT_EQ(&nfa.getTransitionFunction().getTable().get(), &nfaCopy.getTransitionFunction().getTable().get());
+	EXPECT_TRUE(nfaCopy.isBitParallel());
+	EXPECT_EQ(nfaCopy.simulate(str, MM_LONGEST_SUBSTRING).indicies, (Indicies{ 3, 8 }));
+
+	const SharedNFAType nfaMoved{ std::move(nfaCopy) };
+	EXPECT_TRUE(nfaCopy.isBitParallel());
+	EXPECT_TRUE(nfaMoved.isBitParallel());
+	EXPECT_NO_THROW(nfaCopy.simulate(str, MM_LONGEST_SUBSTRING));
+	nfaCopy = nfaMoved;
+	EXPECT_EQ(nfaCopy.simulate(str, MM_LONGEST_SUBSTRING).indicies, (Indicies{ 3, 8 }));
+
+	// a shared table cannot be modified to fold case
+	EXPECT_THROW((SharedDFAType{ {finalState}, m0st4fa::fsm::TransFn<SharedDFATable>{ shared }, m0st4fa::fsm::FSM_FLAG::FF_CASE_INSENSITIVE }), m0st4fa::fsm::InvalidStateMachineArgumentsException);
+}
+
+namespace {
+
+	//! @brief A coroutine that runs until it finishes, with no handle to it.
+	struct DetachedTask {
+		struct promise_type {
+			DetachedTask get_return_object() { return {}; }
+			std::suspend_never initial_suspend() noexcept { return {}; }
+			std::suspend_never final_suspend() noexcept { return {}; }
+			void return_void() {}
+			void unhandled_exception() { std::terminate(); }
+		};
+	};
+
+	DetachedTask collectMatches(m0st4fa::fsm::MatchGenerator generator, std::vector<m0st4fa::fsm::Indicies>& matches, bool& isDone) {
+		while (const auto match = co_await generator.next())
+			matches.push_back(*match);
+
+		isDone = true;
+	}
+
+}
+
+TEST_F(ErrorCodeTests, matchStream) {
+
+	using enum m0st4fa::fsm::FSM_MODE;
+	using m0st4fa::fsm::ChunkChannel;
+	using m0st4fa::fsm::Indicies;
+
+	const DFAType testDFA{ {finalState}, TranFn{ table } };
+	const m0st4fa::fsm::NonDeterFiniteAutomaton<TranFn> testNFA{ {finalState}, TranFn{ table } };
+
+	// many streams, fed in turns, one chunk at a time, by a single thread
+	constexpr size_t streamCount = 1000;
+	std::string text{};
+	for (size_t i = 0; i < 50; i++)
+		text += "eerr" + std::to_string(i * 7919) + " er err" + (i % 3 ? "x" : "");
+
+	std::vector<ChunkChannel> channels(2 * streamCount);
+	std::vector<std::vector<Indicies>> matches(2 * streamCount);
+	std::unique_ptr<bool[]> isDone{ new bool[2 * streamCount]{} };
+
+	for (size_t i = 0; i < streamCount; i++) {
+		collectMatches(m0st4fa::fsm::findMatches(testDFA, channels[i]), matches[i], isDone[i]);
+		collectMatches(m0st4fa::fsm::findMatches(testNFA, channels[streamCount + i]), matches[streamCount + i], isDone[streamCount + i]);
+	}
+
+	// every stream waits for its first chunk
+	EXPECT_TRUE(std::all_of(channels.begin(), channels.end(), [](const ChunkChannel& channel) { return channel.isWaiting(); }));
+
+	// each stream is split into chunks of its own size
+	for (size_t turn = 0; turn < text.size(); turn++)
+		for (size_t i = 0; i < channels.size(); i++) {
+			const size_t chunkSize = i % 7 + 1;
+
+			if (turn * chunkSize < text.size())
+				channels[i].push(text.substr(turn * chunkSize, chunkSize));
+		}
+
+	EXPECT_FALSE(isDone[0]);
+
+	for (ChunkChannel& channel : channels)
+		channel.close();
+
+	const Result expected = testDFA.simulate(text, MM_COUNT);
+	ASSERT_EQ(expected.count, 50);
+
+	for (size_t i = 0; i < channels.size(); i++) {
+		ASSERT_TRUE(isDone[i]);
+		ASSERT_EQ(matches[i].size(), expected.count);
+		ASSERT_EQ(matches[i].front(), (Indicies{ 1, 5 }));
+		ASSERT_EQ(matches[i], matches[0]);
+	}
+
+	// a match is yielded as soon as the chunk that completes it is read
+	ChunkChannel channel{};
+	std::vector<Indicies> streamMatches{};
+	bool isStreamDone = false;
+	collectMatches(m0st4fa::fsm::findMatches(testDFA, channel), streamMatches, isStreamDone);
+
+	channel.push("xxer");
+	channel.push("r12");
+	EXPECT_TRUE(streamMatches.empty());
+	channel.push("3 err4");
+	EXPECT_EQ(streamMatches, (std::vector<Indicies>{ { 2, 8 } }));
+	channel.close();
+	EXPECT_EQ(streamMatches, (std::vector<Indicies>{ { 2, 8 }, { 9, 13 } }));
+	EXPECT_TRUE(isStreamDone);
+}
+
+TEST_F(ErrorCodeTests, lineSearch) {
+
+	using m0st4fa::fsm::MatchingLine;
+	using m0st4fa::fsm::Indicies;
+
+	// and /a\nb/, which spans lines
+	const FSMStateType spanningState = table.set(finalState + 1, (std::string)"a\nb");
+	table(1, 'a') = finalState + 2;
+
+	const DFAType testDFA{ {finalState, spanningState}, TranFn{ table } };
+	const m0st4fa::fsm::NonDeterFiniteAutomaton<TranFn> testNFA{ {finalState, spanningState}, TranFn{ table } };
+
+	const std::string buffer = "ok\nsome err1 and err2\n\nerr\nxa\nb err3\nlast err45";
+	const std::vector<MatchingLine> expected{ { 2, Indicies{ 3, 21 } }, { 6, Indicies{ 30, 36 } }, { 7, Indicies{ 37, 47 } } };
+
+	EXPECT_EQ(m0st4fa::fsm::findMatchingLines(testDFA, buffer), expected);
+	EXPECT_EQ(m0st4fa::fsm::findMatchingLines(testNFA, buffer), expected);
+	EXPECT_EQ(m0st4fa::fsm::countMatchingLines(testDFA, buffer + "\n"), 3);
+	EXPECT_EQ(m0st4fa::fsm::countMatchingLines(testDFA, "a\nb\na\nb"), 0);
+
+	// the lines agree with simulating the machine line by line, over many lines
+	std::string lines{};
+	for (size_t i = 0; i < 3000; i++)
+		lines += std::string(i % 37, 'e') + (i % 11 ? "rr" : "rr" + std::to_string(i)) + (i % 5 ? "a" : "") + "\n";
+
+	std::vector<MatchingLine> lineByLine{};
+	for (size_t start = 0, number = 1; start < lines.size(); number++) {
+		const size_t end = lines.find('\n', start);
+
+		if (testDFA.simulate(std::string_view{ lines }.substr(start, end - start), m0st4fa::fsm::FSM_MODE::MM_ANY_MATCH).accepted)
+			lineByLine.push_back({ number, Indicies{ start, end } });
+
+		start = end + 1;
+	}
+
+	ASSERT_EQ(lineByLine.size(), 265);
+	EXPECT_EQ(m0st4fa::fsm::findMatchingLines(testDFA, lines), lineByLine);
+	EXPECT_EQ(m0st4fa::fsm::countByte(lines.data(), lines.data() + lines.size(), '\n'), 3000);
+}
+
+TEST(DFATests, subsetConstruction) {
+
+	using enum m0st4fa::fsm::FSM_MODE;
+	using m0st4fa::fsm::FSMStateType;
+	using m0st4fa::fsm::SubsetDFA;
+	using NFAType = m0st4fa::fsm::NonDeterFiniteAutomaton<TranFn>;
+
+	// the DFAs built by any number of workers are the same, state for state
+	auto expectSame = [](const SubsetDFA& lhs, const SubsetDFA& rhs) {
+		const auto& lhsTable = lhs.getTransitionFunction().getTable();
+		const auto& rhsTable = rhs.getTransitionFunction().getTable();
+
+		ASSERT_EQ(lhsTable.size(), rhsTable.size());
+		EXPECT_TRUE(std::ranges::equal(lhs.getFinalStates(), rhs.getFinalStates()));
+
+		for (FSMStateType state = 0; state < lhsTable.size(); state++)
+			for (size_t symbol = 0; symbol < m0st4fa::fsm::DFATable::ALPHABET_SIZE; symbol++)
+				ASSERT_EQ(lhsTable.nextState(state, static_cast<unsigned char>(symbol)), rhsTable.nextState(state, static_cast<unsigned char>(symbol)));
+	};
+
+	// random epsilon NFAs over /[a-c]/
+	std::mt19937 random{ 3 };
+
+	for (int i = 0; i < 20; i++) {
+		constexpr FSMStateType stateCount = 24;
+		TableType table{};
+		FSMStateSetType fStates{ 2 };
+		table(1, 'a') = { 2 };
+
+		for (FSMStateType state = 1; state <= stateCount; state++) {
+			for (char c = 'a'; c <= 'c'; c++)
+				for (int n = random() % 3; n--;)
+					table(state, c).insert(1 + random() % stateCount);
+
+			if (random() % 8 == 0)
+				table(state, '\0').insert(1 + random() % stateCount);
+
+			if (random() % 6 == 0)
+				fStates.insert(state);
+		}
+
+		const NFAType testNFA{ fStates, TranFn{ table } };
+		const SubsetDFA sequential = m0st4fa::fsm::determinize(testNFA, 1);
+		const SubsetDFA parallel = m0st4fa::fsm::determinize(testNFA, 4);
+
+		expectSame(sequential, parallel);
+
+		for (int j = 0; j < 50; j++) {
+			std::string str(random() % 12, 'a');
+			for (char& c : str)
+				c = static_cast<char>('a' + random() % 4);
+
+			for (const auto mode : { MM_WHOLE_STRING, MM_LONGEST_PREFIX, MM_LONGEST_SUBSTRING, MM_COUNT }) {
+				const Result expected = testNFA.simulate(str, mode);
+				const Result res = parallel.simulate(str, mode);
+
+				ASSERT_EQ(res.accepted, expected.accepted) << str;
+				ASSERT_EQ(res.indicies, expected.indicies) << str;
+				ASSERT_EQ(res.count, expected.count) << str;
+			}
+		}
+	}
+
+	// /(a|b)*a(a|b){11}/, whose DFA has a state for each of the last 12 bytes it has read
+	TableType table{};
+	table(1, 'a') = { 1, 2 };
+	table(1, 'b') = { 1 };
+	for (FSMStateType state = 2; state <= 12; state++)
+		table(state, 'a') = table(state, 'b') = state + 1;
+
+	const NFAType blowUp{ {13}, TranFn{ table }, m0st4fa::fsm::FSM_TYPE::MT_NON_EPSILON_NFA };
+	const SubsetDFA blowUpDFA = m0st4fa::fsm::determinize(blowUp, 4);
+
+	EXPECT_EQ(blowUpDFA.getTransitionFunction().getTable().size(), (1 << 12) + 1);
+	EXPECT_EQ(blowUpDFA.getFinalStates().size(), 1 << 11);
+	expectSame(blowUpDFA, m0st4fa::fsm::determinize(blowUp, 1));
+	EXPECT_TRUE(blowUpDFA.simulate(std::string_view{ "bbabbbbbbbbbbb" }, MM_WHOLE_STRING).accepted);
+	EXPECT_FALSE(blowUpDFA.simulate(std::string_view{ "bbbabbbbbbbbbb" }, MM_WHOLE_STRING).accepted);
+
+	EXPECT_THROW(m0st4fa::fsm::determinize(blowUp, 4, 1000), m0st4fa::fsm::StateLimitExceededException);
+}
+
+TEST(DFATests, strideTransitions) {
+
+	using enum m0st4fa::fsm::FSM_MODE;
+	using m0st4fa::fsm::FSMStateType;
+	using m0st4fa::fsm::DFATable;
+	using Machine = m0st4fa::fsm::DeterFiniteAutomaton<m0st4fa::fsm::TransFn<DFATable>>;
+
+	constexpr size_t alphabetSize = DFATable::ALPHABET_SIZE;
+	std::mt19937 random{ 5 };
+
+	// random DFAs over /[a-d]/, whose matches end after either byte of a step; state 2 (reached from the start state on /x/) loops on everything but /d/, so it is accelerated
+	for (int i = 0; i < 30; i++) {
+		constexpr FSMStateType stateCount = 12;
+		std::vector<FSMStateType> transitions(stateCount * alphabetSize);
+		FSMStateSetType fStates{ 2 };
+
+		for (FSMStateType state = 1; state < stateCount; state++) {
+			for (char c = 'a'; c <= 'd'; c++)
+				transitions[state * alphabetSize + c] = random() % stateCount;
+
+			if (random() % 3 == 0)
+				fStates.insert(state);
+		}
+
+		for (size_t symbol = 0; symbol < alphabetSize; symbol++)
+			transitions[2 * alphabetSize + symbol] = symbol == 'd' ? 3 : 2;
+		transitions[1 * alphabetSize + 'x'] = 2;
+
+		const DFATable table = DFATable::fromTransitions(transitions);
+		const Machine plain{ fStates, m0st4fa::fsm::TransFn<DFATable>{ table } };
+		const Machine strided{ fStates, m0st4fa::fsm::TransFn<DFATable>{ table }, m0st4fa::fsm::FSM_FLAG::FF_STRIDE_2 };
+
+		ASSERT_FALSE(plain.isStrided());
+		ASSERT_TRUE(strided.isStrided());
+		EXPECT_TRUE(strided.getAccelerator().isAccelerated(2));
+
+		for (int j = 0; j < 100; j++) {
+			std::string str(random() % 40, 'a');
+			for (char& c : str)
+				c = "abcdx"[random() % 5];
+
+			for (const auto mode : { MM_WHOLE_STRING, MM_LONGEST_PREFIX, MM_LONGEST_SUBSTRING, MM_COUNT, MM_COUNT_ENDS, MM_ANY_MATCH }) {
+				const Result expected = plain.simulate(str, mode);
+				const Result res = strided.simulate(str, mode);
+
+				ASSERT_EQ(res.accepted, expected.accepted) << str;
+				ASSERT_EQ(res.indicies, expected.indicies) << str;
+				ASSERT_EQ(res.count, expected.count) << str;
+				ASSERT_TRUE(std::ranges::equal(res.finalState, expected.finalState)) << str;
+			}
+		}
+	}
+
+	// a DFA whose table would be too large falls back to one byte per transition
+	constexpr FSMStateType stateCount = 300;
+	std::vector<FSMStateType> transitions(stateCount * alphabetSize);
+	for (FSMStateType state = 1; state < stateCount; state++)
+		for (size_t symbol = 'A'; symbol < 'A' + 60; symbol++)
+			transitions[state * alphabetSize + symbol] = 1 + random() % (stateCount - 1);
+
+	const Machine large{ { 1 }, m0st4fa::fsm::TransFn<DFATable>{ DFATable::fromTransitions(transitions) }, m0st4fa::fsm::FSM_FLAG::FF_STRIDE_2 };
+	EXPECT_FALSE(large.isStrided());
+	EXPECT_TRUE(large.getStrideTable().empty());
+	EXPECT_TRUE(large.simulate(std::string_view{ "ABC" }, MM_LONGEST_PREFIX).accepted);
+}
+
+TEST(DFATests, unanchoredTable) {
+
+	using enum m0st4fa::fsm::FSM_MODE;
+	using m0st4fa::fsm::FSMStateType;
+	using m0st4fa::fsm::IndexType;
+
+	// counts the positions at which some non-empty match ends, and finds the first of them, by running the machine from every position
+	auto check = [](const auto& machine, const std::string_view str) {
+		size_t endCount = 0;
+		std::optional<IndexType> firstEnd{};
+
+		for (IndexType end = 1; end <= str.size(); end++)
+			for (IndexType start = 0; start < end; start++)
+				if (machine.simulate(str.substr(start, end - start), MM_WHOLE_STRING).accepted) {
+					endCount++;
+					firstEnd = firstEnd.value_or(end);
+					break;
+				}
+
+		EXPECT_EQ(machine.simulate(str, MM_COUNT_ENDS).count, endCount) << str;
+
+		const Result res = machine.simulate(str, MM_ANY_MATCH);
+		EXPECT_EQ(res.accepted, firstEnd.has_value()) << str;
+		if (firstEnd) {
+			EXPECT_EQ(res.indicies.end, *firstEnd) << str;
+		}
+	};
+
+	// random DFAs over /[a-d]/, which are run through their unanchored table
+	std::mt19937 random{ 11 };
+
+	for (int i = 0; i < 20; i++) {
+		constexpr FSMStateType stateCount = 12;
+		TableType table{};
+		FSMStateSetType fStates{ stateCount - 1 };
+
+		for (FSMStateType state = 1; state < stateCount; state++)
+			for (char c = 'a'; c <= 'd'; c++)
+				if (random() % 4)
+					table(state, c) = 1 + random() % (stateCount - 1);
+
+		const DFAType testDFA{ fStates, TranFn{ table } };
+		ASSERT_FALSE(testDFA.getUnanchoredTable().empty());
+
+		for (int j = 0; j < 20; j++) {
+			std::string str(random() % 30, 'a');
+			for (char& c : str)
+				c = "abcdx"[random() % 5];
+
+			check(testDFA, str);
+		}
+	}
+
+	// the DFA of /(a|b)*a(a|b){12}/ has too many states for a table, so it keeps its set of states while running
+	TableType table{};
+	table(1, 'a') = { 1, 2 };
+	table(1, 'b') = { 1 };
+	for (FSMStateType state = 2; state <= 13; state++)
+		table(state, 'a') = table(state, 'b') = state + 1;
+
+	const m0st4fa::fsm::SubsetDFA blowUp = m0st4fa::fsm::determinize(m0st4fa::fsm::NonDeterFiniteAutomaton<TranFn>{ {14}, TranFn{ table }, m0st4fa::fsm::FSM_TYPE::MT_NON_EPSILON_NFA }, 1);
+	ASSERT_TRUE(blowUp.getUnanchoredTable().empty());
+
+	for (int j = 0; j < 5; j++) {
+		std::string str(random() % 60, 'a');
+		for (char& c : str)
+			c = "abx"[random() % 3];
+
+		check(blowUp, str);
+	}
+}
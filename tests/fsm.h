@@ -57,6 +57,21 @@ public:
 
 };
 
+/**
+ * @brief The fixture of the tests that search text for error codes (/err[0-9]+/).
+ */
+class ErrorCodeTests : public testing::Test, public FSMSharedInfo {
+
+protected:
+	using FSMStateType = m0st4fa::fsm::FSMStateType;
+
+	//! @brief The table of /err[0-9]+/, which the tests may add to.
+	FSMTableType table{};
+	//! @brief The final state of /err[0-9]+/.
+	const FSMStateType finalState = initTranFn_err(table);
+
+};
+
 TYPED_TEST_SUITE_P(FSMTests);
 
 template<typename T>
@@ -178,4 +193,30 @@ TYPED_TEST_P(FSMTests, set) {
 
 }
 
-REGISTER_TYPED_TEST_SUITE_P(FSMTests, simulate, simulate2, set);
+TYPED_TEST_P(FSMTests, prefilter) {
+
+	using enum m0st4fa::fsm::FSM_MODE;
+	using m0st4fa::fsm::FSMStateType;
+
+	// Data structures
+	typename TestFixture::TableType table{};
+	const FSMStateType finalState = this->Base::initTranFn_err(table);
+	typename TestFixture::TranFn tranFn{ table };
+	TypeParam testFSM{ std::set<FSMStateType>{ finalState }, tranFn };
+
+	const std::string padding(100, 'e');
+	const std::string str1 = padding + "er" + padding + "err12" + padding + "err345" + padding;
+	const std::string str2 = padding + "rre1" + "err" + padding;
+
+	// POSITIVE TESTS
+	{
+		SCOPED_TRACE("POSITIVE TESTS");
+
+		this->testFSMResultPositive(testFSM.simulate(str1, MM_LONGEST_SUBSTRING), true, { 307, 313 });
+		this->testFSMResultPositive(testFSM.simulate(str2, MM_LONGEST_SUBSTRING), false, { 0, 0 });
+		this->testFSMResultPositive(testFSM.simulate(str1.substr(0, 310), MM_LONGEST_SUBSTRING), true, { 202, 207 });
+	}
+
+}
+
+REGISTER_TYPED_TEST_SUITE_P(FSMTests, simulate, simulate2, set, prefilter);
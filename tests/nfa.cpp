@@ -1,8 +1,12 @@
 #include "gtest/gtest.h"
 
+#include <numeric>
+#include <random>
+
 #include "universal.h"
 
 #include "fsm/NFA.h"
+#include "fsm/ApproximateMatcher.h"
 
 class NFATest : testing::Test {
 
@@ -39,4 +43,243 @@ using TranFn = m0st4fa::fsm::TransFn<TableType>;
 using NFA = m0st4fa::fsm::NonDeterFiniteAutomaton<TranFn>;
 using Result = m0st4fa::fsm::FSMResult;
 
-INSTANTIATE_TYPED_TEST_SUITE_P(NFATests, FSMTests, NFA);
\ No newline at end of file
+INSTANTIATE_TYPED_TEST_SUITE_P(NFATests, FSMTests, NFA);
+
+TEST(NFATests, epsilonTransitions) {
+
+	using enum m0st4fa::fsm::FSM_MODE;
+	using m0st4fa::fsm::FSMStateType;
+
+	// a(\e)b(\e)a*
+	TranFn tranFn{};
+	tranFn(1, 'a') = { 2 };
+	tranFn(2, '\0') = { 3 };
+	tranFn(3, 'b') = { 4 };
+	tranFn(4, '\0') = { 5 };
+	tranFn(5, 'a') = { 5 };
+
+	NFA testNFA{ {5}, tranFn };
+
+	EXPECT_TRUE(testNFA.simulate(std::string_view{ "ab" }, MM_WHOLE_STRING).accepted);
+	EXPECT_TRUE(testNFA.simulate(std::string_view{ "abaa" }, MM_WHOLE_STRING).accepted);
+	EXPECT_FALSE(testNFA.simulate(std::string_view{ "aab" }, MM_WHOLE_STRING).accepted);
+	EXPECT_EQ(testNFA.simulate(std::string_view{ "abab" }, MM_LONGEST_PREFIX).indicies, (m0st4fa::fsm::Indicies{ 0, 3 }));
+	EXPECT_EQ(testNFA.simulate(std::string_view{ "bbaba" }, MM_LONGEST_SUBSTRING).indicies, (m0st4fa::fsm::Indicies{ 2, 5 }));
+	EXPECT_EQ(testNFA.simulate(std::string_view{ "abaxabab" }, MM_COUNT).count, 2);
+	EXPECT_EQ(testNFA.simulate(std::string_view{ "abaxabab" }, MM_COUNT_ENDS).count, 5);
+	EXPECT_EQ(testNFA.simulate(std::string_view{ "bbbaxab" }, MM_ANY_MATCH).indicies, (m0st4fa::fsm::Indicies{ 0, 7 }));
+
+	// the transition function writes into caller-supplied buffers
+	std::vector<FSMStateType> buffer{ 42 };
+	tranFn(2, 'c') = { 6, 4 };
+	tranFn(3, 'c') = { 4 };
+	tranFn(FSMStateSetType{ 2, 3 }, 'c', buffer);
+	EXPECT_EQ(buffer, (std::vector<FSMStateType>{ 4, 6 }));
+}
+
+
+TEST(NFATests, bitParallelEngine) {
+
+	using enum m0st4fa::fsm::FSM_MODE;
+	using m0st4fa::fsm::FSMStateType;
+
+	// the same machine, once small enough to be simulated bit-parallel and once too large to be
+	// the machine of `FSMSharedInfo::initTranFn_ab`, with state 4 also looping through 5 on /c/ via an epsilon-transition
+	TableType small{};
+	small(1, 'a') = 2;
+	small(1, 'b') = 3;
+	small(2, 'a') = 2;
+	small(2, 'b') = 3;
+	small(3, 'b') = 4;
+	small(4, 'b') = 4;
+	small(4, '\0') = { 5 };
+	small(5, 'c') = { 4 };
+
+	TableType large{ small };
+	large(1, 'z') = { 10 };
+	large.set(10, std::string(300, 'z'));
+
+	NFA smallNFA{ {4}, TranFn{ small } };
+	NFA largeNFA{ {4}, TranFn{ large } };
+
+	EXPECT_TRUE(smallNFA.isBitParallel());
+	EXPECT_FALSE(largeNFA.isBitParallel());
+
+	for (const std::string_view str : { "baaabb", "asbsaabbbaabb", "sabb", "abbcbc", "abbcbcc", "", "cab" })
+		for (const auto mode : { MM_WHOLE_STRING, MM_LONGEST_PREFIX, MM_LONGEST_SUBSTRING, MM_COUNT, MM_COUNT_ENDS, MM_ANY_MATCH }) {
+			const Result expected = largeNFA.simulate(str, mode);
+			const Result res = smallNFA.simulate(str, mode);
+
+			EXPECT_EQ(res.accepted, expected.accepted) << str;
+			EXPECT_EQ(res.indicies, expected.indicies) << str;
+			EXPECT_EQ(res.count, expected.count) << str;
+		}
+}
+
+TEST(NFATests, scratchMemory) {
+
+	using enum m0st4fa::fsm::FSM_MODE;
+	using m0st4fa::fsm::Indicies;
+
+	// a machine too large to be simulated bit-parallel: /z{301}/ (through states 10 to 310) or /ab*/
+	TableType table{};
+	table(1, 'a') = 2;
+	table(2, 'b') = 2;
+	table(1, 'z') = { 10 };
+	table.set(10, std::string(300, 'z'));
+
+	NFA testNFA{ {2, 310}, TranFn{ table } };
+	ASSERT_FALSE(testNFA.isBitParallel());
+
+	const std::string str = "xx" + std::string(301, 'z') + "abbb";
+
+	// all scratch memory comes from the given resource: a fixed buffer that cannot grow
+	std::array<std::byte, 1 << 16> buffer{};
+	std::pmr::monotonic_buffer_resource resource{ buffer.data(), buffer.size(), std::pmr::null_memory_resource() };
+
+	const Result res = testNFA.simulate(str, MM_LONGEST_SUBSTRING, &resource);
+	EXPECT_TRUE(res.accepted);
+	EXPECT_EQ(res.indicies, (Indicies{ 2, 303 }));
+	EXPECT_EQ(res.finalState.size(), 1);
+	EXPECT_TRUE(res.finalState.contains(310));
+
+	// the arena of the thread grows to fit what a simulation needs
+	m0st4fa::fsm::ScratchArena arena{ 16 };
+	EXPECT_EQ(testNFA.simulate(str, MM_LONGEST_SUBSTRING, arena.getResource()).indicies, (Indicies{ 2, 303 }));
+	arena.reset();
+	EXPECT_GT(arena.getCapacity(), 16);
+
+	// but not beyond its maximum, and it shrinks back once most of it goes unused
+	arena.getResource()->allocate(4 * m0st4fa::fsm::ScratchArena::MAX_CAPACITY);
+	arena.reset();
+	EXPECT_EQ(arena.getCapacity(), m0st4fa::fsm::ScratchArena::MAX_CAPACITY);
+	arena.reset();
+	EXPECT_EQ(arena.getCapacity(), 16);
+	EXPECT_EQ(testNFA.simulate("abb", MM_WHOLE_STRING).indicies, (Indicies{ 0, 3 }));
+}
+
+TEST(NFATests, approximateMatching) {
+
+	using enum m0st4fa::fsm::FSM_MODE;
+	using m0st4fa::fsm::FSMStateType;
+	using m0st4fa::fsm::Indicies;
+	using m0st4fa::fsm::ApproximateMatcher;
+
+	// the edit distance of two strings, computed directly
+	auto editDistance = [](std::string_view lhs, std::string_view rhs) {
+		std::vector<size_t> row(rhs.size() + 1);
+		std::iota(row.begin(), row.end(), size_t{ 0 });
+
+		for (size_t i = 1; i <= lhs.size(); i++) {
+			size_t diagonal = row[0];
+			row[0] = i;
+
+			for (size_t j = 1; j <= rhs.size(); j++)
+				diagonal = std::exchange(row[j], std::min({ row[j] + 1, row[j - 1] + 1, diagonal + (lhs[i - 1] != rhs[j - 1]) }));
+		}
+
+		return row.back();
+	};
+
+	// a dictionary of identifiers: one chain of states per word, all leaving the start state
+	const std::vector<std::string> words{ "count", "counter", "index", "length", "value", "buffer", "size" };
+	TableType table{};
+	FSMStateSetType fStates{};
+	FSMStateType next = 2;
+
+	for (const std::string& word : words) {
+		table(1, word.front()).insert(next);
+
+		for (size_t i = 1; i < word.size(); i++, next++)
+			table(next, word[i]) = next + 1;
+
+		fStates.insert(next++);
+	}
+
+	const NFA dictionary{ fStates, TranFn{ table }, m0st4fa::fsm::FSM_TYPE::MT_NON_EPSILON_NFA };
+	const ApproximateMatcher matcher{ dictionary, 2 };
+
+	auto lookup = [&](std::string_view query) {
+		size_t best = std::numeric_limits<size_t>::max();
+
+		for (const std::string& word : words)
+			best = std::min(best, editDistance(query, word));
+
+		return best;
+	};
+
+	for (const std::string_view query : { "length", "lenght", "indx", "cuont", "buffers", "vaule", "sizes", "z", "", "counted", "xyzzy" }) {
+		const auto res = matcher.simulate(query, MM_WHOLE_STRING);
+		const size_t expected = lookup(query);
+
+		EXPECT_EQ(res.accepted, expected <= 2) << query;
+		if (res.accepted) {
+			EXPECT_EQ(res.distance, expected) << query;
+		}
+	}
+
+	// random queries of typos
+	std::mt19937 random{ 7 };
+	for (int i = 0; i < 500; i++) {
+		std::string query = words[random() % words.size()];
+
+		for (int edits = random() % 4; edits--;) {
+			const size_t pos = random() % (query.size() + 1);
+			const char c = static_cast<char>('a' + random() % 26);
+
+			if (pos == query.size() || random() % 3 == 0)
+				query.insert(query.begin() + pos, c);
+			else if (random() % 2)
+				query.erase(pos, 1);
+			else
+				query[pos] = c;
+		}
+
+		const auto res = matcher.simulate(query, MM_WHOLE_STRING);
+		const size_t expected = lookup(query);
+
+		ASSERT_EQ(res.accepted, expected <= 2) << query;
+		if (res.accepted) {
+			ASSERT_EQ(res.distance, expected) << query;
+		}
+	}
+
+	// searching for the best approximate occurrence of a literal
+	const ApproximateMatcher literal = ApproximateMatcher::fromLiteral("identifier", 2);
+	const std::string text = "an idnetifier, then an identfier";
+
+	const auto best = literal.simulate(text, MM_LONGEST_SUBSTRING);
+	EXPECT_TRUE(best.accepted);
+	EXPECT_EQ(best.distance, 1);
+	EXPECT_EQ(best.getMatch(), "identfier");
+
+	const auto first = literal.simulate(text, MM_ANY_MATCH);
+	EXPECT_TRUE(first.accepted);
+	EXPECT_EQ(first.distance, 2);
+	EXPECT_EQ(first.indicies, (Indicies{ 0, 13 }));
+
+	EXPECT_EQ(literal.simulate(std::string_view{ "identifeir" }, MM_LONGEST_PREFIX).indicies, (Indicies{ 0, 10 }));
+	EXPECT_FALSE(ApproximateMatcher::fromLiteral("identifier", 1).simulate(std::string_view{ "idnetfier" }, MM_WHOLE_STRING).accepted);
+
+	// the best substring has the smallest distance of all substrings, which is computed directly
+	for (int i = 0; i < 200; i++) {
+		std::string str(20, ' ');
+		for (char& c : str)
+			c = "ident"[random() % 5];
+
+		size_t expected = std::numeric_limits<size_t>::max();
+		for (size_t start = 0; start <= str.size(); start++)
+			for (size_t end = start; end <= str.size(); end++)
+				expected = std::min(expected, editDistance(std::string_view{ str }.substr(start, end - start), "identifier"));
+
+		const auto res = literal.simulate(str, MM_LONGEST_SUBSTRING);
+		ASSERT_EQ(res.accepted, expected <= 2) << str;
+
+		if (res.accepted) {
+			ASSERT_EQ(res.distance, expected) << str;
+			ASSERT_EQ(editDistance(res.getMatch(), "identifier"), expected) << str;
+		}
+	}
+
+	EXPECT_THROW(ApproximateMatcher::fromLiteral(std::string(300, 'a'), 1), m0st4fa::fsm::StateLimitExceededException);
+}
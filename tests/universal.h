@@ -43,6 +43,19 @@ protected:
 
 	}
 
+	template<typename T = FSMTableType>
+	static m0st4fa::fsm::FSMStateType initTranFn_err(T& fun) {
+		// corresponding regex: /err[0-9]+/
+		// returns the final state
+
+		const m0st4fa::fsm::FSMStateType lastState = fun.set(1, (std::string)"err");
+
+		for (char c = '0'; c <= '9'; c++)
+			fun(lastState, c) = fun(lastState + 1, c) = lastState + 1;
+
+		return lastState + 1;
+	}
+
 	template<typename T>
 	static constexpr void initTranFn_id_eq_num(T& fun) {
 		// corresponding regex: /\w+(\w|\d)*|=|\d+/
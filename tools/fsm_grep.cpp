@@ -0,0 +1,97 @@
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <string>
+
+#include "fsm/DFA.h"
+#include "fsm/DFATable.h"
+#include "fsm/LineSearch.h"
+
+/**
+* A small `grep -F` for benchmarking the line search of the library against `grep`:
+*	fsm-grep [-c] [-n] [-i] STRING [FILE]
+* It prints the lines of FILE (or of the standard input) that contain STRING; with -c, it prints their number instead; with -n, each line is prefixed with its number; with -i, case is ignored.
+**/
+
+namespace {
+
+	int usage() {
+		std::cerr << "usage: fsm-grep [-c] [-n] [-i] STRING [FILE]\n";
+		return 2;
+	}
+
+}
+
+int main(int argc, char** argv) {
+
+	using namespace m0st4fa::fsm;
+	using Machine = DeterFiniteAutomaton<TransFn<DFATable>>;
+
+	bool countOnly = false, showNumbers = false, ignoreCase = false;
+	int arg = 1;
+
+	for (; arg < argc && argv[arg][0] == '-' && argv[arg][1]; arg++) {
+		if (!std::strcmp(argv[arg], "-c"))
+			countOnly = true;
+		else if (!std::strcmp(argv[arg], "-n"))
+			showNumbers = true;
+		else if (!std::strcmp(argv[arg], "-i"))
+			ignoreCase = true;
+		else
+			return usage();
+	}
+
+	if (arg == argc || argc - arg > 2 || !argv[arg][0])
+		return usage();
+
+	// the machine of the string: a chain of states, the last of which is final
+	const std::string pattern = argv[arg++];
+	FSMTable table{};
+	const FSMStateType finalState = table.set(1, pattern);
+
+	const Machine machine{ {finalState}, TransFn<DFATable>{ DFATable{ table } }, ignoreCase ? FSM_FLAG::FF_CASE_INSENSITIVE : FSM_FLAG::FF_FLAG_NONE };
+
+	// read the whole input into a single buffer
+	std::string buffer{};
+
+	if (arg < argc) {
+		std::ifstream file{ argv[arg], std::ios::binary };
+
+		if (!file) {
+			std::cerr << "fsm-grep: cannot open " << argv[arg] << "\n";
+			return 2;
+		}
+
+		std::ostringstream contents{};
+		contents << file.rdbuf();
+		buffer = std::move(contents).str();
+	}
+	else
+		buffer.assign(std::istreambuf_iterator<char>{ std::cin }, std::istreambuf_iterator<char>{});
+
+	size_t count = 0;
+
+	if (countOnly)
+		count = countMatchingLines(machine, buffer);
+	else {
+		std::string output{};
+
+		count = forEachMatchingLine(machine, buffer, [&](const MatchingLine& line) {
+			if (showNumbers)
+				output += std::to_string(line.number) + ':';
+
+			output.append(buffer, line.indicies.start, line.indicies.end - line.indicies.start);
+			output += '\n';
+			});
+
+		std::cout << output;
+	}
+
+	if (countOnly)
+		std::cout << count << "\n";
+
+	// like grep, exit with 1 if no line matched
+	return count ? 0 : 1;
+}